@@ -34,6 +34,7 @@
 #include <rtm.h>
 #include <random.h>
 #include <tle.h>
+#include <simd_search.h>
 #ifdef TM
 #include "../hybridnorec/hybridnorec/tm.h"
 //#include "../hybridnorec/hytm1/tm.h"
@@ -138,9 +139,13 @@ struct abtree_SCXRecord {
     abtree_SCXRecord<DEGREE,K> * volatile scxRecordsSeen[wrapper_info<DEGREE,K>::MAX_NODES];  // array of pointers to scx records
 }; //__attribute__((aligned (PREFETCH_SIZE_BYTES)));
 
+// the fields read by searches (leaf, size, keys and ptrs) come first, so a
+// search reads a contiguous prefix of the node (which prefetchSearchData
+// prefetches). note: this harness allocates nodes with allocator_new, which
+// does not align them on cache line boundaries, so the prefix may span one
+// more cache line than it would in an aligned node.
 template <int DEGREE, typename K>
 struct abtree_Node {
-    abtree_SCXRecord<DEGREE,K> * volatile scxRecord;
 #ifdef TM
     volatile long leaf;
     volatile long marked;
@@ -154,6 +159,7 @@ struct abtree_Node {
 #endif
     volatile K keys[DEGREE];
     void * volatile ptrs[DEGREE];
+    abtree_SCXRecord<DEGREE,K> * volatile scxRecord;
     
 #ifdef TM
     __rtm_force_inline long isLeaf_tm(TM_ARGDECL_ALONE) {
@@ -206,6 +212,11 @@ struct abtree_Node {
     template <class Compare>
     __rtm_force_inline int getChildIndex(const K& key, Compare cmp) {
         int nkeys = getKeyCount();
+#ifdef SIMD_SEARCH_SUPPORTED
+        if (simd_search<K,Compare>::enabled) {
+            return simd_search<K,Compare>::template findFirstGreater<DEGREE>((const K *) keys, nkeys, key);
+        }
+#endif
         int retval = 0;
         while (retval < nkeys && !cmp(key, (const K&) keys[retval])) {
             TXN_ASSERT(keys[retval] >= 0 && keys[retval] < MAXKEY);
@@ -213,13 +224,31 @@ struct abtree_Node {
         }
         return retval;
     }
+    // prefetch the cache lines that a search of this node reads
+    __rtm_force_inline void prefetchSearchData() {
+#ifndef NO_NODE_PREFETCH
+        const char * const end = (const char *) &ptrs[0];
+        for (const char * p = (const char *) this; p < end; p += BYTES_IN_CACHE_LINE) {
+            __builtin_prefetch(p);
+        }
+#endif
+    }
+    // returns the child to visit next, after prefetching the parts of it
+    // that the caller will search, so the misses for all of its keys overlap
     template <class Compare>
     __rtm_force_inline abtree_Node<DEGREE,K> * getChild(const K& key, Compare cmp) {
-        return (abtree_Node<DEGREE,K> *) ptrs[getChildIndex(key, cmp)];
+        abtree_Node<DEGREE,K> * const child = (abtree_Node<DEGREE,K> *) ptrs[getChildIndex(key, cmp)];
+        child->prefetchSearchData();
+        return child;
     }
     template <class Compare>
     __rtm_force_inline int getKeyIndex(const K& key, Compare cmp) {
         int nkeys = getKeyCount();
+#ifdef SIMD_SEARCH_SUPPORTED
+        if (simd_search<K,Compare>::enabled) {
+            return simd_search<K,Compare>::template findEqual<DEGREE>((const K *) keys, nkeys, key);
+        }
+#endif
         for (int i=0;i<nkeys;++i) {
             TXN_ASSERT(keys[i] >= 0 && keys[i] < MAXKEY);
             if (!cmp(key, (const K&) keys[i]) && !cmp((const K&) keys[i], key)) return i;
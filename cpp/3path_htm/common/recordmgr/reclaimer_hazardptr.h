@@ -8,6 +8,7 @@
 #ifndef RECLAIM_HAZARDPTR_STACK_H
 #define	RECLAIM_HAZARDPTR_STACK_H
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <sstream>
@@ -23,12 +24,38 @@ using namespace hashset_namespace;
 
 #define MAX_HAZARDPTRS_PER_THREAD 16
 
+// a thread scans the announced hazard pointers once it has retired
+// HAZARDPTR_SCAN_THRESHOLD_FACTOR * (number of threads) * MAX_HAZARDPTRS_PER_THREAD objects
+#ifndef HAZARDPTR_SCAN_THRESHOLD_FACTOR
+    #define HAZARDPTR_SCAN_THRESHOLD_FACTOR 5
+#endif
+
+// a scan copies all announced hazard pointers into a flat array.
+// if there are at most HAZARDPTR_LINEAR_SCAN_MAX of them, each retired object
+// is compared with all of them (in a branch-free loop that the compiler can
+// vectorize). otherwise, the array is sorted once, and binary searched.
+// (compile with -DHAZARDPTR_SCAN_HASHSET to use a hash set, instead.)
+#ifndef HAZARDPTR_LINEAR_SCAN_MAX
+    #define HAZARDPTR_LINEAR_SCAN_MAX 32
+#endif
+
+struct hazardptr_scan_stats {
+    long long scans;    // number of scans performed by this thread
+    long long freed;    // number of objects those scans sent to the pool
+    volatile char padding[PREFETCH_SIZE_BYTES - 2*sizeof(long long)];
+};
+
 template <typename T = void, class Pool = pool_interface<T> >
 class reclaimer_hazardptr : public reclaimer_interface<T, Pool> {
 private:
     AtomicArrayList<T> **announce;  // announce[tid] = set of announced hazard pointers for thread tid
     ArrayList<T> **retired;         // retired[tid] = set of retired objects for thread tid
+#ifdef HAZARDPTR_SCAN_HASHSET
     hashset_new<T> **comparing;     // comparing[tid] = set of announced hazard pointers for ALL threads, as collected by thread tid during it's last retire(tid, ...) call
+#else
+    T ***comparing;                 // comparing[tid] = array of announced hazard pointers for ALL threads, as collected by thread tid during it's last retire(tid, ...) call
+#endif
+    hazardptr_scan_stats * stats;   // stats[tid] = scan statistics for thread tid
     
     // number of elements that retired[tid] must contain
     // before we scan hazard pointers to determine
@@ -38,6 +65,32 @@ private:
     //      n = number of threads and
     //      k = max number of hazard pointers a thread can hold at once
     const int scanThreshold;
+
+#ifndef HAZARDPTR_SCAN_HASHSET
+    // copy all announced hazard pointers into comparing[tid], and sort them
+    // if there are too many to compare linearly. returns their number.
+    inline int collectAnnouncements(const int tid) {
+        T ** const hps = comparing[tid];
+        int n = 0;
+        for (int otherTid=0; otherTid < this->NUM_PROCESSES; ++otherTid) {
+            int sz = announce[otherTid]->size();
+            assert(sz < MAX_HAZARDPTRS_PER_THREAD);
+            for (int ixHP=0;ixHP<sz;++ixHP) {
+                hps[n++] = announce[otherTid]->get(ixHP);
+            }
+        }
+        if (n > HAZARDPTR_LINEAR_SCAN_MAX) std::sort(hps, hps+n);
+        return n;
+    }
+    inline static bool isAnnounced(T ** const hps, const int n, T * const obj) {
+        if (n <= HAZARDPTR_LINEAR_SCAN_MAX) {
+            bool found = false;
+            for (int i=0;i<n;++i) found |= (hps[i] == obj);
+            return found;
+        }
+        return std::binary_search(hps, hps+n, obj);
+    }
+#endif
     
 public:
     template<typename _Tp1>
@@ -205,6 +258,8 @@ public:
 //            TRACE cout<<"    afterwards, we have "<<retired[tid]->size()<<" things waiting to be retired..."<<endl;
 
             TRACE cout<<"retiring... we have "<<retired[tid]->size()<<" things waiting to be retired (THIS thread #hps="<<announce[tid]->size()<<")...";
+            const int sizeBefore = retired[tid]->size();
+#ifdef HAZARDPTR_SCAN_HASHSET
             // hash all announcements
             comparing[tid]->clear();
             assert(comparing[tid]->size() == 0);
@@ -228,6 +283,23 @@ public:
                     ++ix; // we didn't erase, so we need to move on to the next element
                 }
             }
+#else
+            T ** const hps = comparing[tid];
+            const int numHPs = collectAnnouncements(tid);
+            for (int ix=0;ix<retired[tid]->size();) {
+                // check if retired[tid]->data[ix] is in any set of hazard pointers
+                if (!isAnnounced(hps, numHPs, retired[tid]->get(ix))) {
+                    // no hazard pointers point to the item, so we send it to the pool
+                    this->pool->add(tid, retired[tid]->get(ix));
+                    // now we remove the item from retired[tid]
+                    retired[tid]->erase(ix);
+                } else {
+                    ++ix; // we didn't erase, so we need to move on to the next element
+                }
+            }
+#endif
+            ++stats[tid].scans;
+            stats[tid].freed += sizeBefore - retired[tid]->size();
             TRACE cout<<"    afterwards, we have "<<retired[tid]->size()<<" things waiting to be retired..."<<endl;
             
             DEBUG2 assert(!retired[tid]->isFull());
@@ -237,19 +309,33 @@ public:
     void debugPrintStatus(const int tid) {
 //        assert(tid >= 0);
 //        assert(tid < this->NUM_PROCESSES);
+        if (stats[tid].scans > 0) {
+            cout<<"thread "<<tid<<" hazard pointer scans="<<stats[tid].scans<<" freed="<<stats[tid].freed<<" freed per scan="<<((double) stats[tid].freed / stats[tid].scans)<<endl;
+        }
     }
 
     reclaimer_hazardptr(const int numProcesses, Pool *_pool, debugInfo * const _debug, RecoveryMgr<void *> * const _recoveryMgr = NULL)
-            : scanThreshold(5*numProcesses*MAX_HAZARDPTRS_PER_THREAD),
+            : scanThreshold(HAZARDPTR_SCAN_THRESHOLD_FACTOR*numProcesses*MAX_HAZARDPTRS_PER_THREAD),
               reclaimer_interface<T, Pool>(numProcesses, _pool, _debug, _recoveryMgr) {
         VERBOSE DEBUG cout<<"constructor reclaimer_hazardptr"<<endl;
         announce = new AtomicArrayList<T>*[numProcesses];
         retired = new ArrayList<T>*[numProcesses];
+#ifdef HAZARDPTR_SCAN_HASHSET
         comparing = new hashset_new<T>*[numProcesses];
+#else
+        comparing = new T**[numProcesses];
+#endif
+        stats = new hazardptr_scan_stats[numProcesses];
         for (int tid=0;tid<numProcesses;++tid) {
             announce[tid] = new AtomicArrayList<T>(MAX_HAZARDPTRS_PER_THREAD);
             retired[tid] = new ArrayList<T>(scanThreshold);
+#ifdef HAZARDPTR_SCAN_HASHSET
             comparing[tid] = new hashset_new<T>(numProcesses*MAX_HAZARDPTRS_PER_THREAD);
+#else
+            comparing[tid] = new T*[numProcesses*MAX_HAZARDPTRS_PER_THREAD];
+#endif
+            stats[tid].scans = 0;
+            stats[tid].freed = 0;
         }
     }
     ~reclaimer_hazardptr() {
@@ -261,11 +347,16 @@ public:
             }
             delete announce[tid];
             delete retired[tid];
+#ifdef HAZARDPTR_SCAN_HASHSET
             delete comparing[tid];
+#else
+            delete[] comparing[tid];
+#endif
         }
         delete[] announce;
         delete[] retired;
         delete[] comparing;
+        delete[] stats;
     }
 
 }; // end class
@@ -99,8 +99,12 @@ const test_type POS_INFTY = 2000000000;
 #if defined(BST)
 #define DS_DECLARATION bst<test_type, test_type, less<test_type>, MemMgmt>
 #elif defined(ABTREE)
-#define ABTREE_NODE_DEGREE 16
-#define ABTREE_NODE_MIN_DEGREE 6
+#ifndef ABTREE_NODE_DEGREE
+    #define ABTREE_NODE_DEGREE 16
+#endif
+#ifndef ABTREE_NODE_MIN_DEGREE
+    #define ABTREE_NODE_MIN_DEGREE (ABTREE_NODE_DEGREE*3/8)
+#endif
 #define DS_DECLARATION abtree<ABTREE_NODE_DEGREE, test_type, less<test_type>, MemMgmt>
 #elif defined(CITRUS)
 #define DS_DECLARATION citrustree<MemMgmt>
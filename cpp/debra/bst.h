@@ -36,6 +36,7 @@
 #include "random.h"
 #include "scxrecord.h"
 #include "node.h"
+#include "elimination.h"
 
 #include <csignal>
 #include <setjmp.h>
@@ -129,6 +130,7 @@ private:
     #define SCXAndEnterQuiescentState scx
 
     int help(const int tid, SCXRecord<K,V> *scx, bool helpingOther);
+    bool qProtectForHelping(const int tid, SCXRecord<K,V> *scx); // DEBRA+ with CRASH_RECOVERY_USING_CHECKPOINTS
     bool scx(
             const int tid,
             const int operationType,
@@ -154,6 +156,10 @@ private:
     bool updateRebalancingStep(const int tid, const K& key);
     int computeSize(Node<K,V>* node);
 
+    // op is ELIMINATION_OP_INSERT, ELIMINATION_OP_INSERT_IF_ABSENT or ELIMINATION_OP_ERASE
+    bool updateOnce(const int tid, const int op, const K& key, const V& val, V *result); // one attempt; last arg is an output arg
+    V update(const int tid, const int op, const K& key, const V& val);
+
     // Originally, I tested (node->key == NO_KEY or node == root->left->left)
     // to see if node is a sentinel, but there is a nice observation:
     //     if an scx succeeds and node == root->left->left,
@@ -162,6 +168,11 @@ private:
 
     // debug info
     debugCounters * const counters;
+
+#ifdef BST_ELIMINATION
+    // updates that fail their first attempt go through this layer
+    elimination_layer<K,V> * const elimination;
+#endif
     
     long long debugKeySum(Node<K,V> * node) {
         if (node == NULL) return 0;
@@ -223,6 +234,9 @@ public:
         delete recordmgr;
         delete counters;
         delete[] allocatedSCXRecord;
+#ifdef BST_ELIMINATION
+        delete elimination;
+#endif
     }
 
     Node<K,V> *getRoot(void) { return root; }
@@ -262,6 +276,9 @@ public:
     void clearCounters() {
         counters->clear();
         recordmgr->clearCounters();
+#ifdef BST_ELIMINATION
+        elimination->clearStats();
+#endif
     }
     debugCounters * const debugGetCounters() {
         return counters;
@@ -269,6 +286,11 @@ public:
     MasterRecordMgr * const debugGetRecordMgr() {
         return recordmgr;
     }
+#ifdef BST_ELIMINATION
+    elimination_layer<K,V> * const debugGetElimination() {
+        return elimination;
+    }
+#endif
 };
 
 #include "bst_impl.h"
@@ -30,12 +30,12 @@ using namespace std;
     info.obj = _obj; \
     info.ptrToObj = arg2; \
     info.nodeContainingPtrToObjIsMarked = arg3; \
-    if (_obj != dummy && !recordmgr->protect(tid, _obj, callbackCheckNotRetired, (void*) &info))
+    if ((_obj != dummy && !recordmgr->protect(tid, _obj, callbackCheckNotRetired, (void*) &info)) || NEUTRALIZED(tid))
 #define IF_FAIL_TO_PROTECT_NODE(info, tid, _obj, arg2, arg3) \
     info.obj = _obj; \
     info.ptrToObj = arg2; \
     info.nodeContainingPtrToObjIsMarked = arg3; \
-    if (_obj != root && !recordmgr->protect(tid, _obj, callbackCheckNotRetired, (void*) &info))
+    if ((_obj != root && !recordmgr->protect(tid, _obj, callbackCheckNotRetired, (void*) &info)) || NEUTRALIZED(tid))
 
 inline CallbackReturn bst_callbackCheckNotRetired(CallbackArg arg) {
     BST_retired_info *info = (BST_retired_info*) arg;
@@ -96,7 +96,11 @@ BST<K,V,Compare,MasterRecordMgr>::BST(const K& _NO_KEY,
             NO_VALUE(_NO_VALUE),
             RETRY(_RETRY),
             recordmgr(new MasterRecordMgr(numProcesses, neutralizeSignal)),
-            counters(new debugCounters(numProcesses)) {
+            counters(new debugCounters(numProcesses))
+#ifdef BST_ELIMINATION
+            , elimination(new elimination_layer<K,V>(numProcesses, _NO_VALUE))
+#endif
+            {
 
     VERBOSE DEBUG COUTATOMIC("constructor BST"<<endl);
     const int tid = 0;
@@ -161,6 +165,11 @@ const pair<V,bool> BST<K,V,Compare,MasterRecordMgr>::find(const int tid, const K
             assert(recordmgr->isProtected(tid, p));
             l = (Node<K,V>*) p->left.load(memory_order_relaxed);
             if (l == NULL) {
+                if (NEUTRALIZED(tid)) {
+                    recordmgr->enterQuiescentState(tid);
+                    counters->findFail->inc(tid);
+                    continue; /* retry */
+                }
                 result = pair<V,bool>(NO_VALUE, false); // no keys in data structure
                 recordmgr->enterQuiescentState(tid);
                 counters->findSuccess->inc(tid);
@@ -171,6 +180,7 @@ const pair<V,bool> BST<K,V,Compare,MasterRecordMgr>::find(const int tid, const K
                 counters->findFail->inc(tid);
                 continue; /* retry */ 
             }
+            STALL_POINT(tid);
 
             assert(recordmgr->isProtected(tid, l));
             while ((Node<K,V>*) l->left.load(memory_order_relaxed) != NULL) {
@@ -184,17 +194,13 @@ const pair<V,bool> BST<K,V,Compare,MasterRecordMgr>::find(const int tid, const K
                     assert(recordmgr->isProtected(tid, p));
                     l = (Node<K,V>*) p->left.load(memory_order_relaxed);
                     IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->left, &p->marked) {
-                        recordmgr->enterQuiescentState(tid); 
-                        counters->findFail->inc(tid);
-                        continue; /* retry */ 
+                        goto retry; // (continue would only restart the traversal loop)
                     }
                 } else {
                     assert(recordmgr->isProtected(tid, p));
                     l = (Node<K,V>*) p->right.load(memory_order_relaxed);
                     IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->right, &p->marked) { 
-                        recordmgr->enterQuiescentState(tid); 
-                        counters->findFail->inc(tid);
-                        continue; /* retry */ 
+                        goto retry;
                     }
                 }
                 assert(recordmgr->isProtected(tid, l));
@@ -206,61 +212,76 @@ const pair<V,bool> BST<K,V,Compare,MasterRecordMgr>::find(const int tid, const K
             } else {
                 result = pair<V,bool>(NO_VALUE, false);
             }
+            // result may have been read from a reclaimed node if we were neutralized
+            if (NEUTRALIZED(tid)) goto retry;
             recordmgr->enterQuiescentState(tid);
             counters->findSuccess->inc(tid);
             return result; // success
         }
+        continue;
+retry:
+        recordmgr->enterQuiescentState(tid);
+        counters->findFail->inc(tid);
     }
     return pair<V,bool>(NO_VALUE, false);
 }
 
 template<class K, class V, class Compare, class MasterRecordMgr>
-const V BST<K,V,Compare,MasterRecordMgr>::insert(const int tid, const K& key, const V& val) {
-    bool onlyIfAbsent = false;
-    V result = NO_VALUE;
+bool BST<K,V,Compare,MasterRecordMgr>::updateOnce(const int tid, const int op, const K& key, const V& val, V * const result) {
     bool finished = false;
-    while (!finished) {
-        CHECKPOINT_AND_RUN_UPDATE(tid, finished) {
-            recordmgr->leaveQuiescentState(tid);
-            finished = updateInsert(tid, key, val, onlyIfAbsent, &result);
-            recordmgr->enterQuiescentState(tid);
-            if (!finished) counters->insertFail->inc(tid);
-            else counters->insertSuccess->inc(tid);
+    CHECKPOINT_AND_RUN_UPDATE(tid, finished) {
+        recordmgr->leaveQuiescentState(tid);
+        if (op == ELIMINATION_OP_ERASE) {
+            finished = updateErase(tid, key, result);
+        } else {
+            finished = updateInsert(tid, key, val, (op == ELIMINATION_OP_INSERT_IF_ABSENT), result);
+        }
+        recordmgr->enterQuiescentState(tid);
+        if (!finished) {
+            if (op == ELIMINATION_OP_ERASE) counters->eraseFail->inc(tid);
+            else counters->insertFail->inc(tid);
         }
     }
+    return finished;
+}
+
+// returns the value associated with key just before the update (or NO_VALUE)
+template<class K, class V, class Compare, class MasterRecordMgr>
+V BST<K,V,Compare,MasterRecordMgr>::update(const int tid, const int op, const K& key, const V& val) {
+    V result = NO_VALUE;
+    if (updateOnce(tid, op, key, val, &result)) return result;
+#ifdef BST_ELIMINATION
+    // the first attempt failed, so key is probably contended
+    auto apply = [this, tid](const int op, const K& key, const V& val) {
+        V result = NO_VALUE;
+        while (!updateOnce(tid, op, key, val, &result)) {}
+        return result;
+    };
+    return elimination->combine(tid, op, key, val, apply);
+#else
+    while (!updateOnce(tid, op, key, val, &result)) {}
+    return result;
+#endif
+}
+
+template<class K, class V, class Compare, class MasterRecordMgr>
+const V BST<K,V,Compare,MasterRecordMgr>::insert(const int tid, const K& key, const V& val) {
+    const V result = update(tid, ELIMINATION_OP_INSERT, key, val);
+    counters->insertSuccess->inc(tid);
     return result;
 }
 
 template<class K, class V, class Compare, class MasterRecordMgr>
 const bool BST<K,V,Compare,MasterRecordMgr>::insertIfAbsent(const int tid, const K& key, const V& val) {
-    bool onlyIfAbsent = true;
-    V result = NO_VALUE;
-    bool finished = false;
-    while (!finished) {
-        CHECKPOINT_AND_RUN_UPDATE(tid, finished) {
-            recordmgr->leaveQuiescentState(tid);
-            finished = updateInsert(tid, key, val, onlyIfAbsent, &result);
-            recordmgr->enterQuiescentState(tid);
-            if (!finished) counters->insertFail->inc(tid);
-            else counters->insertSuccess->inc(tid);
-        }
-    }
+    const V result = update(tid, ELIMINATION_OP_INSERT_IF_ABSENT, key, val);
+    counters->insertSuccess->inc(tid);
     return (result == NO_VALUE);
 }
 
 template<class K, class V, class Compare, class MasterRecordMgr>
 const pair<V,bool> BST<K,V,Compare,MasterRecordMgr>::erase(const int tid, const K& key) {
-    V result = NO_VALUE;
-    bool finished = false;
-    while (!finished) {
-        CHECKPOINT_AND_RUN_UPDATE(tid, finished) {
-            recordmgr->leaveQuiescentState(tid);
-            finished = updateErase(tid, key, &result);
-            recordmgr->enterQuiescentState(tid);
-            if (!finished) counters->eraseFail->inc(tid);
-            else counters->eraseSuccess->inc(tid);
-        }
-    }
+    const V result = update(tid, ELIMINATION_OP_ERASE, key, NO_VALUE);
+    counters->eraseSuccess->inc(tid);
     return pair<V,bool>(result, (result != NO_VALUE));
 }
 
@@ -333,6 +354,7 @@ bool BST<K,V,Compare,MasterRecordMgr>::updateInsert(
         if (onlyIfAbsent) {
             assert(recordmgr->isProtected(tid, l));
             *result = l->value;
+            if (NEUTRALIZED(tid)) return false; // l may have been reclaimed
             TRACE COUTATOMICTID("return true5\n");
             return true; // success
         }
@@ -436,6 +458,7 @@ bool BST<K,V,Compare,MasterRecordMgr>::updateErase(
     } // return and retry
     assert(recordmgr->isProtected(tid, l));
     if ((Node<K,V>*) l->left.load(memory_order_relaxed) == NULL) {
+        if (NEUTRALIZED(tid)) return false; // l may have been reclaimed
         TRACE COUTATOMICTID("return true2\n");
         return true;
     } // only sentinels in tree...
@@ -484,6 +507,7 @@ bool BST<K,V,Compare,MasterRecordMgr>::updateErase(
     // if we fail to find the key in the tree
     assert(recordmgr->isProtected(tid, l));
     if (key != l->key) {
+        if (NEUTRALIZED(tid)) return false; // l may have been reclaimed
         *result = NO_VALUE;
 //        recordmgr->enterQuiescentState(tid);
         return true; // success
@@ -840,6 +864,18 @@ bool BST<K,V,Compare,MasterRecordMgr>::scx(
         // memory barriers are not needed for these qProtect() calls on x86/64
         // because there's no write-write reordering, and nothing can be
         // reordered over the first freezing CAS in help().
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+        // last checkpoint: if we have not been neutralized after our qProtects
+        // are visible, then everything we read is still allocated, and no
+        // record we write to in help() can be reclaimed.
+        // (so, we finish this scx even if we are neutralized during help().)
+        __sync_synchronize();
+        if (NEUTRALIZED(tid)) {
+            recordmgr->qUnprotectAll(tid);
+            recordmgr->enterQuiescentState(tid);
+            return false;
+        }
+#endif
         
     // if we don't have crash recovery, then we only need to protect our scx
     // record, so that it's not retired and freed out from under us by someone
@@ -1042,6 +1078,36 @@ int BST<K,V,Compare,MasterRecordMgr>::help(const int tid, SCXRecord<K,V> *scx, b
     return SCXRecord<K,V>::STATE_COMMITTED; // success
 }
 
+// with CRASH_RECOVERY_USING_CHECKPOINTS, a thread can be neutralized while it
+// helps another thread's scx, so, before helping, it must qProtect the scx
+// record and the nodes that help() writes to (just as scx() does).
+// returns false if the thread was neutralized (so it must not help).
+// you may call this only if scx is protected by a call to recordmgr->protect.
+template<class K, class V, class Compare, class MasterRecordMgr>
+bool BST<K,V,Compare,MasterRecordMgr>::qProtectForHelping(const int tid, SCXRecord<K,V> *scx) {
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+    if (recordmgr->supportsCrashRecovery()) {
+        recordmgr->qProtect(tid, scx, callbackReturnTrue, NULL, false);
+        __sync_synchronize();
+        if (NEUTRALIZED(tid)) {
+            recordmgr->qUnprotectAll(tid);
+            return false;
+        }
+        // scx cannot be reclaimed now, so we can read its nodes
+        const int type = scx->type;
+        for (int i=0;i<NUM_OF_NODES[type];++i) {
+            recordmgr->qProtect(tid, scx->nodes[i], callbackReturnTrue, NULL, false);
+        }
+        __sync_synchronize();
+        if (NEUTRALIZED(tid)) {
+            recordmgr->qUnprotectAll(tid);
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
 // you may call this only if node is protected by a call to recordmgr->protect
 template<class K, class V, class Compare, class MasterRecordMgr>
 void *BST<K,V,Compare,MasterRecordMgr>::llx(
@@ -1121,16 +1187,30 @@ void *BST<K,V,Compare,MasterRecordMgr>::llx(
                 } // return and retry
                 assert(scx2 != dummy);
                 assert(recordmgr->isProtected(tid, scx2));
+                if (!qProtectForHelping(tid, scx2)) {
+                    DEBUG counters->llxFail->inc(tid);
+                    return NULL;
+                }
                 TRACE COUTATOMICTID("llx help 1 tid="<<tid<<endl);
                 help(tid, scx2, true);
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+                recordmgr->qUnprotectAll(tid);
+#endif
             }
         }
     } else if (state == SCXRecord<K,V>::STATE_INPROGRESS) {
         if (recordmgr->shouldHelp()) {
             assert(scx1 != dummy);
             assert(recordmgr->isProtected(tid, scx1));
+            if (!qProtectForHelping(tid, scx1)) {
+                DEBUG counters->llxFail->inc(tid);
+                return NULL;
+            }
             TRACE COUTATOMICTID("llx help 2 tid="<<tid<<endl);
             help(tid, scx1, true);
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+            recordmgr->qUnprotectAll(tid);
+#endif
         }
     } else {
         // state committed and marked
@@ -1145,8 +1225,15 @@ void *BST<K,V,Compare,MasterRecordMgr>::llx(
             } // return and retry
             assert(scx3 != dummy);
             assert(recordmgr->isProtected(tid, scx3));
+            if (!qProtectForHelping(tid, scx3)) {
+                DEBUG counters->llxFail->inc(tid);
+                return NULL;
+            }
             TRACE COUTATOMICTID("llx help 3 tid="<<tid<<endl);
             help(tid, scx3, true);
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+            recordmgr->qUnprotectAll(tid);
+#endif
         } else {
         }
     }
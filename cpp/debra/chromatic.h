@@ -31,6 +31,7 @@
 #include <sys/types.h>
 #include <stdexcept>
 #include <bitset>
+#include <algorithm>
 
 #include "globals.h"
 #include "random.h"
@@ -44,6 +45,26 @@
 
 using namespace std;
 
+// with -DCHROMATIC_ORDER_STATISTICS, each node stores the number of keys in its
+// subtree (see rank, select and countInRange). by default, these counts are
+// refreshed on the search path of each update (so they are exact whenever no
+// update is in progress). with -DCHROMATIC_APPROX_COUNTS, each thread buffers
+// the keys of its last CHROMATIC_APPROX_BATCH updates, and then refreshes the
+// counts on all of their search paths at once (so nodes near the root are
+// refreshed once per batch, instead of once per update). each count is then
+// off by at most numProcesses * CHROMATIC_APPROX_BATCH whenever no update is
+// in progress (see approxCountErrorBound).
+#if defined CHROMATIC_ORDER_STATISTICS && !defined CHROMATIC_APPROX_COUNTS
+    #define CHROMATIC_EXACT_COUNTS
+#endif
+#ifdef CHROMATIC_APPROX_COUNTS
+    #ifndef CHROMATIC_APPROX_BATCH
+        #define CHROMATIC_APPROX_BATCH 32
+    #endif
+    // maximum number of internal nodes on the search paths of one batch
+    #define CHROMATIC_APPROX_MAX_VISITED (CHROMATIC_APPROX_BATCH*64)
+#endif
+
 /**
  * Class containing the information necessary to decide whether a Node has
  * been retired. This information is used by the hazard pointer scheme
@@ -128,6 +149,7 @@ private:
     #define SCXAndEnterQuiescentState scx
 
     int help(const int tid, SCXRecord<K,V> *scx, bool helpingOther);
+    bool qProtectForHelping(const int tid, SCXRecord<K,V> *scx); // DEBRA+ with CRASH_RECOVERY_USING_CHECKPOINTS
     bool scx(
             const int tid,
             const int operationType,
@@ -152,7 +174,32 @@ private:
     bool updateInsert(const int, const K& key, const V& val, const bool onlyIfAbsent, V *result, bool *shouldRebalance); // last 2 args are output args
     bool updateErase(const int, const K& key, V *result, bool *shouldRebalance); // last 2 args are output args
     bool updateRebalancingStep(const int tid, const K& key);
+    bool searchLeaf(const int tid, const K& key, const bool below, Node<K,V> ** const result, Node<K,V> ** const resultParent, K * const lo, bool * const hasLo, K * const hi, bool * const hasHi);
     int computeSize(Node<K,V>* node);
+#ifdef CHROMATIC_ORDER_STATISTICS
+    long long countLess(const int tid, const K& key, const bool inclusive);
+#endif
+#ifdef CHROMATIC_ORDER_STATISTICS
+    bool refreshCount(Node<K,V> * const node);
+    void refreshSubtreeCounts(const int tid, Node<K,V> * const node, const int depth);
+#endif
+#ifdef CHROMATIC_EXACT_COUNTS
+    void propagateCounts(const int tid, const K& key, const int depth);
+#endif
+#ifdef CHROMATIC_APPROX_COUNTS
+    // the updates whose search paths thread tid has not refreshed yet
+    struct approx_entry {
+        K key;
+        int depth;
+    };
+    approx_entry *approxEntries;    // approxEntries[tid*(CHROMATIC_APPROX_BATCH+PREFETCH_SIZE_WORDS)+i]
+    int *approxSize;                // approxSize[tid*PREFETCH_SIZE_WORDS] = number of entries
+    Node<K,V> **approxVisited;      // approxVisited[tid*CHROMATIC_APPROX_MAX_VISITED+i]
+    #define GET_APPROX_ENTRIES(tid) (&approxEntries[(tid)*(CHROMATIC_APPROX_BATCH+PREFETCH_SIZE_WORDS)])
+    void bufferCounts(const int tid, const K& key, const int depth);
+    bool refreshBatchCounts(const int tid, Node<K,V> * const node, const bool sentinel, const int lo, const int hi, int * const numVisited);
+    void propagateBufferedCounts(const int tid);
+#endif
     
     // rotations
     void fixAllToKey(const int tid, const K& k);
@@ -193,6 +240,12 @@ private:
         return debugKeySum((Node<K,V> *) node->left.load(memory_order_relaxed))
              + debugKeySum((Node<K,V> *) node->right.load(memory_order_relaxed));
     }
+    long long debugKeyCount(Node<K,V> * node) {
+        if (node == NULL) return 0;
+        if ((Node<K,V> *) node->left.load(memory_order_relaxed) == NULL) return (node->key != NO_KEY);
+        return debugKeyCount((Node<K,V> *) node->left.load(memory_order_relaxed))
+             + debugKeyCount((Node<K,V> *) node->right.load(memory_order_relaxed));
+    }
     
 public:
     const K& NO_KEY;
@@ -248,6 +301,11 @@ public:
         delete recordmgr;
         delete counters;
         delete[] allocatedSCXRecord;
+#ifdef CHROMATIC_APPROX_COUNTS
+        delete[] approxEntries;
+        delete[] approxSize;
+        delete[] approxVisited;
+#endif
     }
 
     Node<K,V> *getRoot(void) { return root; }
@@ -256,6 +314,42 @@ public:
     const pair<V,bool> erase(const int tid, const K& key);
     const pair<V,bool> find(const int tid, const K& key);
     bool contains(const int tid, const K& key);
+    
+    /**
+     * successor stores the smallest key >= key, and its value, in *resultKey
+     * and *resultValue, and returns true, or returns false if there is no such key.
+     * predecessor is symmetric (it finds the largest key <= key).
+     * Both are linearizable, and perform at most two searches from the root
+     * (see searchLeaf in chromatic_impl.h).
+     */
+    bool successor(const int tid, const K& key, K * const resultKey, V * const resultValue);
+    bool predecessor(const int tid, const K& key, K * const resultKey, V * const resultValue);
+#ifdef CHROMATIC_ORDER_STATISTICS
+    /**
+     * Order statistics (only with -DCHROMATIC_ORDER_STATISTICS).
+     * Each of these performs one or two searches from the root, adding up the
+     * counts stored in the children of the nodes it visits.
+     * rank returns the number of keys < key.
+     * select stores the key with rank i (the (i+1)st smallest key), and its
+     * value, in *resultKey and *resultValue, and returns true, or returns false
+     * if i < 0 or i >= the number of keys.
+     * countInRange returns the number of keys in [lo, hi].
+     * The results are exact if no update is in progress. With
+     * -DCHROMATIC_APPROX_COUNTS, they are approximate (and select may return a
+     * key whose rank is close to i; see approxCountErrorBound).
+     */
+    long long rank(const int tid, const K& key);
+    bool select(const int tid, const long long i, K * const resultKey, V * const resultValue);
+    long long countInRange(const int tid, const K& lo, const K& hi);
+#ifdef CHROMATIC_APPROX_COUNTS
+    // the largest error in a count (or in rank, or in the rank of the key
+    // returned by select) when no update is in progress. the error of
+    // countInRange is at most twice this.
+    long long approxCountErrorBound() {
+        return (long long) recordmgr->NUM_PROCESSES * CHROMATIC_APPROX_BATCH;
+    }
+#endif
+#endif
     int size(void); /** warning: size is a LINEAR time operation, and does not return consistent results with concurrency **/
     
     /**
@@ -265,6 +359,9 @@ public:
     long long debugKeySum() {
         return debugKeySum((Node<K,V> *) (((Node<K,V> *) root->left.load(memory_order_relaxed))->left.load(memory_order_relaxed)));
     }
+    long long debugKeyCount() {
+        return debugKeyCount((Node<K,V> *) (((Node<K,V> *) root->left.load(memory_order_relaxed))->left.load(memory_order_relaxed)));
+    }
     void debugPrintAllocatorStatus() {
         recordmgr->printStatus();
     }
@@ -36,12 +36,12 @@ using namespace std;
     info.obj = _obj; \
     info.ptrToObj = arg2; \
     info.nodeContainingPtrToObjIsMarked = arg3; \
-    if (_obj != dummy && !recordmgr->protect(tid, _obj, callbackCheckNotRetired, (void*) &info))
+    if ((_obj != dummy && !recordmgr->protect(tid, _obj, callbackCheckNotRetired, (void*) &info)) || NEUTRALIZED(tid))
 #define IF_FAIL_TO_PROTECT_NODE(info, tid, _obj, arg2, arg3) \
     info.obj = _obj; \
     info.ptrToObj = arg2; \
     info.nodeContainingPtrToObjIsMarked = arg3; \
-    if (_obj != root && !recordmgr->protect(tid, _obj, callbackCheckNotRetired, (void*) &info))
+    if ((_obj != root && !recordmgr->protect(tid, _obj, callbackCheckNotRetired, (void*) &info)) || NEUTRALIZED(tid))
 
 inline CallbackReturn callbackCheckNotRetired(CallbackArg arg) {
     Chromatic_retired_info *info = (Chromatic_retired_info*) arg;
@@ -79,6 +79,41 @@ inline CallbackReturn callbackCheckNotRetired(CallbackArg arg) {
     (_newop)->allFrozen.store(false, memory_order_relaxed); \
     (_newop)->field = (_field); \
 }
+#ifdef CHROMATIC_ORDER_STATISTICS
+#define COUNT_OF_WORD(word) ((uint64_t) ((word) & 0xffffffffULL))
+#define COUNT_OF(node) countOf((Node<K,V>*) (node))
+template <class K, class V>
+inline uint64_t countOf(Node<K,V> * const node) {
+    return (node == NULL) ? 0 : COUNT_OF_WORD(node->count.load(memory_order_relaxed));
+}
+#define NEXT_COUNT_WORD(word, count) (((((word)>>32)+1)<<32) | (count))
+// a leaf contains one key (unless it is a sentinel), and the count of an
+// internal node is computed from its children, which are initialized first.
+// the version number is incremented (rather than reset) when a node is reused,
+// so a thread that was neutralized (in DEBRA+) cannot overwrite its count.
+#define initializeCount(_newnode, _left, _right) \
+    (_newnode)->count.store(NEXT_COUNT_WORD((_newnode)->count.load(memory_order_relaxed), \
+            ((_left) == NULL) ? (uint64_t) ((_newnode)->key != NO_KEY) : COUNT_OF(_left) + COUNT_OF(_right)), memory_order_relaxed);
+#else
+#define initializeCount(_newnode, _left, _right)
+#endif
+#ifdef CHROMATIC_ORDER_STATISTICS
+// the nodes created by a rebalancing step are at most this many levels below
+// the search path for the key whose path the step fixed
+#define REBALANCING_REFRESH_DEPTH 3
+#endif
+#ifdef CHROMATIC_EXACT_COUNTS
+#define PROPAGATE_COUNTS(tid, key, depth) propagateCounts((tid), (key), (depth))
+#elif defined CHROMATIC_APPROX_COUNTS
+#define PROPAGATE_COUNTS(tid, key, depth) bufferCounts((tid), (key), (depth))
+#else
+#define PROPAGATE_COUNTS(tid, key, depth)
+#endif
+// maximum length of a search path whose counts propagateCounts refreshes
+#ifndef MAX_PATH_LENGTH
+#define MAX_PATH_LENGTH 1024
+#endif
+
 #define initializeNode(_tid, _newnode, _key, _value, _weight, _left, _right) \
 (_newnode); \
 { \
@@ -92,6 +127,7 @@ inline CallbackReturn callbackCheckNotRetired(CallbackArg arg) {
     (_newnode)->right.store((uintptr_t) (_right), memory_order_relaxed); \
     (_newnode)->scxRecord.store((uintptr_t) dummy, memory_order_relaxed); \
     (_newnode)->marked.store(false, memory_order_relaxed); \
+    initializeCount((_newnode), (_left), (_right)); \
 }
 
 template<class K, class V, class Compare, class MasterRecordMgr>
@@ -124,6 +160,23 @@ Chromatic<K,V,Compare,MasterRecordMgr>::Chromatic(const K& _NO_KEY,
     for (int tid=0;tid<numProcesses;++tid) {
         GET_ALLOCATED_SCXRECORD_PTR(tid) = NULL;
     }
+#ifdef CHROMATIC_ORDER_STATISTICS
+    // propagateCounts (and propagateBufferedCounts) follow pointers from nodes
+    // they have not protected, which is only safe with a reclaimer that
+    // protects every node an operation can reach
+    if (!recordmgr->isProtected(tid, rootleft)) {
+        COUTATOMIC("ERROR: order statistics cannot be used with this reclaimer"<<endl);
+        exit(-1);
+    }
+#endif
+#ifdef CHROMATIC_APPROX_COUNTS
+    approxEntries = new approx_entry[numProcesses*(CHROMATIC_APPROX_BATCH+PREFETCH_SIZE_WORDS)];
+    approxSize = new int[numProcesses*PREFETCH_SIZE_WORDS];
+    approxVisited = new Node<K,V>*[numProcesses*CHROMATIC_APPROX_MAX_VISITED];
+    for (int tid=0;tid<numProcesses;++tid) {
+        approxSize[tid*PREFETCH_SIZE_WORDS] = 0;
+    }
+#endif
 }
 
 /**
@@ -171,6 +224,11 @@ const pair<V,bool> Chromatic<K,V,Compare,MasterRecordMgr>::find(const int tid, c
             assert(recordmgr->isProtected(tid, p));
             l = (Node<K,V>*) p->left.load(memory_order_relaxed);
             if (l == NULL) {
+                if (NEUTRALIZED(tid)) {
+                    recordmgr->enterQuiescentState(tid);
+                    counters->findFail->inc(tid);
+                    continue; /* retry */
+                }
                 result = pair<V,bool>(NO_VALUE, false); // no keys in data structure
                 recordmgr->enterQuiescentState(tid);
                 counters->findSuccess->inc(tid);
@@ -181,6 +239,7 @@ const pair<V,bool> Chromatic<K,V,Compare,MasterRecordMgr>::find(const int tid, c
                 counters->findFail->inc(tid);
                 continue; /* retry */ 
             }
+            STALL_POINT(tid);
 
             assert(recordmgr->isProtected(tid, l));
             while ((Node<K,V>*) l->left.load(memory_order_relaxed) != NULL) {
@@ -194,17 +253,13 @@ const pair<V,bool> Chromatic<K,V,Compare,MasterRecordMgr>::find(const int tid, c
                     assert(recordmgr->isProtected(tid, p));
                     l = (Node<K,V>*) p->left.load(memory_order_relaxed);
                     IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->left, &p->marked) {
-                        recordmgr->enterQuiescentState(tid); 
-                        counters->findFail->inc(tid);
-                        continue; /* retry */ 
+                        goto retry; // (continue would only restart the traversal loop)
                     }
                 } else {
                     assert(recordmgr->isProtected(tid, p));
                     l = (Node<K,V>*) p->right.load(memory_order_relaxed);
                     IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->right, &p->marked) { 
-                        recordmgr->enterQuiescentState(tid); 
-                        counters->findFail->inc(tid);
-                        continue; /* retry */ 
+                        goto retry;
                     }
                 }
                 assert(recordmgr->isProtected(tid, l));
@@ -216,14 +271,542 @@ const pair<V,bool> Chromatic<K,V,Compare,MasterRecordMgr>::find(const int tid, c
             } else {
                 result = pair<V,bool>(NO_VALUE, false);
             }
+            // result may have been read from a reclaimed node if we were neutralized
+            if (NEUTRALIZED(tid)) goto retry;
             recordmgr->enterQuiescentState(tid);
             counters->findSuccess->inc(tid);
             return result; // success
         }
+        continue;
+retry:
+        recordmgr->enterQuiescentState(tid);
+        counters->findFail->inc(tid);
     }
     return pair<V,bool>(NO_VALUE, false);
 }
 
+/**
+ * Searches for key (or, if below is true, for a key that is just smaller than
+ * key), and stores the leaf it reaches in *result (or NULL if the tree is empty),
+ * and its parent in *resultParent. Both are left protected.
+ * 
+ * We also store the bounds on the key range of the leaf that are described by
+ * the keys on the path we followed: a lower bound (inclusive) in *lo and an
+ * upper bound (exclusive) in *hi. *hasLo (resp., *hasHi) is false if the range
+ * is unbounded below (resp., above). The key range of a node can only grow
+ * while it is in the tree, so its range contains [*lo, *hi) from the time we
+ * reach it until it is removed.
+ * 
+ * Returns false if the search must be retried.
+ * Must be invoked by an operation that is not in a quiescent state.
+ */
+template<class K, class V, class Compare, class MasterRecordMgr>
+bool Chromatic<K,V,Compare,MasterRecordMgr>::searchLeaf(
+            const int tid,
+            const K& key,
+            const bool below,
+            Node<K,V> ** const result,
+            Node<K,V> ** const resultParent,
+            K * const lo,
+            bool * const hasLo,
+            K * const hi,
+            bool * const hasHi) {
+    Chromatic_retired_info info;
+    *hasLo = false;
+    *hasHi = false;
+    // root is never retired, so we don't need to call
+    // protectPointer before accessing its child pointers
+    Node<K,V> *p = (Node<K,V>*) root->left.load(memory_order_relaxed);
+    IF_FAIL_TO_PROTECT_NODE(info, tid, p, &root->left, &root->marked) {
+        return false;
+    }
+    assert(p != root);
+    Node<K,V> *l = (Node<K,V>*) p->left.load(memory_order_relaxed);
+    if (l == NULL) {
+        *result = NULL; // no keys in data structure
+        return true;
+    }
+    IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->left, &p->marked) {
+        return false;
+    }
+    while ((Node<K,V>*) l->left.load(memory_order_relaxed) != NULL) {
+        assert(recordmgr->isProtected(tid, p));
+        recordmgr->unprotect(tid, p);
+        p = l; // note: the new p is currently protected
+        assert(p->key != NO_KEY);
+        if (below ? !cmp(p->key, key) : cmp(key, p->key)) {
+            *hi = p->key;
+            *hasHi = true;
+            l = (Node<K,V>*) p->left.load(memory_order_relaxed);
+            IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->left, &p->marked) {
+                return false;
+            }
+        } else {
+            *lo = p->key;
+            *hasLo = true;
+            l = (Node<K,V>*) p->right.load(memory_order_relaxed);
+            IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->right, &p->marked) {
+                return false;
+            }
+        }
+    }
+    assert(recordmgr->isProtected(tid, p));
+    assert(recordmgr->isProtected(tid, l));
+    *result = l;
+    *resultParent = p;
+    return true;
+}
+
+/**
+ * We search for key, and reach a leaf l whose key range [lo, hi) contains key.
+ * l was in the tree at some time t during the search, and, at time t, l->key
+ * was the only key in [lo, hi). So, if l->key >= key, it is the successor.
+ * 
+ * Otherwise, the successor is the smallest key >= hi. We search for hi, and
+ * reach a leaf l2 whose key range contains hi, and then check that l is still in
+ * the tree (leaves are never marked, so we check that the parent p of l is not
+ * marked, and still points to l). If so, l and l2 were both in the tree at some
+ * time t2 during the second search. Their key ranges are disjoint, so the range of l2 starts at
+ * hi, and l2->key was the successor at time t2.
+ * Otherwise, we retry.
+ * 
+ * The key range of a leaf can grow while it is in the tree (when a neighbouring
+ * leaf is deleted, the sibling of the deleted leaf is copied, but the children
+ * of that sibling are reused). If the range of l grew to contain hi, then l2 == l, and we
+ * repeat the second search with the new upper bound of l's range.
+ */
+template<class K, class V, class Compare, class MasterRecordMgr>
+bool Chromatic<K,V,Compare,MasterRecordMgr>::successor(const int tid, const K& key, K * const resultKey, V * const resultValue) {
+    bool found;
+    Node<K,V> *p, *l, *p2, *l2;
+    K lo, hi, lo2, hi2;
+    bool hasLo, hasHi, hasLo2, hasHi2;
+    for (;;) {
+        TRACE COUTATOMICTID("successor(tid="<<tid<<" key="<<key<<")"<<endl);
+        CHECKPOINT_AND_RUN_QUERY(tid) {
+            recordmgr->leaveQuiescentState(tid);
+            if (!searchLeaf(tid, key, false, &l, &p, &lo, &hasLo, &hi, &hasHi)) goto retry;
+            found = false;
+            if (l == NULL) {
+                // no keys in data structure
+            } else if (!cmp(l->key, key)) {
+                *resultKey = l->key;
+                *resultValue = l->value;
+                found = true;
+            } else {
+                while (hasHi) { // otherwise, l is the rightmost leaf
+                    if (!searchLeaf(tid, hi, false, &l2, &p2, &lo2, &hasLo2, &hi2, &hasHi2)) goto retry;
+                    if (l2 == NULL) goto retry; // l was removed
+                    if (l2 != l) {
+                        assert(recordmgr->isProtected(tid, l));
+                        assert(recordmgr->isProtected(tid, l2));
+                        *resultKey = l2->key;
+                        *resultValue = l2->value;
+                        SOFTWARE_BARRIER; // prevent compiler from moving the reads of p before the reads of l2
+                        if ((Node<K,V>*) p->left.load(memory_order_relaxed) != l
+                                && (Node<K,V>*) p->right.load(memory_order_relaxed) != l) goto retry;
+                        SOFTWARE_BARRIER; // prevent compiler from moving the read of p->marked before the reads of p's child pointers
+                        if (p->marked.load(memory_order_relaxed)) goto retry;
+                        found = true;
+                        break;
+                    }
+                    // the key range of l grew to contain hi
+                    recordmgr->unprotect(tid, l2);
+                    recordmgr->unprotect(tid, p2);
+                    hi = hi2;
+                    hasHi = hasHi2;
+                }
+            }
+            // result may have been read from a reclaimed node if we were neutralized
+            if (NEUTRALIZED(tid)) goto retry;
+            recordmgr->enterQuiescentState(tid);
+            counters->findSuccess->inc(tid);
+            return found;
+        }
+        continue;
+retry:
+        recordmgr->enterQuiescentState(tid);
+        counters->findFail->inc(tid);
+    }
+    return false;
+}
+
+/**
+ * Symmetric to successor: if l->key > key, the predecessor is the largest key
+ * < lo, which we find by searching for a key just smaller than lo.
+ */
+template<class K, class V, class Compare, class MasterRecordMgr>
+bool Chromatic<K,V,Compare,MasterRecordMgr>::predecessor(const int tid, const K& key, K * const resultKey, V * const resultValue) {
+    bool found;
+    Node<K,V> *p, *l, *p2, *l2;
+    K lo, hi, lo2, hi2;
+    bool hasLo, hasHi, hasLo2, hasHi2;
+    for (;;) {
+        TRACE COUTATOMICTID("predecessor(tid="<<tid<<" key="<<key<<")"<<endl);
+        CHECKPOINT_AND_RUN_QUERY(tid) {
+            recordmgr->leaveQuiescentState(tid);
+            if (!searchLeaf(tid, key, false, &l, &p, &lo, &hasLo, &hi, &hasHi)) goto retry;
+            found = false;
+            if (l == NULL) {
+                // no keys in data structure
+            } else if (!cmp(key, l->key)) {
+                *resultKey = l->key;
+                *resultValue = l->value;
+                found = true;
+            } else {
+                while (hasLo) { // otherwise, l is the leftmost leaf
+                    if (!searchLeaf(tid, lo, true, &l2, &p2, &lo2, &hasLo2, &hi2, &hasHi2)) goto retry;
+                    if (l2 == NULL) goto retry; // l was removed
+                    if (l2 != l) {
+                        assert(recordmgr->isProtected(tid, l));
+                        assert(recordmgr->isProtected(tid, l2));
+                        *resultKey = l2->key;
+                        *resultValue = l2->value;
+                        SOFTWARE_BARRIER; // prevent compiler from moving the reads of p before the reads of l2
+                        if ((Node<K,V>*) p->left.load(memory_order_relaxed) != l
+                                && (Node<K,V>*) p->right.load(memory_order_relaxed) != l) goto retry;
+                        SOFTWARE_BARRIER; // prevent compiler from moving the read of p->marked before the reads of p's child pointers
+                        if (p->marked.load(memory_order_relaxed)) goto retry;
+                        found = true;
+                        break;
+                    }
+                    // the key range of l grew to contain keys just smaller than lo
+                    recordmgr->unprotect(tid, l2);
+                    recordmgr->unprotect(tid, p2);
+                    lo = lo2;
+                    hasLo = hasLo2;
+                }
+            }
+            // result may have been read from a reclaimed node if we were neutralized
+            if (NEUTRALIZED(tid)) goto retry;
+            recordmgr->enterQuiescentState(tid);
+            counters->findSuccess->inc(tid);
+            return found;
+        }
+        continue;
+retry:
+        recordmgr->enterQuiescentState(tid);
+        counters->findFail->inc(tid);
+    }
+    return false;
+}
+
+#ifdef CHROMATIC_ORDER_STATISTICS
+
+/**
+ * Returns the number of keys < key (or <= key, if inclusive).
+ * Whenever the search goes right, every key in the left subtree is counted.
+ * The count of the left child is read after it is protected.
+ */
+template<class K, class V, class Compare, class MasterRecordMgr>
+long long Chromatic<K,V,Compare,MasterRecordMgr>::countLess(const int tid, const K& key, const bool inclusive) {
+    Chromatic_retired_info info;
+    long long result;
+    Node<K,V> *p, *l, *s;
+    for (;;) {
+        TRACE COUTATOMICTID("countLess(tid="<<tid<<" key="<<key<<" inclusive="<<inclusive<<")"<<endl);
+        CHECKPOINT_AND_RUN_QUERY(tid) {
+            recordmgr->leaveQuiescentState(tid);
+            result = 0;
+            // root is never retired, so we don't need to call
+            // protectPointer before accessing its child pointers
+            p = (Node<K,V>*) root->left.load(memory_order_relaxed);
+            IF_FAIL_TO_PROTECT_NODE(info, tid, p, &root->left, &root->marked) goto retry;
+            l = (Node<K,V>*) p->left.load(memory_order_relaxed);
+            if (l != NULL) { // otherwise, there are no keys in the data structure
+                IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->left, &p->marked) goto retry;
+                while ((Node<K,V>*) l->left.load(memory_order_relaxed) != NULL) {
+                    recordmgr->unprotect(tid, p);
+                    p = l; // note: the new p is currently protected
+                    assert(p->key != NO_KEY);
+                    if (inclusive ? cmp(key, p->key) : !cmp(p->key, key)) {
+                        l = (Node<K,V>*) p->left.load(memory_order_relaxed);
+                        IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->left, &p->marked) goto retry;
+                    } else {
+                        s = (Node<K,V>*) p->left.load(memory_order_relaxed);
+                        IF_FAIL_TO_PROTECT_NODE(info, tid, s, &p->left, &p->marked) goto retry;
+                        result += COUNT_OF(s);
+                        recordmgr->unprotect(tid, s);
+                        l = (Node<K,V>*) p->right.load(memory_order_relaxed);
+                        IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->right, &p->marked) goto retry;
+                    }
+                }
+                if (l->key != NO_KEY && (inclusive ? !cmp(key, l->key) : cmp(l->key, key))) ++result;
+            }
+            // result may have been read from a reclaimed node if we were neutralized
+            if (NEUTRALIZED(tid)) goto retry;
+            recordmgr->enterQuiescentState(tid);
+            return result; // (rank and countInRange count successes)
+        }
+        continue;
+retry:
+        recordmgr->enterQuiescentState(tid);
+        counters->findFail->inc(tid);
+    }
+    return 0;
+}
+
+template<class K, class V, class Compare, class MasterRecordMgr>
+long long Chromatic<K,V,Compare,MasterRecordMgr>::rank(const int tid, const K& key) {
+    const long long result = countLess(tid, key, false);
+    counters->findSuccess->inc(tid);
+    return result;
+}
+
+template<class K, class V, class Compare, class MasterRecordMgr>
+long long Chromatic<K,V,Compare,MasterRecordMgr>::countInRange(const int tid, const K& lo, const K& hi) {
+    // (the difference can be negative if keys < lo are inserted between the two searches)
+    const long long result = cmp(hi, lo) ? 0 : countLess(tid, hi, true) - countLess(tid, lo, false);
+    counters->findSuccess->inc(tid);
+    return (result < 0) ? 0 : result;
+}
+
+/**
+ * Descends from the root, going left if i < the count of the left child, and
+ * otherwise subtracting that count from i and going right.
+ */
+template<class K, class V, class Compare, class MasterRecordMgr>
+bool Chromatic<K,V,Compare,MasterRecordMgr>::select(const int tid, const long long i, K * const resultKey, V * const resultValue) {
+    Chromatic_retired_info info;
+    bool found;
+    long long j;
+    Node<K,V> *p, *l;
+    for (;;) {
+        TRACE COUTATOMICTID("select(tid="<<tid<<" i="<<i<<")"<<endl);
+        CHECKPOINT_AND_RUN_QUERY(tid) {
+            recordmgr->leaveQuiescentState(tid);
+            found = false;
+            // root is never retired, so we don't need to call
+            // protectPointer before accessing its child pointers
+            p = (Node<K,V>*) root->left.load(memory_order_relaxed);
+            IF_FAIL_TO_PROTECT_NODE(info, tid, p, &root->left, &root->marked) goto retry;
+            l = (Node<K,V>*) p->left.load(memory_order_relaxed);
+            if (l != NULL && i >= 0) {
+                IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->left, &p->marked) goto retry;
+                if (i < (long long) COUNT_OF(l)) {
+                    j = i;
+                    while ((Node<K,V>*) l->left.load(memory_order_relaxed) != NULL) {
+                        recordmgr->unprotect(tid, p);
+                        p = l; // note: the new p is currently protected
+                        l = (Node<K,V>*) p->left.load(memory_order_relaxed);
+                        IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->left, &p->marked) goto retry;
+                        const long long leftCount = COUNT_OF(l);
+                        if (j >= leftCount) {
+                            j -= leftCount;
+                            recordmgr->unprotect(tid, l);
+                            l = (Node<K,V>*) p->right.load(memory_order_relaxed);
+                            IF_FAIL_TO_PROTECT_NODE(info, tid, l, &p->right, &p->marked) goto retry;
+                        }
+                    }
+                    if (l->key != NO_KEY) {
+                        *resultKey = l->key;
+                        *resultValue = l->value;
+                        found = true;
+                    }
+                }
+            }
+            // result may have been read from a reclaimed node if we were neutralized
+            if (NEUTRALIZED(tid)) goto retry;
+            recordmgr->enterQuiescentState(tid);
+            counters->findSuccess->inc(tid);
+            return found;
+        }
+        continue;
+retry:
+        recordmgr->enterQuiescentState(tid);
+        counters->findFail->inc(tid);
+    }
+    return false;
+}
+
+/**
+ * Sets the count of node to the sum of the counts of its children, unless it
+ * is already equal to that sum. Returns false if the CAS fails, which means
+ * another thread changed the count after we read it.
+ * 
+ * If two consecutive refreshes of node by a thread both fail, then some
+ * refresh that read the children of node after the first one started
+ * succeeded. So, if every update refreshes the nodes on its search path,
+ * bottom-up, with (up to) two refreshes each, then each node's count includes
+ * the update by the time the update finishes.
+ */
+template<class K, class V, class Compare, class MasterRecordMgr>
+bool Chromatic<K,V,Compare,MasterRecordMgr>::refreshCount(Node<K,V> * const node) {
+    uint64_t old = node->count.load(memory_order_relaxed);
+    SOFTWARE_BARRIER; // read the version number before the counts of the children
+    const uint64_t count = COUNT_OF(node->left.load(memory_order_relaxed)) + COUNT_OF(node->right.load(memory_order_relaxed));
+    if (COUNT_OF_WORD(old) == count) return true;
+    return node->count.compare_exchange_strong(old, NEXT_COUNT_WORD(old, count));
+}
+
+// refreshes the internal nodes at most depth levels below node, bottom-up, and then node
+template<class K, class V, class Compare, class MasterRecordMgr>
+void Chromatic<K,V,Compare,MasterRecordMgr>::refreshSubtreeCounts(const int tid, Node<K,V> * const node, const int depth) {
+    Node<K,V> * const left = (Node<K,V>*) node->left.load(memory_order_relaxed);
+    if (left == NULL) return;
+    if (depth > 0) {
+        Node<K,V> * const right = (Node<K,V>*) node->right.load(memory_order_relaxed);
+        if (NEUTRALIZED(tid)) return; // the caller retries
+        refreshSubtreeCounts(tid, left, depth-1);
+        refreshSubtreeCounts(tid, right, depth-1);
+    }
+    if (!refreshCount(node)) refreshCount(node);
+}
+
+#endif /* CHROMATIC_ORDER_STATISTICS */
+
+#ifdef CHROMATIC_EXACT_COUNTS
+
+/**
+ * Invoked after an update to key succeeds (and after each rebalancing step on
+ * the search path for key): refreshes the counts of the internal nodes on the
+ * search path for key (and at most depth levels below them), bottom-up.
+ * If a node on the path was removed from the tree (i.e., marked) before we
+ * finished, then the path changed, and we repeat on the new path.
+ * 
+ * The nodes on the path are not protected, so this requires a reclaimer that
+ * does not reclaim any node reachable by an operation in a non-quiescent
+ * state (this is checked in the constructor).
+ */
+template<class K, class V, class Compare, class MasterRecordMgr>
+void Chromatic<K,V,Compare,MasterRecordMgr>::propagateCounts(const int tid, const K& key, const int depth) {
+    Node<K,V> *path[MAX_PATH_LENGTH];
+    int n;
+    for (;;) {
+        TRACE COUTATOMICTID("propagateCounts(tid="<<tid<<" key="<<key<<" depth="<<depth<<")"<<endl);
+        // we use CHECKPOINT_AND_RUN_QUERY here because refreshing counts does not need to be helped if a process is neutralized (we simply retry)
+        CHECKPOINT_AND_RUN_QUERY(tid) {
+            recordmgr->leaveQuiescentState(tid);
+            n = 0;
+            // root->left has key NO_KEY, so the search path always continues to its left child
+            Node<K,V> *node = (Node<K,V>*) root->left.load(memory_order_relaxed);
+            Node<K,V> *left = (Node<K,V>*) node->left.load(memory_order_relaxed);
+            if (left != NULL) {
+                path[n++] = node;
+                node = left;
+                // (we must not follow a pointer we read after being neutralized)
+                if (NEUTRALIZED(tid)) goto retry;
+                while ((left = (Node<K,V>*) node->left.load(memory_order_relaxed)) != NULL) {
+                    if (n == MAX_PATH_LENGTH) {
+                        COUTATOMICTID("ERROR: search path is longer than MAX_PATH_LENGTH"<<endl);
+                        exit(-1);
+                    }
+                    path[n++] = node;
+                    node = cmp(key, node->key) ? left : (Node<K,V>*) node->right.load(memory_order_relaxed);
+                    if (NEUTRALIZED(tid)) goto retry;
+                }
+            }
+            for (int i=n-1;i>=0;--i) {
+                refreshSubtreeCounts(tid, path[i], depth);
+                if (NEUTRALIZED(tid)) goto retry;
+            }
+            SOFTWARE_BARRIER; // check the marks after refreshing
+            for (int i=0;i<n;++i) {
+                if (path[i]->marked.load(memory_order_relaxed)) goto retry;
+            }
+            if (NEUTRALIZED(tid)) goto retry;
+            recordmgr->enterQuiescentState(tid);
+            return;
+        }
+        continue;
+retry:
+        recordmgr->enterQuiescentState(tid);
+    }
+}
+
+#endif /* CHROMATIC_EXACT_COUNTS */
+
+#ifdef CHROMATIC_APPROX_COUNTS
+
+/**
+ * Invoked instead of propagateCounts: adds key (and depth) to thread tid's
+ * batch, and, once the batch is full, refreshes the counts on the search
+ * paths of all of its keys. Thus, at most CHROMATIC_APPROX_BATCH updates by
+ * each thread are not yet reflected in the counts of the nodes above them.
+ */
+template<class K, class V, class Compare, class MasterRecordMgr>
+void Chromatic<K,V,Compare,MasterRecordMgr>::bufferCounts(const int tid, const K& key, const int depth) {
+    approx_entry * const entries = GET_APPROX_ENTRIES(tid);
+    int& size = approxSize[tid*PREFETCH_SIZE_WORDS];
+    entries[size].key = key;
+    entries[size].depth = depth;
+    if (++size == CHROMATIC_APPROX_BATCH) {
+        propagateBufferedCounts(tid);
+        size = 0;
+    }
+}
+
+/**
+ * Refreshes the counts of the internal nodes on the search paths (from node)
+ * for the keys in entries [lo, hi) of thread tid's batch (which are sorted),
+ * bottom-up, and at most depth levels below them (as in propagateCounts).
+ * Each node is refreshed once, no matter how many of the paths contain it,
+ * and is appended to thread tid's approxVisited array.
+ * (All keys go left at the sentinel root->left, whose key is NO_KEY.)
+ * Returns false if the thread was neutralized.
+ */
+template<class K, class V, class Compare, class MasterRecordMgr>
+bool Chromatic<K,V,Compare,MasterRecordMgr>::refreshBatchCounts(const int tid, Node<K,V> * const node, const bool sentinel, const int lo, const int hi, int * const numVisited) {
+    Node<K,V> * const left = (Node<K,V>*) node->left.load(memory_order_relaxed);
+    if (left == NULL) return true;
+    Node<K,V> * const right = (Node<K,V>*) node->right.load(memory_order_relaxed);
+    // (we must not follow a pointer we read after being neutralized)
+    if (NEUTRALIZED(tid)) return false;
+    approx_entry * const entries = GET_APPROX_ENTRIES(tid);
+    int depth = 0;
+    int mid = lo;
+    for (int i=lo;i<hi;++i) {
+        if (entries[i].depth > depth) depth = entries[i].depth;
+        if (!sentinel && cmp(entries[i].key, node->key)) mid = i+1;
+    }
+    if (sentinel) mid = hi;
+    if (lo < mid && !refreshBatchCounts(tid, left, false, lo, mid, numVisited)) return false;
+    if (mid < hi && !refreshBatchCounts(tid, right, false, mid, hi, numVisited)) return false;
+    refreshSubtreeCounts(tid, node, depth);
+    if (*numVisited == CHROMATIC_APPROX_MAX_VISITED) {
+        COUTATOMICTID("ERROR: search paths of a batch contain more than CHROMATIC_APPROX_MAX_VISITED nodes"<<endl);
+        exit(-1);
+    }
+    approxVisited[tid*CHROMATIC_APPROX_MAX_VISITED + (*numVisited)++] = node;
+    return !NEUTRALIZED(tid);
+}
+
+/**
+ * Refreshes the counts on the search paths for the keys in thread tid's batch.
+ * As in propagateCounts, if a node on the paths was removed from the tree
+ * (i.e., marked) before we finished, then the paths changed, and we repeat.
+ */
+template<class K, class V, class Compare, class MasterRecordMgr>
+void Chromatic<K,V,Compare,MasterRecordMgr>::propagateBufferedCounts(const int tid) {
+    approx_entry * const entries = GET_APPROX_ENTRIES(tid);
+    const int size = approxSize[tid*PREFETCH_SIZE_WORDS];
+    const Compare& c = cmp;
+    std::sort(entries, entries+size, [&c](const approx_entry& a, const approx_entry& b) { return c(a.key, b.key); });
+    Node<K,V> ** const visited = &approxVisited[tid*CHROMATIC_APPROX_MAX_VISITED];
+    int numVisited;
+    for (;;) {
+        TRACE COUTATOMICTID("propagateBufferedCounts(tid="<<tid<<" size="<<size<<")"<<endl);
+        // we use CHECKPOINT_AND_RUN_QUERY here because refreshing counts does not need to be helped if a process is neutralized (we simply retry)
+        CHECKPOINT_AND_RUN_QUERY(tid) {
+            recordmgr->leaveQuiescentState(tid);
+            numVisited = 0;
+            if (!refreshBatchCounts(tid, (Node<K,V>*) root->left.load(memory_order_relaxed), true, 0, size, &numVisited)) goto retry;
+            SOFTWARE_BARRIER; // check the marks after refreshing
+            for (int i=0;i<numVisited;++i) {
+                if (visited[i]->marked.load(memory_order_relaxed)) goto retry;
+            }
+            if (NEUTRALIZED(tid)) goto retry;
+            recordmgr->enterQuiescentState(tid);
+            return;
+        }
+        continue;
+retry:
+        recordmgr->enterQuiescentState(tid);
+    }
+}
+
+#endif /* CHROMATIC_APPROX_COUNTS */
+
 template<class K, class V, class Compare, class MasterRecordMgr>
 const V Chromatic<K,V,Compare,MasterRecordMgr>::insert(const int tid, const K& key, const V& val) {
     bool onlyIfAbsent = false;
@@ -239,6 +822,7 @@ const V Chromatic<K,V,Compare,MasterRecordMgr>::insert(const int tid, const K& k
             else counters->insertSuccess->inc(tid);
         }
     }
+    if (result == NO_VALUE) PROPAGATE_COUNTS(tid, key, 0);
     // call another routine to handle rebalancing.
     // this is considered to be a whole new operation (possibly many, in fact).
     IFREBALANCING if (shouldRebalance) {
@@ -262,6 +846,7 @@ const bool Chromatic<K,V,Compare,MasterRecordMgr>::insertIfAbsent(const int tid,
             else counters->insertSuccess->inc(tid);
         }
     }
+    if (result == NO_VALUE) PROPAGATE_COUNTS(tid, key, 0);
     // call another routine to handle rebalancing.
     // this is considered to be a whole new operation (possibly many, in fact).
     IFREBALANCING if (shouldRebalance) {
@@ -284,6 +869,7 @@ const pair<V,bool> Chromatic<K,V,Compare,MasterRecordMgr>::erase(const int tid,
             else counters->eraseSuccess->inc(tid);
         }
     }
+    if (result != NO_VALUE) PROPAGATE_COUNTS(tid, key, 0);
     // call another routine to handle rebalancing.
     // this is considered to be a whole new operation (possibly many, in fact).
     IFREBALANCING if (shouldRebalance) {
@@ -302,6 +888,7 @@ void Chromatic<K,V,Compare,MasterRecordMgr>::fixAllToKey(const int tid, const K&
             finished = updateRebalancingStep(tid, key);
             recordmgr->enterQuiescentState(tid);
         }
+        if (!finished) PROPAGATE_COUNTS(tid, key, REBALANCING_REFRESH_DEPTH);
     }
 }
 
@@ -377,6 +964,7 @@ bool Chromatic<K,V,Compare,MasterRecordMgr>::updateInsert(
         if (onlyIfAbsent) {
             assert(recordmgr->isProtected(tid, l));
             *result = l->value;
+            if (NEUTRALIZED(tid)) return false; // l may have been reclaimed
             TRACE COUTATOMICTID("return true5\n");
             return true; // success
         }
@@ -483,6 +1071,7 @@ bool Chromatic<K,V,Compare,MasterRecordMgr>::updateErase(
     } // return and retry
     assert(recordmgr->isProtected(tid, l));
     if ((Node<K,V>*) l->left.load(memory_order_relaxed) == NULL) {
+        if (NEUTRALIZED(tid)) return false; // l may have been reclaimed
         TRACE COUTATOMICTID("return true2\n");
         return true;
     } // only sentinels in tree...
@@ -533,6 +1122,7 @@ bool Chromatic<K,V,Compare,MasterRecordMgr>::updateErase(
     // if we fail to find the key in the tree
     assert(recordmgr->isProtected(tid, l));
     if (key != l->key) {
+        if (NEUTRALIZED(tid)) return false; // l may have been reclaimed
         *result = NO_VALUE;
         return true; // success
     } else {
@@ -618,7 +1208,7 @@ bool Chromatic<K,V,Compare,MasterRecordMgr>::updateRebalancingStep(
 
     Chromatic_retired_info info;
     IF_FAIL_TO_PROTECT_NODE(info, tid, l, &root->left, &root->marked) return false; // return and retry
-    if ((Node<K,V>*) l->left.load(memory_order_relaxed) == NULL) return true; // only sentinels in tree...
+    if ((Node<K,V>*) l->left.load(memory_order_relaxed) == NULL) return !NEUTRALIZED(tid); // only sentinels in tree...
     
     ggp = gp = root;
     p = l; // note: p is protected by the above call to protect(..., l, ...)
@@ -650,7 +1240,7 @@ bool Chromatic<K,V,Compare,MasterRecordMgr>::updateRebalancingStep(
     }
     assert(recordmgr->isProtected(tid, l));
     if (l->weight == 1) {
-        return true; // (if no violation, then we hit a leaf, so we can stop)
+        return !NEUTRALIZED(tid); // (if no violation, then we hit a leaf, so we can stop)
     }
 
     // a few aliases to make the code more uniform
@@ -1514,6 +2104,18 @@ bool Chromatic<K,V,Compare,MasterRecordMgr>::scx(
         // memory barriers are not needed for these qProtect() calls on x86/64
         // because there's no write-write reordering, and nothing can be
         // reordered over the first freezing CAS in help().
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+        // last checkpoint: if we have not been neutralized after our qProtects
+        // are visible, then everything we read is still allocated, and no
+        // record we write to in help() can be reclaimed.
+        // (so, we finish this scx even if we are neutralized during help().)
+        __sync_synchronize();
+        if (NEUTRALIZED(tid)) {
+            recordmgr->qUnprotectAll(tid);
+            recordmgr->enterQuiescentState(tid);
+            return false;
+        }
+#endif
         
     // if we don't have crash recovery, then we only need to protect our scx
     // record, so that it's not retired and freed out from under us by someone
@@ -1716,6 +2318,36 @@ int Chromatic<K,V,Compare,MasterRecordMgr>::help(const int tid, SCXRecord<K,V> *
     return SCXRecord<K,V>::STATE_COMMITTED; // success
 }
 
+// with CRASH_RECOVERY_USING_CHECKPOINTS, a thread can be neutralized while it
+// helps another thread's scx, so, before helping, it must qProtect the scx
+// record and the nodes that help() writes to (just as scx() does).
+// returns false if the thread was neutralized (so it must not help).
+// you may call this only if scx is protected by a call to recordmgr->protect.
+template<class K, class V, class Compare, class MasterRecordMgr>
+bool Chromatic<K,V,Compare,MasterRecordMgr>::qProtectForHelping(const int tid, SCXRecord<K,V> *scx) {
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+    if (recordmgr->supportsCrashRecovery()) {
+        recordmgr->qProtect(tid, scx, callbackReturnTrue, NULL, false);
+        __sync_synchronize();
+        if (NEUTRALIZED(tid)) {
+            recordmgr->qUnprotectAll(tid);
+            return false;
+        }
+        // scx cannot be reclaimed now, so we can read its nodes
+        const int type = scx->type;
+        for (int i=0;i<NUM_OF_NODES[type];++i) {
+            recordmgr->qProtect(tid, scx->nodes[i], callbackReturnTrue, NULL, false);
+        }
+        __sync_synchronize();
+        if (NEUTRALIZED(tid)) {
+            recordmgr->qUnprotectAll(tid);
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
 // you may call this only if node is protected by a call to recordmgr->protect
 template<class K, class V, class Compare, class MasterRecordMgr>
 void *Chromatic<K,V,Compare,MasterRecordMgr>::llx(
@@ -1795,16 +2427,30 @@ void *Chromatic<K,V,Compare,MasterRecordMgr>::llx(
                 } // return and retry
                 assert(scx2 != dummy);
                 assert(recordmgr->isProtected(tid, scx2));
+                if (!qProtectForHelping(tid, scx2)) {
+                    DEBUG counters->llxFail->inc(tid);
+                    return NULL;
+                }
                 TRACE COUTATOMICTID("llx help 1 tid="<<tid<<endl);
                 help(tid, scx2, true);
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+                recordmgr->qUnprotectAll(tid);
+#endif
             }
         }
     } else if (state == SCXRecord<K,V>::STATE_INPROGRESS) {
         if (recordmgr->shouldHelp()) {
             assert(scx1 != dummy);
             assert(recordmgr->isProtected(tid, scx1));
+            if (!qProtectForHelping(tid, scx1)) {
+                DEBUG counters->llxFail->inc(tid);
+                return NULL;
+            }
             TRACE COUTATOMICTID("llx help 2 tid="<<tid<<endl);
             help(tid, scx1, true);
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+            recordmgr->qUnprotectAll(tid);
+#endif
         }
     } else {
         // state committed and marked
@@ -1819,8 +2465,15 @@ void *Chromatic<K,V,Compare,MasterRecordMgr>::llx(
             } // return and retry
             assert(scx3 != dummy);
             assert(recordmgr->isProtected(tid, scx3));
+            if (!qProtectForHelping(tid, scx3)) {
+                DEBUG counters->llxFail->inc(tid);
+                return NULL;
+            }
             TRACE COUTATOMICTID("llx help 3 tid="<<tid<<endl);
             help(tid, scx3, true);
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+            recordmgr->qUnprotectAll(tid);
+#endif
         } else {
         }
     }
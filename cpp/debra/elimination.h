@@ -0,0 +1,258 @@
+/*
+ * File:   elimination.h
+ *
+ * An elimination and combining layer for updates to hot keys.
+ *
+ * A thread whose insertion or deletion failed (because of contention) on its
+ * first attempt announces it in a per-thread request record, and then tries
+ * to acquire the combiner lock for its key (keys are hashed to
+ * ELIMINATION_SLOTS locks). The thread that holds the lock claims every
+ * pending request for the same key (including its own), and orders the batch
+ * so that it can be performed with ONE operation on the data structure:
+ *  - if there is at least one erase, the inserts come first (in the order
+ *    they were found) and the erases last, so the batch is equivalent to
+ *    erase(key). if the key was absent, this is just a search, and all of the
+ *    batch's opposing insert/erase pairs have cancelled out (eliminated).
+ *  - otherwise, the batch is equivalent to insert(key, value of the last
+ *    insert), or, if there are only insertIfAbsents, to
+ *    insertIfAbsent(key, value of the first insertIfAbsent).
+ * The value associated with key before this operation determines the result
+ * of every operation in the batch. The operations in a batch are all pending
+ * while the combiner performs its operation, so they can be linearized, in
+ * batch order, at its linearization point.
+ *
+ * A thread whose request has not been claimed withdraws it after spinning
+ * ELIMINATION_PATIENCE times, and performs its operation directly, so
+ * threads only ever wait for a combiner that has claimed their requests
+ * (which, strictly speaking, means the layer is blocking if a combiner is
+ * descheduled or crashes in the middle of a batch).
+ * Waiting threads are quiescent, so they do not delay memory reclamation.
+ *
+ * The data structure passes a functor apply(op, key, value) that performs an
+ * operation (retrying until it succeeds) and returns the value associated
+ * with key just before the operation (or NO_VALUE if key was absent).
+ *
+ * There is a copy of this file in range_queries/common/ (each project is built on its
+ * own), which differs only in the header it includes for PREFETCH_SIZE_BYTES.
+ * Change them together.
+ */
+
+#ifndef ELIMINATION_H
+#define ELIMINATION_H
+
+#include <functional>
+#include <sched.h>
+#include "recordmgr/machineconstants.h"
+
+#ifndef ELIMINATION_SLOTS
+#define ELIMINATION_SLOTS 64
+#endif
+#ifndef ELIMINATION_PATIENCE
+#define ELIMINATION_PATIENCE 2000
+#endif
+
+#define ELIMINATION_OP_INSERT 0
+#define ELIMINATION_OP_INSERT_IF_ABSENT 1
+#define ELIMINATION_OP_ERASE 2
+
+template <typename K, typename V>
+class elimination_layer {
+private:
+    // a request's state contains a status in its low two bits, and the
+    // sequence number of the request above them (to avoid ABA when a
+    // combiner claims a request that is withdrawn and reannounced)
+    enum { STATUS_EMPTY=0, STATUS_PENDING=1, STATUS_CLAIMED=2, STATUS_DONE=3 };
+    #define ELIMINATION_STATUS(state) ((int) ((state)&3))
+
+    struct request_t {
+        volatile long long state;
+        volatile int op;
+        K key;
+        V value;
+        V result;
+        char padding[PREFETCH_SIZE_BYTES];
+    };
+    struct slot_t {
+        volatile int lock;
+        char padding[PREFETCH_SIZE_BYTES];
+    };
+    struct stats_t {
+        long long batches;      // batches with two or more requests
+        long long combined;     // requests in those batches
+        long long eliminated;   // requests in those batches that did not need an update of their own
+        char padding[PREFETCH_SIZE_BYTES];
+    };
+
+    const int numProcesses;
+    const V NO_VALUE;
+    request_t * const requests;
+    slot_t * const slots;
+    stats_t * const stats;
+    int * const batches;        // batches[tid*numProcesses+i] = i-th request claimed by combiner tid
+
+    inline int slotOf(const K& key) {
+        const unsigned long long h = (unsigned long long) std::hash<K>()(key) * 0x9E3779B97F4A7C15ULL;
+        return (int) ((h >> 32) % ELIMINATION_SLOTS);
+    }
+
+    // performed by the holder of key's combiner lock
+    template <typename Apply>
+    void runBatch(const int tid, const K& key, Apply& apply) {
+        int * const batch = &batches[tid*numProcesses];
+        int size = 0;
+        int lastInsert = -1;
+        int firstInsertIfAbsent = -1;
+        bool erase = false;
+        for (int i=0;i<numProcesses;++i) {
+            request_t * const other = &requests[i];
+            const long long state = other->state;
+            if (ELIMINATION_STATUS(state) != STATUS_PENDING) continue;
+            __sync_synchronize();
+            if (!(other->key == key)) continue;
+            if (!__sync_bool_compare_and_swap(&other->state, state, state - STATUS_PENDING + STATUS_CLAIMED)) continue;
+            batch[size++] = i;
+            switch (other->op) {
+                case ELIMINATION_OP_INSERT: lastInsert = i; break;
+                case ELIMINATION_OP_INSERT_IF_ABSENT: if (firstInsertIfAbsent < 0) firstInsertIfAbsent = i; break;
+                default: erase = true; break;
+            }
+        }
+        if (size == 0) return; // our own request was withdrawn or claimed before we got the lock
+
+        // perform the batch's net operation
+        int op;
+        V value = NO_VALUE;
+        if (erase) {
+            op = ELIMINATION_OP_ERASE;
+        } else if (lastInsert >= 0) {
+            op = ELIMINATION_OP_INSERT;
+            value = requests[lastInsert].value;
+        } else {
+            op = ELIMINATION_OP_INSERT_IF_ABSENT;
+            value = requests[firstInsertIfAbsent].value;
+        }
+        const V before = apply(op, key, value);
+
+        // compute the result of each request: inserts in batch order, then erases
+        V current = before;
+        for (int j=0;j<size;++j) {
+            request_t * const other = &requests[batch[j]];
+            if (other->op == ELIMINATION_OP_ERASE) continue;
+            other->result = current;
+            if (other->op == ELIMINATION_OP_INSERT || current == NO_VALUE) current = other->value;
+        }
+        for (int j=0;j<size;++j) {
+            request_t * const other = &requests[batch[j]];
+            if (other->op != ELIMINATION_OP_ERASE) continue;
+            other->result = current;
+            current = NO_VALUE;
+        }
+        __sync_synchronize();
+        for (int j=0;j<size;++j) {
+            request_t * const other = &requests[batch[j]];
+            other->state = other->state - STATUS_CLAIMED + STATUS_DONE;
+        }
+
+        if (size > 1) {
+            const bool updated = (op == ELIMINATION_OP_ERASE) ? (before != NO_VALUE)
+                               : (op == ELIMINATION_OP_INSERT) ? true
+                               : (before == NO_VALUE);
+            ++stats[tid].batches;
+            stats[tid].combined += size;
+            stats[tid].eliminated += size - (updated ? 1 : 0);
+        }
+    }
+
+public:
+    elimination_layer(const int _numProcesses, const V _NO_VALUE)
+            : numProcesses(_numProcesses)
+            , NO_VALUE(_NO_VALUE)
+            , requests(new request_t[_numProcesses])
+            , slots(new slot_t[ELIMINATION_SLOTS])
+            , stats(new stats_t[_numProcesses])
+            , batches(new int[_numProcesses*_numProcesses]) {
+        for (int i=0;i<numProcesses;++i) {
+            requests[i].state = STATUS_EMPTY;
+            stats[i].batches = 0;
+            stats[i].combined = 0;
+            stats[i].eliminated = 0;
+        }
+        for (int i=0;i<ELIMINATION_SLOTS;++i) {
+            slots[i].lock = 0;
+        }
+    }
+    ~elimination_layer() {
+        delete[] requests;
+        delete[] slots;
+        delete[] stats;
+        delete[] batches;
+    }
+
+    /**
+     * performs the operation op (one of the ELIMINATION_OP_* values) on key
+     * for thread tid, either by combining it with concurrent operations on
+     * the same key, or, eventually, by calling apply(op, key, value) itself.
+     * returns the value associated with key just before the operation took
+     * effect (or NO_VALUE if key was absent).
+     */
+    template <typename Apply>
+    V combine(const int tid, const int op, const K& key, const V& value, Apply& apply) {
+        request_t * const req = &requests[tid];
+        const long long seq = (req->state >> 2) + 1;
+        req->op = op;
+        req->key = key;
+        req->value = value;
+        __sync_synchronize();
+        req->state = (seq << 2) | STATUS_PENDING;
+        __sync_synchronize();
+
+        volatile int * const lock = &slots[slotOf(key)].lock;
+        for (int spins=0;;++spins) {
+            const long long state = req->state;
+            const int status = ELIMINATION_STATUS(state);
+            if (status == STATUS_DONE) {
+                __sync_synchronize();
+                return req->result;
+            }
+            if (status == STATUS_PENDING) {
+                if (*lock == 0 && __sync_bool_compare_and_swap(lock, 0, 1)) {
+                    if (req->state == state) runBatch(tid, key, apply);
+                    __sync_lock_release(lock);
+                    continue;
+                }
+                if (spins >= ELIMINATION_PATIENCE
+                        && __sync_bool_compare_and_swap(&req->state, state, (seq << 2) | STATUS_EMPTY)) {
+                    return apply(op, key, value);
+                }
+            } else if (spins >= ELIMINATION_PATIENCE) {
+                // claimed, so we must wait for the combiner to finish our batch
+                sched_yield();
+            }
+        }
+    }
+
+    long long getBatches() {
+        long long sum = 0;
+        for (int i=0;i<numProcesses;++i) sum += stats[i].batches;
+        return sum;
+    }
+    long long getCombined() {
+        long long sum = 0;
+        for (int i=0;i<numProcesses;++i) sum += stats[i].combined;
+        return sum;
+    }
+    long long getEliminated() {
+        long long sum = 0;
+        for (int i=0;i<numProcesses;++i) sum += stats[i].eliminated;
+        return sum;
+    }
+    void clearStats() {
+        for (int i=0;i<numProcesses;++i) {
+            stats[i].batches = 0;
+            stats[i].combined = 0;
+            stats[i].eliminated = 0;
+        }
+    }
+};
+
+#endif /* ELIMINATION_H */
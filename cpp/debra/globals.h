@@ -37,6 +37,26 @@ extern Random rngs[MAX_TID_POW2*PREFETCH_SIZE_WORDS];
 
 #define HAS_CPU_SETS
 
+// support for parking threads in the middle of an operation (see -stall in main.cpp).
+// the harness sets stallDeadlines[tid*PREFETCH_SIZE_WORDS] to a time (in
+// milliseconds, from chrono::steady_clock), and the next time thread tid
+// reaches a STALL_POINT, it sleeps until that time, while it is in a
+// non-quiescent state and has records protected.
+#include <chrono>
+#include <thread>
+static volatile long long stallDeadlines[MAX_TID_POW2*PREFETCH_SIZE_WORDS];
+inline long long stallClockMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+inline void stallUntilDeadline(const int tid) {
+    long long deadline;
+    while ((deadline = stallDeadlines[tid*PREFETCH_SIZE_WORDS]) && stallClockMillis() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stallDeadlines[tid*PREFETCH_SIZE_WORDS] = 0;
+}
+#define STALL_POINT(tid) if (stallDeadlines[(tid)*PREFETCH_SIZE_WORDS]) stallUntilDeadline((tid))
+
 // some useful options for the chromatic tree
 
 //#define NOREBALANCING
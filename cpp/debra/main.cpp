@@ -29,11 +29,14 @@
 #include <set>
 #include <chrono>
 #include <typeinfo>
+#include <type_traits>
 #include <pthread.h>
 #include <atomic>
 
 #include "random.h"
 #include "globals.h"
+#include "topology.h"
+#include "zipf.h"
 #include "recordmgr/record_manager.h"
 #include "chromatic.h"
 #include "bst.h"
@@ -52,6 +55,17 @@ int MAXKEY = 16384;
 int MILLIS_TO_RUN = -1;
 bool PREFILL = false;
 int NTHREADS = 1;
+int STALL_THREADS = 0;              // number of threads to park in the middle of operations
+int STALL_MILLIS = 100;             // how long each park lasts
+int STALL_PERIOD_MILLIS = 500;      // time between the starts of consecutive parks
+int SAMPLE_MILLIS = 0;              // how often to sample unreclaimed records and RSS (0 = never)
+string BINDING = "";                // logical processors to bind threads to, or a policy in topology.h
+double ZIPF = 0;                    // if nonzero, threads draw keys from a zipfian distribution with this parameter
+int SUCC = 0;                       // percentage of operations that are successor or predecessor queries (half each)
+#ifdef CHROMATIC_ORDER_STATISTICS
+int RANGE_COUNT = 0;                // percentage of operations that count the keys in a range
+int RANGE_COUNT_SIZE = 100;         // number of keys in the range of each range count
+#endif
 /* 
 char * RECLAIM_TYPE;
 char * ALLOC_TYPE;
@@ -64,11 +78,25 @@ bool start = false;
 bool done = false;
 atomic_int running; // number of threads that are running
 debugCounter * keysum; // key sum hashes for all threads (including for prefilling)
+Zipf * zipf = NULL;    // used by threadWork if ZIPF is nonzero
+atomic_llong orderViolations; // number of successor (predecessor) queries that returned a key < (>) their key
 
 chrono::time_point<chrono::high_resolution_clock> startTime;
 chrono::time_point<chrono::high_resolution_clock> endTime;
 long elapsedMillis;
 
+// statistics sampled by the main thread while the experiment runs
+long long samples = 0;
+long long stallsStarted = 0;
+long long peakUnreclaimed = 0;
+long long sumUnreclaimed = 0;
+long long peakRSSBytes = 0;
+long long sumRSSBytes = 0;
+long long opsWhileStalled = 0;
+long long millisWhileStalled = 0;
+long long opsWhileNotStalled = 0;
+long long millisWhileNotStalled = 0;
+
 const test_type NO_KEY = -1;
 const test_type NO_VALUE = -1;
 const int RETRY = -2;
@@ -76,6 +104,8 @@ const int RETRY = -2;
 // cpu sets for binding threads to cores
 #ifdef HAS_CPU_SETS
 cpu_set_t *cpusets[PHYSICAL_PROCESSORS];
+int bindings[PHYSICAL_PROCESSORS];  // thread tid is bound to logical processor bindings[tid%PHYSICAL_PROCESSORS]
+int cpusetSize = PHYSICAL_PROCESSORS;
 #endif
 
 template <class DataStructure>
@@ -126,6 +156,114 @@ void prefill(DataStructure * tree) {
     VERBOSE COUTATOMIC("finished prefilling to size "<<sz<<" for expected size "<<expectedSize<<endl);
 }
 
+#ifdef CHROMATIC_ORDER_STATISTICS
+// order statistics are only supported by the chromatic tree
+template <class DataStructure>
+long long countInRange(DataStructure * tree, const int tid, const test_type lo, const test_type hi) {
+    cout<<"ERROR: this data structure does not support range counts"<<endl;
+    exit(-1);
+}
+template <class K, class V, class Compare, class RecordMgr>
+long long countInRange(Chromatic<K,V,Compare,RecordMgr> * tree, const int tid, const test_type lo, const test_type hi) {
+    return tree->countInRange(tid, lo, hi);
+}
+
+template <class DataStructure>
+void validateOrderStatistics(DataStructure * tree) {}
+template <class K, class V, class Compare, class RecordMgr>
+void validateOrderStatistics(Chromatic<K,V,Compare,RecordMgr> * tree) {
+    const long long treeKeyCount = tree->debugKeyCount();
+    const long long rangeCount = tree->countInRange(0, 0, MAXKEY-1);
+#ifdef CHROMATIC_APPROX_COUNTS
+    // no update is in progress, so each count is off by at most bound
+    const long long bound = tree->approxCountErrorBound();
+    bool ok = (llabs(rangeCount - treeKeyCount) <= 2*bound);
+    for (long long i=0;ok && i<treeKeyCount;i+=1+treeKeyCount/1000) {
+        K key;
+        V value;
+        // (select can fail near the end if the counts are too large)
+        if (tree->select(0, i, &key, &value)) {
+            ok = (llabs(tree->rank(0, key) - i) <= 2*bound);
+        } else {
+            ok = (i >= treeKeyCount - bound);
+        }
+    }
+    const char * const prefix = "Approximate order statistics";
+    cout<<"Approximate order statistics error bound: "<<bound<<endl;
+#else
+    // no update is in progress, so the counts must be exact
+    bool ok = (rangeCount == treeKeyCount);
+    for (long long i=0;ok && i<treeKeyCount;i+=1+treeKeyCount/1000) {
+        K key;
+        V value;
+        ok = tree->select(0, i, &key, &value) && tree->rank(0, key) == i;
+    }
+    const char * const prefix = "Order statistics";
+#endif
+    if (ok) {
+        cout<<prefix<<" validation OK: rangeCount="<<rangeCount<<" treeKeyCount="<<treeKeyCount<<endl;
+    } else {
+        cout<<prefix<<" validation FAILURE: rangeCount="<<rangeCount<<" treeKeyCount="<<treeKeyCount<<endl;
+        exit(-1);
+    }
+}
+#endif
+
+// successor and predecessor queries are only supported by the chromatic tree
+template <class DataStructure>
+bool successorOrPredecessor(DataStructure * tree, const int tid, const bool isSuccessor, const test_type key, test_type * const resultKey) {
+    cout<<"ERROR: this data structure does not support successor and predecessor queries"<<endl;
+    exit(-1);
+}
+template <class K, class V, class Compare, class RecordMgr>
+bool successorOrPredecessor(Chromatic<K,V,Compare,RecordMgr> * tree, const int tid, const bool isSuccessor, const test_type key, test_type * const resultKey) {
+    V value;
+    return isSuccessor ? tree->successor(tid, key, resultKey, &value) : tree->predecessor(tid, key, resultKey, &value);
+}
+
+template <class DataStructure>
+void validateSuccessors(DataStructure * tree) {}
+template <class K, class V, class Compare, class RecordMgr>
+void validateSuccessors(Chromatic<K,V,Compare,RecordMgr> * tree) {
+    // no update is in progress, so walking all keys with successor (or
+    // predecessor) must visit them in order, and sum to the tree's key sum
+    const long long treeKeySum = tree->debugKeySum();
+    bool ordered = true;
+    K key;
+    V value;
+    long long successorSum = 0;
+    for (K from = 0; tree->successor(0, from, &key, &value); from = key+1) {
+        if (key < from) { ordered = false; break; }
+        successorSum += key;
+    }
+    long long predecessorSum = 0;
+    for (K from = MAXKEY; tree->predecessor(0, from, &key, &value); from = key-1) {
+        if (key > from) { ordered = false; break; }
+        predecessorSum += key;
+        if (key == 0) break;
+    }
+    const long long violations = orderViolations.load();
+    if (ordered && violations == 0 && successorSum == treeKeySum && predecessorSum == treeKeySum) {
+        cout<<"Successor/predecessor validation OK: successorSum="<<successorSum<<" predecessorSum="<<predecessorSum<<" treeKeySum="<<treeKeySum<<endl;
+    } else {
+        cout<<"Successor/predecessor validation FAILURE: successorSum="<<successorSum<<" predecessorSum="<<predecessorSum<<" treeKeySum="<<treeKeySum<<" inOrder="<<ordered<<" orderViolations="<<violations<<endl;
+        exit(-1);
+    }
+}
+
+#ifdef BST_ELIMINATION
+// the elimination layer is only used by the unbalanced bst
+template <class DataStructure>
+void printEliminationStats(DataStructure * tree) {}
+template <class K, class V, class Compare, class RecordMgr>
+void printEliminationStats(BST<K,V,Compare,RecordMgr> * tree) {
+    elimination_layer<K,V> * const elimination = tree->debugGetElimination();
+    COUTATOMIC("elimination batches           : "<<elimination->getBatches()<<endl);
+    COUTATOMIC("elimination combined ops      : "<<elimination->getCombined()<<endl);
+    COUTATOMIC("elimination eliminated ops    : "<<elimination->getEliminated()<<endl);
+}
+#endif
+
 template <class RecordMgr, class DataStructure>
 void *threadWork(void *arg) {
     const int OPS_BETWEEN_TIME_CHECKS = 500;
@@ -133,8 +271,8 @@ void *threadWork(void *arg) {
     int tid = info->tid;
     DataStructure * tree = info->tree;
 #ifdef HAS_CPU_SETS
-    sched_setaffinity(0, sizeof(cpusets[tid%PHYSICAL_PROCESSORS]), cpusets[tid%PHYSICAL_PROCESSORS]); // bind thread to core
-    VERBOSE COUTATOMICTID("binding to cpu "<<(tid%PHYSICAL_PROCESSORS)<<endl);
+    sched_setaffinity(0, CPU_ALLOC_SIZE(cpusetSize), cpusets[tid%PHYSICAL_PROCESSORS]); // bind thread to core
+    VERBOSE COUTATOMICTID("binding to cpu "<<bindings[tid%PHYSICAL_PROCESSORS]<<endl);
 #endif
     Random *rng = &rngs[tid*PREFETCH_SIZE_WORDS];
     tree->initThread(tid);
@@ -153,9 +291,11 @@ void *threadWork(void *arg) {
         }
         
         VERBOSE if (cnt&&((cnt % 1000000) == 0)) COUTATOMICTID("op# "<<cnt<<endl);
-        int key = rng->nextNatural(MAXKEY);
+        int key = (zipf ? zipf->next(*rng) : rng->nextNatural(MAXKEY));
         int op = rng->nextNatural(100);
-        if (op < INS) {
+        if (stallDeadlines[tid*PREFETCH_SIZE_WORDS]) {
+            tree->find(tid, key); // parks at the STALL_POINT in find
+        } else if (op < INS) {
             if (tree->insert(tid, key, key) == NO_VALUE) {
                 keysum->add(tid, key);
             }
@@ -163,6 +303,17 @@ void *threadWork(void *arg) {
             if (tree->erase(tid, key).second) {
                 keysum->add(tid, -key);
             }
+        } else if (op < INS+DEL+SUCC) {
+            const bool isSuccessor = (op < INS+DEL+SUCC/2);
+            test_type resultKey;
+            if (successorOrPredecessor(tree, tid, isSuccessor, key, &resultKey)
+                    && (isSuccessor ? resultKey < key : resultKey > key)) {
+                orderViolations.fetch_add(1);
+            }
+#ifdef CHROMATIC_ORDER_STATISTICS
+        } else if (op < INS+DEL+SUCC+RANGE_COUNT) {
+            countInRange(tree, tid, key, key+RANGE_COUNT_SIZE-1);
+#endif
         } else {
             tree->find(tid, key);
         }
@@ -172,6 +323,64 @@ void *threadWork(void *arg) {
     return NULL;
 }
 
+long long getRSSBytes() {
+    long long sizePages = 0, rssPages = 0;
+    ifstream statm("/proc/self/statm");
+    if (!(statm>>sizePages>>rssPages)) return 0;
+    return rssPages * sysconf(_SC_PAGESIZE);
+}
+
+// run by the main thread until the experiment is done.
+// every SAMPLE_MILLIS, samples the number of unreclaimed records, RSS and
+// throughput, and every STALL_PERIOD_MILLIS, parks threads 0..STALL_THREADS-1
+// for STALL_MILLIS in the middle of a search.
+template <class RecordMgr, class DataStructure>
+void sampleUntilDone(DataStructure * tree) {
+    RecordMgr * const recordmgr = tree->debugGetRecordMgr();
+    debugCounters * const counters = tree->debugGetCounters();
+    long long lastTime = stallClockMillis();
+    long long lastOps = 0;
+    long long nextStall = lastTime + STALL_PERIOD_MILLIS;
+    long long stallEnd = 0;
+    while (!done) {
+        this_thread::sleep_for(chrono::milliseconds(SAMPLE_MILLIS));
+        const long long now = stallClockMillis();
+        
+        // attribute the operations completed since the last sample
+        const long long ops = counters->insertSuccess->getTotal() + counters->eraseSuccess->getTotal() + counters->findSuccess->getTotal();
+        if (lastTime < stallEnd) {
+            opsWhileStalled += ops - lastOps;
+            millisWhileStalled += now - lastTime;
+        } else {
+            opsWhileNotStalled += ops - lastOps;
+            millisWhileNotStalled += now - lastTime;
+        }
+        lastOps = ops;
+        lastTime = now;
+        
+        if (STALL_THREADS > 0 && now >= nextStall) {
+            stallEnd = now + STALL_MILLIS;
+            for (int tid=0;tid<STALL_THREADS;++tid) {
+                stallDeadlines[tid*PREFETCH_SIZE_WORDS] = stallEnd;
+            }
+            nextStall = now + STALL_PERIOD_MILLIS;
+            ++stallsStarted;
+        }
+        
+        const long long unreclaimed = recordmgr->getApproxSizeInNodes();
+        const long long rss = getRSSBytes();
+        if (unreclaimed > peakUnreclaimed) peakUnreclaimed = unreclaimed;
+        if (rss > peakRSSBytes) peakRSSBytes = rss;
+        sumUnreclaimed += unreclaimed;
+        sumRSSBytes += rss;
+        ++samples;
+    }
+    // release any threads that are still parked
+    for (int tid=0;tid<STALL_THREADS;++tid) {
+        stallDeadlines[tid*PREFETCH_SIZE_WORDS] = 0;
+    }
+}
+
 template <class RecordMgr, class DataStructure>
 void performExperiment(DataStructure * tree) {
     // get random number generator seeded with time
@@ -203,6 +412,7 @@ void performExperiment(DataStructure * tree) {
     startTime = chrono::high_resolution_clock::now();
     __sync_synchronize();
     start = true;
+    if (SAMPLE_MILLIS > 0) sampleUntilDone<RecordMgr, DataStructure>(tree);
     for (int i=0;i<NTHREADS;++i) {
         VERBOSE COUTATOMIC("main thread: attempting to join thread "<<i<<endl);
         if (pthread_join(*threads[i], NULL)) {
@@ -252,6 +462,10 @@ void printOutput(DataStructure * tree) {
         cout<<"Validation FAILURE: threadsKeySum = "<<threadsKeySum<<" treeKeySum="<<treeKeySum<<endl;
         exit(-1);
     }
+    validateSuccessors(tree);
+#ifdef CHROMATIC_ORDER_STATISTICS
+    validateOrderStatistics(tree);
+#endif
 
     debugCounters * const counters = tree->debugGetCounters();
     COUTATOMIC("total llx true                : "<<counters->llxSuccess->getTotal()<<endl);
@@ -262,6 +476,9 @@ void printOutput(DataStructure * tree) {
     COUTATOMIC("total erase retry             : "<<counters->eraseFail->getTotal()<<endl);
     COUTATOMIC("total find succ               : "<<counters->findSuccess->getTotal()<<endl);
     COUTATOMIC("total find retry              : "<<counters->findFail->getTotal()<<endl);
+#ifdef BST_ELIMINATION
+    printEliminationStats(tree);
+#endif
     const long totalSucc = counters->insertSuccess->getTotal()+counters->eraseSuccess->getTotal()+counters->findSuccess->getTotal();
     const long throughput = (long) (totalSucc / (elapsedMillis/1000.));
     COUTATOMIC("total succ insert+erase+find  : "<<totalSucc<<endl);
@@ -269,8 +486,30 @@ void printOutput(DataStructure * tree) {
     COUTATOMIC("elapsed milliseconds          : "<<elapsedMillis<<endl);
     COUTATOMIC(endl);
 
+    if (SAMPLE_MILLIS > 0) {
+        COUTATOMIC("stalled threads               : "<<STALL_THREADS<<endl);
+        COUTATOMIC("stalls                        : "<<stallsStarted<<" ("<<STALL_MILLIS<<"ms every "<<STALL_PERIOD_MILLIS<<"ms)"<<endl);
+        COUTATOMIC("samples                       : "<<samples<<" (every "<<SAMPLE_MILLIS<<"ms)"<<endl);
+        COUTATOMIC("peak unreclaimed records      : "<<peakUnreclaimed<<endl);
+        COUTATOMIC("avg unreclaimed records       : "<<(samples ? sumUnreclaimed / samples : 0)<<endl);
+        COUTATOMIC("peak rss bytes                : "<<peakRSSBytes<<endl);
+        COUTATOMIC("avg rss bytes                 : "<<(samples ? sumRSSBytes / samples : 0)<<endl);
+        COUTATOMIC("throughput while stalled      : "<<(millisWhileStalled ? opsWhileStalled * 1000 / millisWhileStalled : 0)<<endl);
+        COUTATOMIC("throughput while not stalled  : "<<(millisWhileNotStalled ? opsWhileNotStalled * 1000 / millisWhileNotStalled : 0)<<endl);
+        COUTATOMIC(endl);
+    }
+
     COUTATOMIC("neutralize signal receipts    : "<<countInterrupted.getTotal()<<endl);
     COUTATOMIC("siglongjmp count              : "<<countLongjmp.getTotal()<<endl);
+    long long maxNeutralizeLatency = 0;
+    for (int tid=0;tid<MAX_TID_POW2;++tid) {
+        maxNeutralizeLatency = max(maxNeutralizeLatency, neutralizeLatencyMaxNanos.get(tid));
+    }
+    const long long neutralizeRestarts = countNeutralizeRestarts.getTotal();
+    COUTATOMIC("neutralizations               : "<<countNeutralized.getTotal()<<endl);
+    COUTATOMIC("restarts after neutralizing   : "<<neutralizeRestarts<<endl);
+    COUTATOMIC("avg neutralize latency ns     : "<<(neutralizeRestarts ? neutralizeLatencyNanos.getTotal() / neutralizeRestarts : 0)<<endl);
+    COUTATOMIC("max neutralize latency ns     : "<<maxNeutralizeLatency<<endl);
     COUTATOMIC(endl);
     
     // free tree
@@ -318,6 +557,14 @@ void bootstrapExperiment() {
         exit(1);
     }
 */
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+    // a neutralized thread may read reclaimed records until its next
+    // checkpoint, so they must not be returned to the OS (see README.txt)
+    static_assert(!std::is_same<POOL_TYPE<>, pool_none<> >::value
+                    || std::is_same<Alloc, allocator_once<> >::value
+                    || std::is_same<Alloc, allocator_bump<> >::value,
+            "checkpoint neutralization needs a pool, or allocator_once or allocator_bump");
+#endif
     bootstrapExperiment<Reclaim, Alloc, POOL_TYPE<> >();
 }
 
@@ -331,6 +578,8 @@ void bootstrapExperiment() {
         bootstrapExperiment<Reclaim, allocator_bump<> >();
     } else if (strcmp(ALLOC_TYPE, "new") == 0) {
         bootstrapExperiment<Reclaim, allocator_new<> >();
+    } else if (strcmp(ALLOC_TYPE, "slab") == 0) {
+        bootstrapExperiment<Reclaim, allocator_slab<> >();
     } else {
         cout<<"bad allocator type"<<endl;
         exit(1);
@@ -350,6 +599,8 @@ void bootstrapExperiment() {
         bootstrapExperiment<reclaimer_debraplus<> >();
     } else if (strcmp(RECLAIM_TYPE, "hazardptr") == 0) {
         bootstrapExperiment<reclaimer_hazardptr<> >();
+    } else if (strcmp(RECLAIM_TYPE, "ibr") == 0) {
+        bootstrapExperiment<reclaimer_ibr<> >();
     } else {
         cout<<"bad reclaimer type"<<endl;
         exit(1);
@@ -363,15 +614,6 @@ void bootstrapExperiment() {
 #define PRINT(a) {cout<<(#a)<<"="<<(a)<<endl;}
 
 int main(int argc, char** argv) {
-#ifdef HAS_CPU_SETS
-    // create cpu sets for binding threads to cores
-    int size = CPU_ALLOC_SIZE(PHYSICAL_PROCESSORS);
-    for (int i=0;i<PHYSICAL_PROCESSORS;++i) {
-        cpusets[i] = CPU_ALLOC(PHYSICAL_PROCESSORS);
-        CPU_ZERO_S(size, cpusets[i]);
-        CPU_SET_S(i, size, cpusets[i]);
-    }
-#endif
     // read command-line arguments
     for (int i=1;i<argc;++i) {
         if (strcmp(argv[i], "-i") == 0) {
@@ -396,6 +638,26 @@ int main(int argc, char** argv) {
             MILLIS_TO_RUN = atoi(argv[++i]);
         } else if (strcmp(argv[i], "-p") == 0) {
             PREFILL = true;
+        } else if (strcmp(argv[i], "-stall") == 0) {
+            STALL_THREADS = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-stallms") == 0) {
+            STALL_MILLIS = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-stallperiod") == 0) {
+            STALL_PERIOD_MILLIS = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-sample") == 0) {
+            SAMPLE_MILLIS = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-zipf") == 0) {
+            ZIPF = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-bind") == 0) {
+            BINDING = argv[++i];
+        } else if (strcmp(argv[i], "-succ") == 0) {
+            SUCC = atoi(argv[++i]);
+#ifdef CHROMATIC_ORDER_STATISTICS
+        } else if (strcmp(argv[i], "-rc") == 0) {
+            RANGE_COUNT = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-rcsize") == 0) {
+            RANGE_COUNT_SIZE = atoi(argv[++i]);
+#endif
         } else {
             cout<<"bad arguments"<<endl;
             exit(1);
@@ -408,6 +670,46 @@ int main(int argc, char** argv) {
     PRINT(NTHREADS);
     PRINT(MILLIS_TO_RUN);
     PRINT(PREFILL);
+    if (STALL_THREADS > 0 && SAMPLE_MILLIS <= 0) SAMPLE_MILLIS = 5;
+    if (STALL_THREADS >= NTHREADS) {
+        cout<<"-stall must be smaller than -n"<<endl;
+        exit(1);
+    }
+    PRINT(STALL_THREADS);
+    PRINT(STALL_MILLIS);
+    PRINT(STALL_PERIOD_MILLIS);
+    PRINT(SAMPLE_MILLIS);
+    if (ZIPF < 0 || ZIPF >= 1) {
+        cout<<"-zipf must be in [0, 1)"<<endl;
+        exit(1);
+    }
+    PRINT(ZIPF);
+    PRINT(SUCC);
+#ifdef CHROMATIC_ORDER_STATISTICS
+    PRINT(RANGE_COUNT);
+    PRINT(RANGE_COUNT_SIZE);
+#endif
+#ifdef HAS_CPU_SETS
+    // create cpu sets for binding threads to cores
+    // (by default, thread tid is bound to logical processor tid%PHYSICAL_PROCESSORS)
+    vector<int> cpus = topology_isPolicy(BINDING) ? topology_getBinding(BINDING) : topology_parseCpuList(BINDING);
+    for (int i=0;i<PHYSICAL_PROCESSORS;++i) {
+        bindings[i] = cpus.empty() ? i : cpus[i%cpus.size()];
+        cpusetSize = max(cpusetSize, bindings[i]+1);
+    }
+    int size = CPU_ALLOC_SIZE(cpusetSize);
+    for (int i=0;i<PHYSICAL_PROCESSORS;++i) {
+        cpusets[i] = CPU_ALLOC(cpusetSize);
+        CPU_ZERO_S(size, cpusets[i]);
+        CPU_SET_S(bindings[i], size, cpusets[i]);
+    }
+    PRINT(BINDING);
+    cout<<"THREAD_BINDING=";
+    for (int i=0;i<NTHREADS;++i) {
+        cout<<(i?",":"")<<bindings[i%PHYSICAL_PROCESSORS];
+    }
+    cout<<endl;
+#endif
     PRINT(STR(RECLAIM_TYPE));
     PRINT(STR(ALLOC_TYPE));
     PRINT(STR(POOL_TYPE));
@@ -415,7 +717,9 @@ int main(int argc, char** argv) {
     
     // run the experiment
     keysum = new debugCounter(NTHREADS);
+    if (ZIPF > 0) zipf = new Zipf(MAXKEY, ZIPF);
     bootstrapExperiment();
+    if (zipf) delete zipf;
     delete keysum;
     return 0;
 }
@@ -25,6 +25,7 @@
 #include <iomanip>
 #include <atomic>
 #include <set>
+#include <stdint.h>
 #include "scxrecord.h"
 using namespace std;
 
@@ -38,6 +39,12 @@ public:
     atomic_bool marked; // might be able to combine this elegantly with scx record pointer... (maybe we can piggyback on the version number mechanism, using the same bit to indicate ver# OR marked)
     atomic_uintptr_t left;
     atomic_uintptr_t right;
+#ifdef CHROMATIC_ORDER_STATISTICS
+    // used only by the chromatic tree: the number of keys in this node's
+    // subtree (low 32 bits), and a version number that is incremented whenever
+    // the count is changed (high 32 bits). see chromatic_impl.h.
+    atomic<uint64_t> count;
+#endif
 
     Node() {
         // left blank for efficiency with custom allocator
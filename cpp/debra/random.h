@@ -25,6 +25,14 @@ public:
         return (retval < 0 ? -retval : retval);
     }
 
+    /** returns pseudorandom x satisfying 0 <= x < 1. **/
+    double nextDouble() {
+        seed ^= seed << 6;
+        seed ^= seed >> 21;
+        seed ^= seed << 7;
+        return seed / 4294967296.;
+    }
+
 };
 
 #endif	/* RANDOM_H */
@@ -0,0 +1,66 @@
+/*
+ * File:   asymmetric_fence.h
+ *
+ * Asymmetric memory fences, which let reclaimers move the cost of a memory
+ * fence from readers (which execute it frequently) to the reclaiming thread
+ * (which executes it rarely).
+ */
+
+#ifndef ASYMMETRIC_FENCE_H
+#define	ASYMMETRIC_FENCE_H
+
+#include "globals.h"
+
+// a light fence on one side, paired with a heavy fence on the other side,
+// acts like a full memory fence on both sides.
+//
+// if USE_MEMBARRIER is defined, and the kernel supports
+// membarrier(MEMBARRIER_CMD_PRIVATE_EXPEDITED) (Linux 4.14+),
+// the light fence only prevents compiler reordering, and the heavy fence is a
+// membarrier system call, which executes a full memory fence on every CPU that
+// is running a thread of this process. otherwise, both are full fences.
+
+#ifdef USE_MEMBARRIER
+    #include <unistd.h>
+    #include <sys/syscall.h>
+    #include <linux/membarrier.h>
+
+    // set by asymmetric_fence_init if membarrier can be used
+    // (a function-local static, so every translation unit shares one flag)
+    inline volatile bool& asymmetricFenceFlag() {
+        static volatile bool enabled = false;
+        return enabled;
+    }
+
+    // register this process for expedited private membarriers.
+    // returns true if membarrier will be used.
+    inline bool asymmetric_fence_init() {
+        if (asymmetricFenceFlag()) return true;
+        long cmds = syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0);
+        if (cmds < 0 || !(cmds & MEMBARRIER_CMD_PRIVATE_EXPEDITED)) return false;
+        if (syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) != 0) return false;
+        asymmetricFenceFlag() = true;
+        __sync_synchronize();
+        return true;
+    }
+    inline void asymmetric_fence_light() {
+        if (asymmetricFenceFlag()) {
+            SOFTWARE_BARRIER;
+        } else {
+            __sync_synchronize();
+        }
+    }
+    inline void asymmetric_fence_heavy() {
+        if (asymmetricFenceFlag()) {
+            syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+        } else {
+            __sync_synchronize();
+        }
+    }
+#else
+    inline bool asymmetric_fence_init() { return false; }
+    inline void asymmetric_fence_light() { __sync_synchronize(); }
+    inline void asymmetric_fence_heavy() { __sync_synchronize(); }
+#endif
+
+#endif	/* ASYMMETRIC_FENCE_H */
@@ -36,11 +36,15 @@
 #endif
 
 // don't touch these options for crash recovery
+// (except CRASH_RECOVERY_USING_CHECKPOINTS, which can be defined on the
+//  command line to neutralize threads without signals; see recovery_manager.h)
 
+#ifndef CRASH_RECOVERY_USING_CHECKPOINTS
 #define CRASH_RECOVERY_USING_SETJMP
 #define SEND_CRASH_RECOVERY_SIGNALS
 #define AFTER_NEUTRALIZING_SET_BIT_AND_RETURN_TRUE
 #define PERFORM_RESTART_IN_SIGHANDLER
+#endif
 #define SIGHANDLER_IDENTIFY_USING_PTHREAD_GETSPECIFIC
 
 // some useful, data structure agnostic definitions
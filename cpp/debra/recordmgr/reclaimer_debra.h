@@ -79,6 +79,16 @@ public:
         ss<<getSizeInNodes()<<" in epoch bags";
         return ss.str();
     }
+    // counts only full blocks, since the owner may be modifying the others
+    long long getApproxSizeInNodes() {
+        long long sum = 0;
+        for (int tid=0;tid<this->NUM_PROCESSES;++tid) {
+            for (int j=0;j<NUMBER_OF_EPOCH_BAGS;++j) {
+                sum += (epochbags[NUMBER_OF_EPOCH_BAGS*tid+j]->getSizeInBlocks() - 1) * (long long) BLOCK_SIZE;
+            }
+        }
+        return sum;
+    }
     
     inline static bool quiescenceIsPerRecordType() { return false; }
     
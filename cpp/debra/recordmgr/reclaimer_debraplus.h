@@ -108,6 +108,7 @@ private:
             int error = 0;
 //                COUTATOMICTID("sending signal to tid "<<otherTid<<endl);
 
+            recordNeutralizing(otherTid);
             if (error = pthread_kill(otherPthread, this->recoveryMgr->neutralizeSignal)) {
                 // should never happen
                 for (int i=0;i<20;++i) COUTATOMICTID("######################################################"<<endl);
@@ -120,6 +121,7 @@ private:
                 if (QUIESCENT(newann)) return true;
                 return false;
             } else {
+                countNeutralized.inc(tid);
 #ifdef AFTER_NEUTRALIZING_WAIT_FOR_QUIESCENCE
                 // debug technique: wait until otherTid is
                 // either quiescent or has updated its announced epoch.
@@ -139,6 +141,23 @@ private:
             }
         }
         assert(isQuiescent(tid));
+#elif defined CRASH_RECOVERY_USING_CHECKPOINTS
+        assert(otherTid != tid);
+        // if the epoch bag is too full, then we suspect otherTid has crashed...
+        if (epochbags[NUMBER_OF_EPOCH_BAGS_CR*tid+index[tid*PREFETCH_SIZE_WORDS]]->getSizeInBlocks() >= NEUTRALIZE_THRESHOLD_IN_BLOCKS) {
+            // neutralize otherTid by changing its announced epoch to a quiescent
+            // state. otherTid will notice at its next checkpoint, throw away all
+            // pointers into the data structure, and leaveQstate again before
+            // re-acquiring any pointers into the data structure.
+            // (the CAS fails if otherTid announced a new epoch or became quiescent.)
+            recordNeutralizing(otherTid);
+            long exp = announceOther;
+            if (announcedEpoch[otherTid*PREFETCH_SIZE_WORDS].compare_exchange_strong(exp, GET_WITH_QUIESCENT(announceOther))) {
+                countNeutralized.inc(tid);
+                return true;
+            }
+            return QUIESCENT(exp) || BITS_EPOCH(exp) == currentEpoch;
+        }
 #endif
         return false;
     }
@@ -154,6 +173,17 @@ public:
         typedef reclaimer_debraplus<_Tp1, _Tp2> other;
     };
     
+    // counts only full blocks, since the owner may be modifying the others
+    long long getApproxSizeInNodes() {
+        long long sum = 0;
+        for (int tid=0;tid<this->NUM_PROCESSES;++tid) {
+            for (int j=0;j<NUMBER_OF_EPOCH_BAGS_CR;++j) {
+                sum += (epochbags[NUMBER_OF_EPOCH_BAGS_CR*tid+j]->getSizeInBlocks() - 1) * (long long) BLOCK_SIZE;
+            }
+        }
+        return sum;
+    }
+    
     inline static bool quiescenceIsPerRecordType() { return false; }
     inline static bool supportsCrashRecovery() { return true; }
     inline bool isQuiescent(const int tid) {
@@ -200,7 +230,9 @@ public:
     }
     inline void qUnprotectAll(const int tid) {
         TRACE COUTATOMICTID("reclaimer_debraplus::unprotectAllObjectsEvenIfQuiescent(tid="<<tid<<")"<<endl);
-        assert(isQuiescent(tid));
+#ifndef CRASH_RECOVERY_USING_CHECKPOINTS
+        assert(isQuiescent(tid)); // (with checkpoints, helpers also use qProtect)
+#endif
         announce[tid]->clear();
         assert(announce[tid]->size() == 0);
     }
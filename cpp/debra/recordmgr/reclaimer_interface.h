@@ -49,6 +49,10 @@ public:
     
     long long getSizeInNodes() { return 0; }
     string getSizeString() { return ""; }
+    // approximate number of retired records that have not been reclaimed.
+    // unlike getSizeInNodes, this is safe to call while other threads are
+    // retiring records, so it can be sampled during an experiment.
+    long long getApproxSizeInNodes() { return 0; }
 
     inline static bool quiescenceIsPerRecordType() { return true; }
     inline static bool shouldHelp() { return true; } // FOR DEBUGGING PURPOSES
@@ -93,4 +97,15 @@ public:
     }
 };
 
+// the type of object the record manager actually stores for records of type
+// Record when reclaimer Reclaim is used. reclaimers that need to store
+// information in each record (such as reclaimer_ibr) specialize this
+// to a subclass of Record. allocated() is invoked on every allocation.
+template <class Reclaim, typename Record>
+struct reclaimer_record_type {
+    typedef Record type;
+    template <class ClassReclaim>
+    inline static void allocated(ClassReclaim * const reclaim, const int tid, type * const p) {}
+};
+
 #endif
@@ -43,6 +43,7 @@ public:
     };
     
     string getSizeString() { return "no reclaimer"; }
+    long long getApproxSizeInNodes() { return 0; }
     inline static bool shouldHelp() {
         return true;
     }
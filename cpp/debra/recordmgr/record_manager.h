@@ -74,6 +74,7 @@ public:
     void clearCounters(void) {}
     void registerThread(const int tid) {}
     void printStatus() {}
+    long long getApproxSizeInNodes() { return 0; }
     inline void qUnprotectAll(const int tid) {}
     inline void getReclaimers(const int tid, void ** const reclaimers, int index) {}
     inline void enterQuiescentState(const int tid) {}
@@ -121,6 +122,10 @@ public:
         mgr->printStatus();
         ((RecordManagerSet<Reclaim, Alloc, Pool, Rest...> *) this)->printStatus();
     }
+    long long getApproxSizeInNodes() {
+        return mgr->reclaim->getApproxSizeInNodes()
+                + ((RecordManagerSet<Reclaim, Alloc, Pool, Rest...> *) this)->getApproxSizeInNodes();
+    }
     inline void qUnprotectAll(const int tid) {
         mgr->qUnprotectAll(tid);
         ((RecordManagerSet<Reclaim, Alloc, Pool, Rest...> *) this)->qUnprotectAll(tid);
@@ -180,6 +185,11 @@ public:
     void printStatus(void) {
         rmset->printStatus();
     }
+    // approximate number of records (of all types) that have been retired
+    // but not reclaimed. safe to call while other threads are running.
+    long long getApproxSizeInNodes() {
+        return rmset->getApproxSizeInNodes();
+    }
     template <typename T>
     debugInfo * getDebugInfo(T * const recordType) {
         return &rmset->get((T *) NULL)->debugInfoRecord;
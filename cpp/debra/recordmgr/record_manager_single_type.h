@@ -39,6 +39,7 @@
 #include "allocator_bump.h"
 #include "allocator_new.h"
 #include "allocator_once.h"
+#include "allocator_slab.h"
 
 #include "pool_interface.h"
 #include "pool_none.h"
@@ -49,6 +50,7 @@
 #include "reclaimer_debra.h"
 #include "reclaimer_debraplus.h"
 #include "reclaimer_hazardptr.h"
+#include "reclaimer_ibr.h"
 #include "recovery_manager.h"
 
 using namespace std;
@@ -59,9 +61,15 @@ class record_manager_single_type {
 protected:
     typedef Record* record_pointer;
 
-    typedef typename Alloc::template    rebind<Record>::other              classAlloc;
-    typedef typename Pool::template     rebind2<Record, classAlloc>::other classPool;
-    typedef typename Reclaim::template  rebind2<Record, classPool>::other  classReclaim;
+    // some reclaimers store extra information in each record,
+    // so the allocator, pool and reclaimer all operate on StoredRecord objects.
+    typedef reclaimer_record_type<Reclaim, Record>                              recordType;
+    typedef typename recordType::type                                           StoredRecord;
+    typedef StoredRecord* stored_record_pointer;
+
+    typedef typename Alloc::template    rebind<StoredRecord>::other              classAlloc;
+    typedef typename Pool::template     rebind2<StoredRecord, classAlloc>::other classPool;
+    typedef typename Reclaim::template  rebind2<StoredRecord, classPool>::other  classReclaim;
     
 public:
     classAlloc      *alloc;
@@ -99,25 +107,25 @@ public:
         return Reclaim::shouldHelp();
     }
     inline bool isProtected(const int tid, record_pointer obj) {
-        return reclaim->isProtected(tid, obj);
+        return reclaim->isProtected(tid, (stored_record_pointer) obj);
     }
     // for hazard pointers (and reference counting)
     inline bool protect(const int tid, record_pointer obj, CallbackType notRetiredCallback, CallbackArg callbackArg, bool hintMemoryBarrier = true) {
-        return reclaim->protect(tid, obj, notRetiredCallback, callbackArg, hintMemoryBarrier);
+        return reclaim->protect(tid, (stored_record_pointer) obj, notRetiredCallback, callbackArg, hintMemoryBarrier);
     }
     inline void unprotect(const int tid, record_pointer obj) {
-        reclaim->unprotect(tid, obj);
+        reclaim->unprotect(tid, (stored_record_pointer) obj);
     }
     // warning: qProtect must be reentrant and lock-free (=== async-signal-safe)
     inline bool qProtect(const int tid, record_pointer obj, CallbackType notRetiredCallback, CallbackArg callbackArg, bool hintMemoryBarrier = true) {
-        return reclaim->qProtect(tid, obj, notRetiredCallback, callbackArg, hintMemoryBarrier);
+        return reclaim->qProtect(tid, (stored_record_pointer) obj, notRetiredCallback, callbackArg, hintMemoryBarrier);
     }
     inline void qUnprotectAll(const int tid) {
         assert(!Reclaim::supportsCrashRecovery() || isQuiescent(tid));
         reclaim->qUnprotectAll(tid);
     }
     inline bool isQProtected(const int tid, record_pointer obj) {
-        return reclaim->isQProtected(tid, obj);
+        return reclaim->isQProtected(tid, (stored_record_pointer) obj);
     }
     
     inline static bool supportsCrashRecovery() {
@@ -143,17 +151,19 @@ public:
     // for all schemes except reference counting
     inline void retire(const int tid, record_pointer p) {
         assert(!Reclaim::supportsCrashRecovery() || isQuiescent(tid));
-        reclaim->retire(tid, p);
+        reclaim->retire(tid, (stored_record_pointer) p);
     }
 
     // for all schemes
     inline record_pointer allocate(const int tid) {
         assert(!Reclaim::supportsCrashRecovery() || isQuiescent(tid));
-        return pool->get(tid);
+        stored_record_pointer p = pool->get(tid);
+        recordType::allocated(reclaim, tid, p);
+        return p;
     }
     inline void deallocate(const int tid, record_pointer p) {
         assert(!Reclaim::supportsCrashRecovery() || isQuiescent(tid));
-        pool->add(tid, p);
+        pool->add(tid, (stored_record_pointer) p);
     }
 
     void printStatus(void) {
@@ -167,6 +177,10 @@ public:
         COUTATOMIC("deallocated : "<<deallocated<<" objects"<<endl);
         COUTATOMIC("pool        : "<<pool->getSizeString()<<endl);
         COUTATOMIC("reclaim     : "<<reclaim->getSizeString()<<endl);
+
+        for (int tid=0;tid<NUM_PROCESSES;++tid) {
+            reclaim->debugPrintStatus(tid);
+        }
         COUTATOMIC(endl);
         
 //        for (int tid=0;tid<this->NUM_PROCESSES;++tid) {
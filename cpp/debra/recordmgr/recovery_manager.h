@@ -9,6 +9,18 @@
  * It will just slow a thread down by neutralizing it (if it is in a 
  * non-quiescent state).
  *
+ * Alternatively, if CRASH_RECOVERY_USING_CHECKPOINTS is defined, no signals
+ * are used. A thread neutralizes another by using CAS to change the other
+ * thread's announced epoch to a quiescent state. The neutralized thread
+ * notices at its next checkpoint (see NEUTRALIZED below), where it discards
+ * its pointers into the data structure and restarts its operation.
+ * Until then, it may read records that have been reclaimed, so the data
+ * structure must check NEUTRALIZED after reading a pointer and before
+ * following it, before returning a result computed from such reads, and
+ * before writing to a record that it has not protected with qProtect.
+ * Reclaimed records must remain readable (true for pools, and for
+ * allocators that never return memory to the OS).
+ *
  * WARNING: this implementation of neutralizing only works for a SINGLE instance
  *       of record_manager, which must be globally available in a signal handler.
  *       There are simple ways to modify it to work with multiple record_manager
@@ -40,6 +52,7 @@
 #include <cassert>
 #include <csignal>
 #include <setjmp.h>
+#include <chrono>
 #include "globals.h"
 #include "debugcounter.h"
 
@@ -64,6 +77,36 @@ static debugCounter countLongjmp(MAX_TID_POW2);
 //extern debugCounter countLongjmp;
 #define MAX_THREAD_ADDR 10000
 
+// statistics for neutralizing (with signals or with checkpoints)
+static debugCounter countNeutralized(MAX_TID_POW2);         // threads neutralized by thread tid
+static debugCounter countNeutralizeRestarts(MAX_TID_POW2);  // restarts of thread tid after it was neutralized
+static debugCounter neutralizeLatencyNanos(MAX_TID_POW2);   // total time from neutralizing thread tid until it restarted
+static debugCounter neutralizeLatencyMaxNanos(MAX_TID_POW2);
+static volatile long long neutralizeTimes[MAX_TID_POW2*PREFETCH_SIZE_WORDS];
+
+inline long long neutralizeClockNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+// called just before a thread tries to neutralize otherTid
+inline void recordNeutralizing(const int otherTid) {
+    neutralizeTimes[otherTid*PREFETCH_SIZE_WORDS] = neutralizeClockNanos();
+}
+// called by thread tid when it restarts because it was neutralized
+// (async-signal-safe). a thread may notice that it was neutralized at several
+// checkpoints before it restarts, so only the first restart after
+// recordNeutralizing(tid) (which takes the time it recorded) is counted.
+inline void recordNeutralizeRestart(const int tid) {
+    volatile long long * const time = &neutralizeTimes[tid*PREFETCH_SIZE_WORDS];
+    const long long start = *time;
+    if (start == 0 || !__sync_bool_compare_and_swap(time, start, 0)) return;
+    countNeutralizeRestarts.inc(tid);
+    const long long latency = neutralizeClockNanos() - start;
+    neutralizeLatencyNanos.add(tid, latency);
+    if (latency > neutralizeLatencyMaxNanos.get(tid)) {
+        neutralizeLatencyMaxNanos.add(tid, latency - neutralizeLatencyMaxNanos.get(tid));
+    }
+}
+
 #ifdef CRASH_RECOVERY_USING_SETJMP
 #define CHECKPOINT_AND_RUN_UPDATE(tid, finishedbool) \
     if (MasterRecordMgr::supportsCrashRecovery() && sigsetjmp(setjmpbuffers[(tid)], 0)) { \
@@ -76,6 +119,28 @@ static debugCounter countLongjmp(MAX_TID_POW2);
         recordmgr->enterQuiescentState((tid)); \
         recordmgr->recoveryMgr->unblockCrashRecoverySignal(); \
     } else
+#define NEUTRALIZED(tid) false
+#endif
+
+#ifdef CRASH_RECOVERY_USING_CHECKPOINTS
+// operations simply return failure (and are retried) when NEUTRALIZED is true.
+// an scx only checks NEUTRALIZED before it starts helping itself, and, once it
+// has started, only writes to records it has protected with qProtect,
+// so there is never an scx to recover.
+#define CHECKPOINT_AND_RUN_UPDATE(tid, finishedbool)
+#define CHECKPOINT_AND_RUN_QUERY(tid)
+#define NEUTRALIZED(tid) checkNeutralized(recordmgr, (tid))
+
+// returns true if thread tid, which is in a non-quiescent state as far as it
+// knows, has been neutralized (i.e., forced into a quiescent state).
+// if so, thread tid must not follow any pointer it has read since its last
+// checkpoint, and must restart its operation.
+template <class MasterRecordMgr>
+inline bool checkNeutralized(MasterRecordMgr * const recordmgr, const int tid) {
+    if (!MasterRecordMgr::supportsCrashRecovery() || !recordmgr->isQuiescent(tid)) return false;
+    recordNeutralizeRestart(tid);
+    return true;
+}
 #endif
 
 template <class MasterRecordMgr>
@@ -94,6 +159,7 @@ void crashhandler(int signum, siginfo_t *info, void *uctx) {
 #ifdef PERFORM_RESTART_IN_SIGHANDLER
         recordmgr->enterQuiescentState(tid);
         DEBUG countLongjmp.inc(tid);
+        recordNeutralizeRestart(tid);
         __sync_synchronize();
 #ifdef CRASH_RECOVERY_USING_SETJMP
         siglongjmp(setjmpbuffers[tid], 1);
@@ -189,6 +255,7 @@ public:
         setjmpbuffers = new sigjmp_buf[numProcesses];
         pthread_key_create(&pthreadkey, NULL);
         
+#ifndef CRASH_RECOVERY_USING_CHECKPOINTS
         if (MasterRecordMgr::supportsCrashRecovery()) {
             // set up crash recovery signal handling for this process
             memset(&___act, 0, sizeof(___act));
@@ -203,6 +270,7 @@ public:
                 VERBOSE COUTATOMIC("registered signal "<<_neutralizeSignal<<" for crash recovery"<<endl);
             }
         }
+#endif
         // set up shared pointer to this class instance for the signal handler
         ___singleton = (void *) masterRecordMgr;
     }
@@ -16,6 +16,10 @@ ratios="0_0 50_50"
 maxkeys="10000"
 allocators="new"
 algs="debra.ptas debraplus.ptas hazardptr.ptas none.none"
+## to compare hazard pointers with fences and with membarrier on a read-heavy workload:
+#ratios="1_1"
+#maxkeys="100000"
+#algs="hazardptr.ptas hazardptrmb.ptas"
 threadcounts=( 1 2 4 8 )
 ntrials=10
 millis=1000
@@ -0,0 +1,65 @@
+/*
+ * File:   zipf.h
+ *
+ * Draws keys in [0, n) from a Zipfian distribution with parameter theta
+ * (0 < theta < 1): the key of rank 0 is the most frequent, the key of rank 1
+ * the second most frequent, and so on. Ranks are drawn with the method of
+ * Gray et al., "Quickly generating billion-record synthetic databases"
+ * (SIGMOD 1994), which is also used by YCSB: it takes O(n) time to set up,
+ * and O(1) time per key.
+ *
+ * If scramble is true (the default), rank r is mapped to key (r * P) mod n,
+ * where P is a prime larger than any int (so this is a permutation of [0, n)),
+ * which spreads the hot keys over the key range instead of clustering them
+ * in one subtree at the left end of the tree. Otherwise, key = rank.
+ */
+
+#ifndef ZIPF_H
+#define ZIPF_H
+
+#include <cmath>
+#include "random.h"
+
+class Zipf {
+private:
+    const int n;
+    const double theta;
+    const double alpha;
+    const double zetan;
+    const double eta;
+    const bool scramble;
+
+    static double zeta(const int n, const double theta) {
+        double sum = 0;
+        for (int i=1;i<=n;++i) {
+            sum += 1 / pow((double) i, theta);
+        }
+        return sum;
+    }
+    // returns a rank r satisfying 0 <= r < n
+    int nextRank(Random& rng) {
+        const double u = rng.nextDouble();
+        const double uz = u * zetan;
+        if (uz < 1) return 0;
+        if (uz < 1 + pow(0.5, theta)) return 1;
+        const int rank = (int) (n * pow(eta*u - eta + 1, alpha));
+        return (rank < n ? rank : n-1);
+    }
+public:
+    Zipf(const int _n, const double _theta, const bool _scramble = true)
+            : n(_n)
+            , theta(_theta)
+            , alpha(1 / (1 - _theta))
+            , zetan(zeta(_n, _theta))
+            , eta((1 - pow(2. / _n, 1 - _theta)) / (1 - zeta(2, _theta) / zetan))
+            , scramble(_scramble) {}
+
+    /** returns a key x satisfying 0 <= x < n, using rng as the source of randomness. **/
+    int next(Random& rng) {
+        const int rank = nextRank(rng);
+        if (!scramble) return rank;
+        return (int) (((unsigned long long) rank * 2654435761ULL) % (unsigned long long) n);
+    }
+};
+
+#endif /* ZIPF_H */
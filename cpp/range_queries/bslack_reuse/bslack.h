@@ -47,8 +47,12 @@
 #include <iostream>
 #include <sstream>
 #include <set>
+#include <vector>
+#include <algorithm>
+#include <limits>
 #include <unistd.h>
 #include <sys/types.h>
+#include <pthread.h>
 #include "record_manager.h"
 #include "random.h"
 #include "descriptors.h"
@@ -57,11 +61,15 @@
 #ifndef MAX_NODES_INSERTED_OR_DELETED_ATOMICALLY
     #ifdef USE_SIMPLIFIED_ABTREE_REBALANCING
         #define MAX_NODES_INSERTED_OR_DELETED_ATOMICALLY 6
+    #elif defined ABTREE_DEGREE && ABTREE_DEGREE+2 > 32
+        #define MAX_NODES_INSERTED_OR_DELETED_ATOMICALLY (ABTREE_DEGREE+2)
     #else
         #define MAX_NODES_INSERTED_OR_DELETED_ATOMICALLY 32
     #endif
 #endif
 #include "rq_provider.h"
+#include "rq_parallel.h"
+#include "simd_search.h"
 
 namespace bslack_ns {
 
@@ -119,6 +127,21 @@ namespace bslack_ns {
         Node<DEGREE,K> * deletedNodes[MAX_NODES+1];
     };
 
+    /**
+     * a node on the search path of a batch update, together with an exclusive
+     * upper bound on the keys in its subtree (as observed when the node was
+     * traversed). bounded is false if the subtree has no upper bound.
+     */
+    template <int DEGREE, typename K>
+    class FingerEntry {
+    public:
+        Node<DEGREE,K> * node;
+        K upper;
+        bool bounded;
+        FingerEntry(Node<DEGREE,K> * const _node, const K& _upper, const bool _bounded)
+            : node(_node), upper(_upper), bounded(_bounded) {}
+    };
+
     template <int DEGREE, typename K>
     struct SCXRecord {
         const static int STATE_INPROGRESS = 0;
@@ -146,22 +169,37 @@ namespace bslack_ns {
         //const static int size = 2*PREFETCH_SIZE_BYTES; // sizeof(mutables)+sizeof(numberOfNodes)+sizeof(numberOfNodesToFreeze)+sizeof(newNode)+sizeof(field)+sizeof(nodes)+sizeof(scxPtrsSeen);
     } /*__attribute__((aligned (PREFETCH_SIZE_BYTES)))*/;
         
+    // the fields read by searches (leaf, size, keys and ptrs) come first,
+    // so a search of a node (which is aligned on a cache line boundary by the
+    // bump and once allocators) touches as few cache lines as possible.
+    // the fields used only by updates and range queries come last.
     template <int DEGREE, typename K>
     struct Node {
-        SCXRecord<DEGREE,K> * volatile scxPtr;
         int leaf; // 0 or 1
+        int size; // degree of node
+        K keys[DEGREE];
+        Node<DEGREE,K> * volatile ptrs[DEGREE];
+        SCXRecord<DEGREE,K> * volatile scxPtr;
         volatile int marked; // 0 or 1
         int weight; // 0 or 1
-        int size; // degree of node
         K searchKey;
         volatile long long itime; // for use by range query algorithm
         volatile long long dtime; // for use by range query algorithm
-        K keys[DEGREE];
-        Node<DEGREE,K> * volatile ptrs[DEGREE];
 
         inline bool isLeaf() {
             return leaf;
         }
+        // prefetch the cache lines that a search of this node reads
+        // (invoked as soon as a search obtains a pointer to this node,
+        // so the misses for all of its keys overlap)
+        inline void prefetchSearchData() {
+#ifndef NO_NODE_PREFETCH
+            const char * const end = (const char *) &ptrs[0];
+            for (const char * p = (const char *) this; p < end; p += BYTES_IN_CACHE_LINE) {
+                __builtin_prefetch(p);
+            }
+#endif
+        }
         inline int getKeyCount() {
             return isLeaf() ? size : size-1;
         }
@@ -171,6 +209,11 @@ namespace bslack_ns {
         template <class Compare>
         inline int getChildIndex(const K& key, Compare cmp) {
             int nkeys = getKeyCount();
+#ifdef SIMD_SEARCH_SUPPORTED
+            if (simd_search<K,Compare>::enabled) {
+                return simd_search<K,Compare>::template findFirstGreater<DEGREE>(keys, nkeys, key);
+            }
+#endif
             int retval = 0;
             while (retval < nkeys && !cmp(key, (const K&) keys[retval])) {
                 ++retval;
@@ -180,6 +223,11 @@ namespace bslack_ns {
         template <class Compare>
         inline int getKeyIndex(const K& key, Compare cmp) {
             int nkeys = getKeyCount();
+#ifdef SIMD_SEARCH_SUPPORTED
+            if (simd_search<K,Compare>::enabled) {
+                return simd_search<K,Compare>::template findFirstGreaterOrEqual<DEGREE>(keys, nkeys, key);
+            }
+#endif
             int retval = 0;
             while (retval < nkeys && cmp((const K&) keys[retval], key)) {
                 ++retval;
@@ -339,6 +387,31 @@ namespace bslack_ns {
         }
 
         void* doInsert(const int tid, const K& key, void * const value, const bool replace);
+        bool doInsertAtLeaf(const int tid, wrapper_info<DEGREE,K> * const info, Node<DEGREE,K> * const p, const int ixToL, Node<DEGREE,K> * const l, const K& key, void * const value, const bool replace, void ** const result);
+        bool eraseAtLeaf(const int tid, wrapper_info<DEGREE,K> * const info, Node<DEGREE,K> * const p, const int ixToL, Node<DEGREE,K> * const l, const K& key, pair<void*,bool> * const result);
+        Node<DEGREE,K>* fingerSearch(const int tid, vector<FingerEntry<DEGREE,K> >& finger, const K& key, int * const ixToL);
+        template <typename Visitor>
+        int streamingRangeQuery(const int tid, const K& lo, const K& hi, const int limit, const bool descending, Visitor& visitor);
+        int doInsertBatch(const int tid, K * const keys, void ** const values, const int n, void ** const results, const bool replace);
+
+        // work assigned to one thread while building one level of a bulk-loaded tree.
+        // item j is keys[j] (with value values[j]) at the leaf level,
+        // and children[j] (whose subtree has minimum key keys[j]) above it.
+        struct BulkLoadTask {
+            bslack<DEGREE,K,Compare,RecManager> * tree;
+            int tid;
+            int numThreads;
+            const K * keys;
+            void * const * values;
+            Node<DEGREE,K> * const * children;
+            long long numItems;
+            long long numNodes;
+            Node<DEGREE,K> ** nodes;    // output: the nodes built at this level
+            K * minKeys;                // output: the minimum key in each node's subtree
+        };
+        static void * bulkLoadThread(void * arg);
+        void bulkLoadNodes(BulkLoadTask * const task);
+        void bulkLoad(const K * const keys, void * const * const values, const long long n, const int numBuildThreads);
 
         // returns true if the invocation of this method
         // (and not another invocation of a method performed by this method)
@@ -488,6 +561,26 @@ public:
     #endif
         }
 
+        /**
+         * Creates a new B-slack tree containing the n key/value pairs in
+         * keys/values, which must be sorted according to the comparator and
+         * contain no duplicate keys. Instead of inserting the pairs one by one,
+         * leaves and then each level of internal nodes are built bottom-up,
+         * packed as full as possible, by numBuildThreads threads
+         * (using tids 0..numBuildThreads-1).
+         */
+        bslack(const int numProcesses, 
+                const int nodeCapacity,
+                const K anyKey,
+                int suspectedCrashSignal,
+                const K * const keys,
+                void * const * const values,
+                const long long n,
+                const int numBuildThreads)
+        : bslack(numProcesses, nodeCapacity, anyKey, suspectedCrashSignal) {
+            bulkLoad(keys, values, n, numBuildThreads);
+        }
+
     #ifdef BSLACK_ENABLE_DESTRUCTOR    
         ~bslack() {
             int nodes = 0;
@@ -780,9 +873,57 @@ public:
             return doInsert(tid, key, val, false);
         }
         const pair<void*,bool> erase(const int tid, const K& key);
+
+        /**
+         * batch updates. keys (and values) are sorted in place, and each key
+         * is then searched for starting from the deepest node on the previous
+         * key's search path whose subtree can still contain it, instead of
+         * from the entry point. the whole batch runs in one non-quiescent
+         * interval. if results is not NULL, results[i] receives what insert /
+         * insertIfAbsent / erase would have returned for (sorted) keys[i].
+         * returns the number of keys that were inserted (resp. erased).
+         */
+        int insertBatch(const int tid, K * const keys, void ** const values, const int n, void ** const results = NULL) {
+            return doInsertBatch(tid, keys, values, n, results, true);
+        }
+        int insertIfAbsentBatch(const int tid, K * const keys, void ** const values, const int n, void ** const results = NULL) {
+            return doInsertBatch(tid, keys, values, n, results, false);
+        }
+        int eraseBatch(const int tid, K * const keys, const int n, void ** const results = NULL);
         const pair<void*,bool> find(const int tid, const K& key);
         bool contains(const int tid, const K& key);
         int rangeQuery(const int tid, const K& low, const K& hi, K * const resultKeys, void ** const resultValues);
+        /**
+         * streaming range query: passes the keys in [lo, hi] (and their values)
+         * to bool visitor(const K& key, void * const & value) in increasing order,
+         * until visitor returns false, or limit keys have been passed
+         * (limit <= 0 means no limit). returns the number of keys passed.
+         * requires an RQProvider that supports streaming (see rq_stream.h).
+         */
+        template <typename Visitor>
+        int rangeQuery(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor);
+        /**
+         * as above, but passes the keys in [lo, hi] to visitor in decreasing order.
+         */
+        template <typename Visitor>
+        int rangeQueryDescending(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor);
+        /**
+         * successor (resp. predecessor) returns false if there is no key >= key
+         * (resp. <= key), and otherwise returns true and stores the smallest
+         * such key (resp. largest such key) and its value in resultKey and
+         * resultValue. each is a linearizable streaming range query with limit 1
+         * (so it requires the same RQProviders), which stops at the first key
+         * it finds. K must be a type for which std::numeric_limits is specialized.
+         * see rq_cursor.h for iterating over many keys in order.
+         */
+        bool successor(const int tid, const K& key, K * const resultKey, void ** const resultValue);
+        bool predecessor(const int tid, const K& key, K * const resultKey, void ** const resultValue);
+        /**
+         * parallel range query: the keys in [lo, hi] are found by this thread
+         * and the threads in helpers (see rq_parallel.h), which traverse
+         * disjoint subtrees. requires rq_lockfree.
+         */
+        int rangeQuery(const int tid, const K& lo, const K& hi, K * const resultKeys, void ** const resultValues, rq_parallel<K,void *> * const helpers);
         bool validate(const long long keysum, const bool checkkeysum) {
             if (checkkeysum) {
                 long long treekeysum = getSumOfKeys();
@@ -108,6 +108,7 @@ const pair<void*,bool> bslack_ns::bslack<DEGREE,K,Compare,RecManager>::find(cons
     while (!l->isLeaf()) {
         int ix = l->getChildIndex(key, cmp);
         l = rqProvider->read_addr(tid, &l->ptrs[ix]);
+        l->prefetchSearchData();
     }
     int index = l->getKeyIndex(key, cmp);
     if (index < l->getKeyCount() && l->keys[index] == key) {
@@ -183,6 +184,160 @@ int bslack_ns::bslack<DEGREE,K,Compare,RecManager>::rangeQuery(const int tid, co
     return size;
 }
 
+template<int DEGREE, typename K, class Compare, class RecManager>
+template<typename Visitor>
+int bslack_ns::bslack<DEGREE,K,Compare,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor) {
+    return streamingRangeQuery(tid, lo, hi, limit, false, visitor);
+}
+
+template<int DEGREE, typename K, class Compare, class RecManager>
+template<typename Visitor>
+int bslack_ns::bslack<DEGREE,K,Compare,RecManager>::rangeQueryDescending(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor) {
+    return streamingRangeQuery(tid, lo, hi, limit, true, visitor);
+}
+
+template<int DEGREE, typename K, class Compare, class RecManager>
+bool bslack_ns::bslack<DEGREE,K,Compare,RecManager>::successor(const int tid, const K& key, K * const resultKey, void ** const resultValue) {
+    bool found = false;
+    auto visitor = [&](const K& k, void * const & v) {
+        *resultKey = k;
+        *resultValue = v;
+        found = true;
+        return false;
+    };
+    streamingRangeQuery(tid, key, numeric_limits<K>::max(), 1, false, visitor);
+    return found;
+}
+
+template<int DEGREE, typename K, class Compare, class RecManager>
+bool bslack_ns::bslack<DEGREE,K,Compare,RecManager>::predecessor(const int tid, const K& key, K * const resultKey, void ** const resultValue) {
+    bool found = false;
+    auto visitor = [&](const K& k, void * const & v) {
+        *resultKey = k;
+        *resultValue = v;
+        found = true;
+        return false;
+    };
+    streamingRangeQuery(tid, numeric_limits<K>::lowest(), key, 1, true, visitor);
+    return found;
+}
+
+template<int DEGREE, typename K, class Compare, class RecManager>
+template<typename Visitor>
+int bslack_ns::bslack<DEGREE,K,Compare,RecManager>::streamingRangeQuery(const int tid, const K& lo, const K& hi, const int limit, const bool descending, Visitor& visitor) {
+    block<Node<DEGREE,K>> stack (NULL);
+    recordmgr->leaveQuiescentState(tid, true);
+    rqProvider->traversal_start(tid, limit, descending);
+
+    // depth first traversal (of interesting subtrees), which visits leaves in
+    // increasing key order (or decreasing key order, if descending)
+    stack.push(entry);
+    while (!stack.isEmpty()) {
+        Node<DEGREE,K> * node = stack.pop();
+        assert(node);
+        
+        // if leaf node, check if we should add its keys to the traversal
+        if (node->isLeaf()) {
+            rqProvider->traversal_try_add(tid, node, lo, hi);
+            if (rqProvider->traversal_chunk_full(tid) && !rqProvider->traversal_flush(tid, lo, hi, visitor)) {
+                while (!stack.isEmpty()) stack.pop(); // the visitor is done, so abandon the traversal
+            }
+            
+        // else if internal node, explore its children
+        } else {
+            // find right-most sub-tree that could contain a key in [lo, hi]
+            int nkeys = node->getKeyCount();
+            int r = nkeys;
+            while (r > 0 && cmp(hi, (const K&) node->keys[r-1])) --r;           // subtree rooted at node->ptrs[r] contains only keys > hi
+
+            // find left-most sub-tree that could contain a key in [lo, hi]
+            int l = 0;
+            while (l < nkeys && !cmp(lo, (const K&) node->keys[l])) ++l;        // subtree rooted at node->ptrs[l] contains only keys < lo
+
+            // perform DFS from left to right (so push onto stack from right to left),
+            // or from right to left if descending
+            if (descending) {
+                for (int i=l;i<=r; ++i) stack.push(rqProvider->read_addr(tid, &node->ptrs[i]));
+            } else {
+                for (int i=r;i>=l; --i) stack.push(rqProvider->read_addr(tid, &node->ptrs[i]));
+            }
+        }
+    }
+    int size = rqProvider->traversal_end(tid, lo, hi, visitor);
+    recordmgr->enterQuiescentState(tid);
+    return size;
+}
+
+
+template<int DEGREE, typename K, class Compare, class RecManager>
+int bslack_ns::bslack<DEGREE,K,Compare,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi, K * const resultKeys, void ** const resultValues, rq_parallel<K,void *> * const helpers) {
+    Node<DEGREE,K> * parts[RQ_PARALLEL_MAX_PARTS];
+    Node<DEGREE,K> * next[RQ_PARALLEL_MAX_PARTS];
+    recordmgr->leaveQuiescentState(tid, true);
+    rqProvider->traversal_start(tid);
+
+    // split the interesting subtrees level by level (from left to right)
+    // until there are enough of them to keep every thread busy
+    const int targetParts = min(RQ_PARALLEL_MAX_PARTS, helpers->getNumThreads() * RQ_PARALLEL_PARTS_PER_THREAD);
+    int numParts = 0;
+    parts[numParts++] = entry;
+    while (numParts < targetParts && numParts*DEGREE <= RQ_PARALLEL_MAX_PARTS) {
+        int numNext = 0;
+        bool expanded = false;
+        for (int i=0;i<numParts;++i) {
+            Node<DEGREE,K> * node = parts[i];
+            if (node->isLeaf()) {
+                next[numNext++] = node;
+                continue;
+            }
+            expanded = true;
+            int nkeys = node->getKeyCount();
+            int r = nkeys;
+            while (r > 0 && cmp(hi, (const K&) node->keys[r-1])) --r;           // subtree rooted at node->ptrs[r] contains only keys > hi
+            int l = 0;
+            while (l < nkeys && !cmp(lo, (const K&) node->keys[l])) ++l;        // subtree rooted at node->ptrs[l] contains only keys < lo
+            for (int j=l;j<=r;++j) next[numNext++] = rqProvider->read_addr(tid, &node->ptrs[j]);
+        }
+        memcpy(parts, next, numNext*sizeof(parts[0]));
+        numParts = numNext;
+        if (!expanded) break; // every part is a leaf
+    }
+
+    // depth first traversal of each part, by the thread that claims it
+    auto traversePart = [&](const int partTid, const int part, K * const keys, void ** const values, int * const size) {
+        if (partTid != tid) {
+            recordmgr->leaveQuiescentState(partTid, true);
+            rqProvider->traversal_start_helper(partTid, tid);
+        }
+        block<Node<DEGREE,K>> stack (NULL);
+        stack.push(parts[part]);
+        while (!stack.isEmpty()) {
+            Node<DEGREE,K> * node = stack.pop();
+            assert(node);
+            if (node->isLeaf()) {
+                rqProvider->traversal_try_add(partTid, node, keys, values, size, lo, hi);
+            } else {
+                int nkeys = node->getKeyCount();
+                int r = nkeys;
+                while (r > 0 && cmp(hi, (const K&) node->keys[r-1])) --r;
+                int l = 0;
+                while (l < nkeys && !cmp(lo, (const K&) node->keys[l])) ++l;
+                for (int i=r;i>=l; --i) stack.push(rqProvider->read_addr(partTid, &node->ptrs[i]));
+            }
+        }
+        if (partTid != tid) {
+            recordmgr->enterQuiescentState(partTid);
+        }
+    };
+    int size = 0;
+    helpers->run(numParts, resultKeys, resultValues, &size, traversePart);
+    for (int i=0;i<helpers->getNumHelpers();++i) {
+        rqProvider->traversal_merge(tid, helpers->getHelperKeys(i), helpers->getHelperValues(i), helpers->getHelperSize(i), resultKeys, resultValues, &size);
+    }
+    rqProvider->traversal_end(tid, resultKeys, resultValues, &size, lo, hi);
+    recordmgr->enterQuiescentState(tid);
+    return size;
+}
 
 template <int DEGREE, typename K, class Compare, class RecManager>
 void* bslack_ns::bslack<DEGREE,K,Compare,RecManager>::doInsert(const int tid, const K& key, void * const value, const bool replace) {
@@ -204,42 +359,109 @@ void* bslack_ns::bslack<DEGREE,K,Compare,RecManager>::doInsert(const int tid, co
             gp = p;
             p = l;
             l = rqProvider->read_addr(tid, &l->ptrs[ixToL]);
+            l->prefetchSearchData();
         }
 
         /**
          * do the update
          */
-        int keyIndex = l->getKeyIndex(key, cmp);
-        if (keyIndex < l->getKeyCount() && l->keys[keyIndex] == key) {
+        void* result;
+        const bool finished = doInsertAtLeaf(tid, info, p, ixToL, l, key, value, replace, &result);
+        this->recordmgr->enterQuiescentState(tid);
+        if (finished) return result;
+    }
+}
+
+// performs the update part of an insertion, given the leaf l reached by a search
+// for key, its parent p, and the index of l in p. returns true if the
+// insertion is finished (and sets *result), and false if it must be retried.
+template <int DEGREE, typename K, class Compare, class RecManager>
+bool bslack_ns::bslack<DEGREE,K,Compare,RecManager>::doInsertAtLeaf(const int tid, wrapper_info<DEGREE,K> * const info, Node<DEGREE,K> * const p, const int ixToL, Node<DEGREE,K> * const l, const K& key, void * const value, const bool replace, void ** const result) {
+    int keyIndex = l->getKeyIndex(key, cmp);
+    if (keyIndex < l->getKeyCount() && l->keys[keyIndex] == key) {
+        /**
+         * if l already contains key, replace the existing value
+         */
+        void* const oldValue = l->ptrs[keyIndex]; // this is a value, not a pointer, so it cannot be modified by rqProvider->linearize_update_at_..., so we do not use read_addr
+        if (!replace) {
+            *result = oldValue;
+            return true;
+        }
+        
+        // perform LLXs
+        if (!llx(tid, p, NULL, 0, info->scxPtrs, info->nodes)
+                 || rqProvider->read_addr(tid, &p->ptrs[ixToL]) != l) {
+            return false;    // retry the search
+        }
+        info->nodes[1] = l;
+        
+        // create new node(s)
+        Node<DEGREE,K>* n = allocateNode(tid);
+        arraycopy(l->keys, 0, n->keys, 0, l->getKeyCount());
+        arraycopy(l->ptrs, 0, n->ptrs, 0, l->getABDegree());    // although we are copying l->ptrs, since l is a leaf, l->ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
+        n->ptrs[keyIndex] = (Node<DEGREE,K>*) value;            // similarly, we don't use write_addr here
+        n->leaf = true;
+        n->marked = false;
+        n->scxPtr = DUMMY;
+        n->searchKey = l->searchKey;
+        n->size = l->size;
+        n->weight = true;
+        
+        // construct info record to pass to SCX
+        info->numberOfNodes = 2;
+        info->numberOfNodesAllocated = 1;
+        info->numberOfNodesToFreeze = 1;
+        info->field = &p->ptrs[ixToL];
+        info->newNode = n;
+        info->insertedNodes[0] = n;
+        info->insertedNodes[1] = NULL;
+        info->deletedNodes[0] = l;
+        info->deletedNodes[1] = NULL;
+
+        if (scx(tid, info)) {
+            TRACE COUTATOMICTID("replace pair ("<<key<<", "<<value<<"): SCX succeeded"<<endl);
+#ifndef REBALANCING_NONE
+    #ifdef USE_SIMPLIFIED_ABTREE_REBALANCING
+            fixDegreeOrSlackViolation(tid, n);
+    #endif
+#endif
+            *result = oldValue;
+            return true;
+        }
+        TRACE COUTATOMICTID("replace pair ("<<key<<", "<<value<<"): SCX FAILED"<<endl);
+        this->recordmgr->deallocate(tid, n);
+
+    } else {
+        /**
+         * if l does not contain key, we have to insert it
+         */
+
+        // perform LLXs
+        if (!llx(tid, p, NULL, 0, info->scxPtrs, info->nodes) || rqProvider->read_addr(tid, &p->ptrs[ixToL]) != l) {
+            return false;    // retry the search
+        }
+        info->nodes[1] = l;
+        
+        if (l->getKeyCount() < b) {
             /**
-             * if l already contains key, replace the existing value
+             * Insert pair
              */
-            void* const oldValue = l->ptrs[keyIndex]; // this is a value, not a pointer, so it cannot be modified by rqProvider->linearize_update_at_..., so we do not use read_addr
-            if (!replace) {
-                this->recordmgr->enterQuiescentState(tid);
-                return oldValue;
-            }
-            
-            // perform LLXs
-            if (!llx(tid, p, NULL, 0, info->scxPtrs, info->nodes)
-                     || rqProvider->read_addr(tid, &p->ptrs[ixToL]) != l) {
-                this->recordmgr->enterQuiescentState(tid);
-                continue;    // retry the search
-            }
-            info->nodes[1] = l;
             
             // create new node(s)
             Node<DEGREE,K>* n = allocateNode(tid);
-            arraycopy(l->keys, 0, n->keys, 0, l->getKeyCount());
-            arraycopy(l->ptrs, 0, n->ptrs, 0, l->getABDegree());    // although we are copying l->ptrs, since l is a leaf, l->ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
-            n->ptrs[keyIndex] = (Node<DEGREE,K>*) value;            // similarly, we don't use write_addr here
-            n->leaf = true;
+            arraycopy(l->keys, 0, n->keys, 0, keyIndex);
+            arraycopy(l->keys, keyIndex, n->keys, keyIndex+1, l->getKeyCount()-keyIndex);
+            n->keys[keyIndex] = key;
+            arraycopy(l->ptrs, 0, n->ptrs, 0, keyIndex); // although we are copying the ptrs array, since the source node is a leaf, ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
+            arraycopy(l->ptrs, keyIndex, n->ptrs, keyIndex+1, l->getABDegree()-keyIndex);
+            n->ptrs[keyIndex] = (Node<DEGREE,K>*) value; // similarly, we don't use write_addr here
+            n->leaf = l->leaf;
             n->marked = false;
             n->scxPtr = DUMMY;
             n->searchKey = l->searchKey;
-            n->size = l->size;
-            n->weight = true;
-            
+            n->size = l->size+1;
+            n->weight = l->weight;
+
             // construct info record to pass to SCX
             info->numberOfNodes = 2;
             info->numberOfNodesAllocated = 1;
@@ -250,176 +472,117 @@ void* bslack_ns::bslack<DEGREE,K,Compare,RecManager>::doInsert(const int tid, co
             info->insertedNodes[1] = NULL;
             info->deletedNodes[0] = l;
             info->deletedNodes[1] = NULL;
-
+            
             if (scx(tid, info)) {
-                TRACE COUTATOMICTID("replace pair ("<<key<<", "<<value<<"): SCX succeeded"<<endl);
+                TRACE COUTATOMICTID("insert pair ("<<key<<", "<<value<<"): SCX succeeded"<<endl);
 #ifndef REBALANCING_NONE
     #ifdef USE_SIMPLIFIED_ABTREE_REBALANCING
                 fixDegreeOrSlackViolation(tid, n);
     #endif
 #endif
-                this->recordmgr->enterQuiescentState(tid);
-                return oldValue;
+                *result = NO_VALUE;
+                return true;
             }
-            TRACE COUTATOMICTID("replace pair ("<<key<<", "<<value<<"): SCX FAILED"<<endl);
-            this->recordmgr->enterQuiescentState(tid);
+            TRACE COUTATOMICTID("insert pair ("<<key<<", "<<value<<"): SCX FAILED"<<endl);
             this->recordmgr->deallocate(tid, n);
-
-        } else {
+            
+        } else { // assert: l->getKeyCount() == DEGREE == b)
             /**
-             * if l does not contain key, we have to insert it
+             * Overflow
              */
-
-            // perform LLXs
-            if (!llx(tid, p, NULL, 0, info->scxPtrs, info->nodes) || rqProvider->read_addr(tid, &p->ptrs[ixToL]) != l) {
-                this->recordmgr->enterQuiescentState(tid);
-                continue;    // retry the search
-            }
-            info->nodes[1] = l;
             
-            if (l->getKeyCount() < b) {
-                /**
-                 * Insert pair
-                 */
-                
-                // create new node(s)
-                Node<DEGREE,K>* n = allocateNode(tid);
-                arraycopy(l->keys, 0, n->keys, 0, keyIndex);
-                arraycopy(l->keys, keyIndex, n->keys, keyIndex+1, l->getKeyCount()-keyIndex);
-                n->keys[keyIndex] = key;
-                arraycopy(l->ptrs, 0, n->ptrs, 0, keyIndex); // although we are copying the ptrs array, since the source node is a leaf, ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
-                arraycopy(l->ptrs, keyIndex, n->ptrs, keyIndex+1, l->getABDegree()-keyIndex);
-                n->ptrs[keyIndex] = (Node<DEGREE,K>*) value; // similarly, we don't use write_addr here
-                n->leaf = l->leaf;
-                n->marked = false;
-                n->scxPtr = DUMMY;
-                n->searchKey = l->searchKey;
-                n->size = l->size+1;
-                n->weight = l->weight;
+            // first, we create a pair of large arrays
+            // containing too many keys and pointers to fit in a single node
+            K keys[DEGREE+1];
+            Node<DEGREE,K>* ptrs[DEGREE+1];
+            arraycopy(l->keys, 0, keys, 0, keyIndex);
+            arraycopy(l->keys, keyIndex, keys, keyIndex+1, l->getKeyCount()-keyIndex);
+            keys[keyIndex] = key;
+            arraycopy(l->ptrs, 0, ptrs, 0, keyIndex); // although we are copying the ptrs array, since the source node is a leaf, ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
+            arraycopy(l->ptrs, keyIndex, ptrs, keyIndex+1, l->getABDegree()-keyIndex);
+            ptrs[keyIndex] = (Node<DEGREE,K>*) value;
+
+            // create new node(s):
+            // since the new arrays are too big to fit in a single node,
+            // we replace l by a new subtree containing three new nodes:
+            // a parent, and two leaves;
+            // the array contents are then split between the two new leaves
+
+            const int size1 = (DEGREE+1)/2;
+            Node<DEGREE,K>* left = allocateNode(tid);
+            arraycopy(keys, 0, left->keys, 0, size1);
+            arraycopy(ptrs, 0, left->ptrs, 0, size1); // although we are copying the ptrs array, since the node is a leaf, ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
+            left->leaf = true;
+            left->marked = false;
+            left->scxPtr = DUMMY;
+            left->searchKey = keys[0];
+            left->size = size1;
+            left->weight = true;
 
-                // construct info record to pass to SCX
-                info->numberOfNodes = 2;
-                info->numberOfNodesAllocated = 1;
-                info->numberOfNodesToFreeze = 1;
-                info->field = &p->ptrs[ixToL];
-                info->newNode = n;
-                info->insertedNodes[0] = n;
-                info->insertedNodes[1] = NULL;
-                info->deletedNodes[0] = l;
-                info->deletedNodes[1] = NULL;
-                
-                if (scx(tid, info)) {
-                    TRACE COUTATOMICTID("insert pair ("<<key<<", "<<value<<"): SCX succeeded"<<endl);
-#ifndef REBALANCING_NONE
-    #ifdef USE_SIMPLIFIED_ABTREE_REBALANCING
-                    fixDegreeOrSlackViolation(tid, n);
-    #endif
-#endif
-                    this->recordmgr->enterQuiescentState(tid);
-                    return NO_VALUE;
-                }
-                TRACE COUTATOMICTID("insert pair ("<<key<<", "<<value<<"): SCX FAILED"<<endl);
-                this->recordmgr->enterQuiescentState(tid);
-                this->recordmgr->deallocate(tid, n);
-                
-            } else { // assert: l->getKeyCount() == DEGREE == b)
-                /**
-                 * Overflow
-                 */
-                
-                // first, we create a pair of large arrays
-                // containing too many keys and pointers to fit in a single node
-                K keys[DEGREE+1];
-                Node<DEGREE,K>* ptrs[DEGREE+1];
-                arraycopy(l->keys, 0, keys, 0, keyIndex);
-                arraycopy(l->keys, keyIndex, keys, keyIndex+1, l->getKeyCount()-keyIndex);
-                keys[keyIndex] = key;
-                arraycopy(l->ptrs, 0, ptrs, 0, keyIndex); // although we are copying the ptrs array, since the source node is a leaf, ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
-                arraycopy(l->ptrs, keyIndex, ptrs, keyIndex+1, l->getABDegree()-keyIndex);
-                ptrs[keyIndex] = (Node<DEGREE,K>*) value;
-
-                // create new node(s):
-                // since the new arrays are too big to fit in a single node,
-                // we replace l by a new subtree containing three new nodes:
-                // a parent, and two leaves;
-                // the array contents are then split between the two new leaves
-
-                const int size1 = (DEGREE+1)/2;
-                Node<DEGREE,K>* left = allocateNode(tid);
-                arraycopy(keys, 0, left->keys, 0, size1);
-                arraycopy(ptrs, 0, left->ptrs, 0, size1); // although we are copying the ptrs array, since the node is a leaf, ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
-                left->leaf = true;
-                left->marked = false;
-                left->scxPtr = DUMMY;
-                left->searchKey = keys[0];
-                left->size = size1;
-                left->weight = true;
-
-                const int size2 = (DEGREE+1) - size1;
-                Node<DEGREE,K>* right = allocateNode(tid);
-                arraycopy(keys, size1, right->keys, 0, size2);
-                arraycopy(ptrs, size1, right->ptrs, 0, size2); // although we are copying the ptrs array, since the node is a leaf, ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
-                right->leaf = true;
-                right->marked = false;
-                right->scxPtr = DUMMY;
-                right->searchKey = keys[size1];
-                right->size = size2;
-                right->weight = true;
-                
-                Node<DEGREE,K>* n = allocateNode(tid);
-                n->keys[0] = keys[size1];
-                rqProvider->write_addr(tid, &n->ptrs[0], left);
-                rqProvider->write_addr(tid, &n->ptrs[1], right);
-                n->leaf = false;
-                n->marked = false;
-                n->scxPtr = DUMMY;
-                n->searchKey = keys[size1];
-                n->size = 2;
-                n->weight = p == entry;
-                
-                // note: weight of new internal node n will be zero,
-                //       unless it is the root; this is because we test
-                //       p == entry, above; in doing this, we are actually
-                //       performing Root-Zero at the same time as this Overflow
-                //       if n will become the root (of the B-slack tree)
-                
-                // construct info record to pass to SCX
-                info->numberOfNodes = 2;
-                info->numberOfNodesAllocated = 3;
-                info->numberOfNodesToFreeze = 1;
-                info->field = &p->ptrs[ixToL];
-                info->newNode = n;
-                info->insertedNodes[0] = n;
-                info->insertedNodes[1] = left;
-                info->insertedNodes[2] = right;
-                info->insertedNodes[3] = NULL;
-                info->deletedNodes[0] = l;
-                info->deletedNodes[1] = NULL;
+            const int size2 = (DEGREE+1) - size1;
+            Node<DEGREE,K>* right = allocateNode(tid);
+            arraycopy(keys, size1, right->keys, 0, size2);
+            arraycopy(ptrs, size1, right->ptrs, 0, size2); // although we are copying the ptrs array, since the node is a leaf, ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
+            right->leaf = true;
+            right->marked = false;
+            right->scxPtr = DUMMY;
+            right->searchKey = keys[size1];
+            right->size = size2;
+            right->weight = true;
+            
+            Node<DEGREE,K>* n = allocateNode(tid);
+            n->keys[0] = keys[size1];
+            rqProvider->write_addr(tid, &n->ptrs[0], left);
+            rqProvider->write_addr(tid, &n->ptrs[1], right);
+            n->leaf = false;
+            n->marked = false;
+            n->scxPtr = DUMMY;
+            n->searchKey = keys[size1];
+            n->size = 2;
+            n->weight = p == entry;
+            
+            // note: weight of new internal node n will be zero,
+            //       unless it is the root; this is because we test
+            //       p == entry, above; in doing this, we are actually
+            //       performing Root-Zero at the same time as this Overflow
+            //       if n will become the root (of the B-slack tree)
+            
+            // construct info record to pass to SCX
+            info->numberOfNodes = 2;
+            info->numberOfNodesAllocated = 3;
+            info->numberOfNodesToFreeze = 1;
+            info->field = &p->ptrs[ixToL];
+            info->newNode = n;
+            info->insertedNodes[0] = n;
+            info->insertedNodes[1] = left;
+            info->insertedNodes[2] = right;
+            info->insertedNodes[3] = NULL;
+            info->deletedNodes[0] = l;
+            info->deletedNodes[1] = NULL;
 
-                if (scx(tid, info)) {
-                    TRACE COUTATOMICTID("insert overflow ("<<key<<", "<<value<<"): SCX succeeded"<<endl);
-                    if (SEQUENTIAL_STAT_TRACKING) ++overflows;
+            if (scx(tid, info)) {
+                TRACE COUTATOMICTID("insert overflow ("<<key<<", "<<value<<"): SCX succeeded"<<endl);
+                if (SEQUENTIAL_STAT_TRACKING) ++overflows;
 
-                    // after overflow, there may be a weight violation at n,
-                    // and there may be a slack violation at p
+                // after overflow, there may be a weight violation at n,
+                // and there may be a slack violation at p
 #ifndef REBALANCING_NONE
-                    fixWeightViolation(tid, n);
+                fixWeightViolation(tid, n);
     #ifdef USE_SIMPLIFIED_ABTREE_REBALANCING
     #else
-                    fixDegreeOrSlackViolation(tid, p);
+                fixDegreeOrSlackViolation(tid, p);
     #endif
 #endif
-                    this->recordmgr->enterQuiescentState(tid);
-                    return NO_VALUE;
-                }
-                TRACE COUTATOMICTID("insert overflow ("<<key<<", "<<value<<"): SCX FAILED"<<endl);
-                this->recordmgr->enterQuiescentState(tid);
-                this->recordmgr->deallocate(tid, n);
-                this->recordmgr->deallocate(tid, left);
-                this->recordmgr->deallocate(tid, right);
+                *result = NO_VALUE;
+                return true;
             }
+            TRACE COUTATOMICTID("insert overflow ("<<key<<", "<<value<<"): SCX FAILED"<<endl);
+            this->recordmgr->deallocate(tid, n);
+            this->recordmgr->deallocate(tid, left);
+            this->recordmgr->deallocate(tid, right);
         }
     }
+    return false;
 }
 
 template <int DEGREE, typename K, class Compare, class RecManager>
@@ -442,76 +605,290 @@ const pair<void*,bool> bslack_ns::bslack<DEGREE,K,Compare,RecManager>::erase(con
             gp = p;
             p = l;
             l = rqProvider->read_addr(tid, &l->ptrs[ixToL]);
+            l->prefetchSearchData();
         }
 
         /**
          * do the update
          */
-        const int keyIndex = l->getKeyIndex(key, cmp);
-        if (keyIndex == l->getKeyCount() || l->keys[keyIndex] != key) {
-            /**
-             * if l does not contain key, we are done.
-             */
-            this->recordmgr->enterQuiescentState(tid);
-            return pair<void*,bool>(NO_VALUE,false);
-        } else {
-            /**
-             * if l contains key, replace l by a new copy that does not contain key.
-             */
-
-            // perform LLXs
-            if (!llx(tid, p, NULL, 0, info->scxPtrs, info->nodes) || rqProvider->read_addr(tid, &p->ptrs[ixToL]) != l) {
-                this->recordmgr->enterQuiescentState(tid);
-                continue;    // retry the search
-            }
-            info->nodes[1] = l;
-            // create new node(s)
-            Node<DEGREE,K>* n = allocateNode(tid);
-            //printf("keyIndex=%d getABDegree-keyIndex=%d\n", keyIndex, l->getABDegree()-keyIndex);
-            arraycopy(l->keys, 0, n->keys, 0, keyIndex);
-            arraycopy(l->keys, keyIndex+1, n->keys, keyIndex, l->getKeyCount()-(keyIndex+1));
-            arraycopy(l->ptrs, 0, n->ptrs, 0, keyIndex); // although we are copying the ptrs array, since the node is a leaf, ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
-            arraycopy(l->ptrs, keyIndex+1, n->ptrs, keyIndex, l->getABDegree()-(keyIndex+1));
-            n->leaf = true;
-            n->marked = false;
-            n->scxPtr = DUMMY;
-            n->searchKey = l->keys[0]; // NOTE: WE MIGHT BE DELETING l->keys[0], IN WHICH CASE newL IS EMPTY. HOWEVER, newL CAN STILL BE LOCATED BY SEARCHING FOR l->keys[0], SO WE USE THAT AS THE searchKey FOR newL.
-            n->size = l->size-1;
-            n->weight = true;
+        pair<void*,bool> result;
+        const bool finished = eraseAtLeaf(tid, info, p, ixToL, l, key, &result);
+        this->recordmgr->enterQuiescentState(tid);
+        if (finished) return result;
+    }
+}
 
-            // construct info record to pass to SCX
-            info->numberOfNodes = 2;
-            info->numberOfNodesAllocated = 1;
-            info->numberOfNodesToFreeze = 1;
-            info->field = &p->ptrs[ixToL];
-            info->newNode = n;
-            info->insertedNodes[0] = n;
-            info->insertedNodes[1] = NULL;
-            info->deletedNodes[0] = l;
-            info->deletedNodes[1] = NULL;
+// performs the update part of a deletion, given the leaf l reached by a search
+// for key, its parent p, and the index of l in p. returns true if the
+// deletion is finished (and sets *result), and false if it must be retried.
+template <int DEGREE, typename K, class Compare, class RecManager>
+bool bslack_ns::bslack<DEGREE,K,Compare,RecManager>::eraseAtLeaf(const int tid, wrapper_info<DEGREE,K> * const info, Node<DEGREE,K> * const p, const int ixToL, Node<DEGREE,K> * const l, const K& key, pair<void*,bool> * const result) {
+    const int keyIndex = l->getKeyIndex(key, cmp);
+    if (keyIndex == l->getKeyCount() || l->keys[keyIndex] != key) {
+        /**
+         * if l does not contain key, we are done.
+         */
+        *result = pair<void*,bool>(NO_VALUE,false);
+        return true;
+    } else {
+        /**
+         * if l contains key, replace l by a new copy that does not contain key.
+         */
 
-            void* oldValue = l->ptrs[keyIndex]; // since the node is a leaf, ptrs is not modified by any call to rqProvider->linearize_update_at_..., so we do not need to use read_addr to access it
-            if (scx(tid, info)) {
-                TRACE COUTATOMICTID("delete pair ("<<key<<", "<<oldValue<<"): SCX succeeded"<<endl);
+        // perform LLXs
+        if (!llx(tid, p, NULL, 0, info->scxPtrs, info->nodes) || rqProvider->read_addr(tid, &p->ptrs[ixToL]) != l) {
+            return false;    // retry the search
+        }
+        info->nodes[1] = l;
+        // create new node(s)
+        Node<DEGREE,K>* n = allocateNode(tid);
+        //printf("keyIndex=%d getABDegree-keyIndex=%d\n", keyIndex, l->getABDegree()-keyIndex);
+        arraycopy(l->keys, 0, n->keys, 0, keyIndex);
+        arraycopy(l->keys, keyIndex+1, n->keys, keyIndex, l->getKeyCount()-(keyIndex+1));
+        arraycopy(l->ptrs, 0, n->ptrs, 0, keyIndex); // although we are copying the ptrs array, since the node is a leaf, ptrs CANNOT contain modified by rqProvider->linearize_update_at_..., so we do not use arraycopy_ptrs.
+        arraycopy(l->ptrs, keyIndex+1, n->ptrs, keyIndex, l->getABDegree()-(keyIndex+1));
+        n->leaf = true;
+        n->marked = false;
+        n->scxPtr = DUMMY;
+        n->searchKey = l->keys[0]; // NOTE: WE MIGHT BE DELETING l->keys[0], IN WHICH CASE newL IS EMPTY. HOWEVER, newL CAN STILL BE LOCATED BY SEARCHING FOR l->keys[0], SO WE USE THAT AS THE searchKey FOR newL.
+        n->size = l->size-1;
+        n->weight = true;
+
+        // construct info record to pass to SCX
+        info->numberOfNodes = 2;
+        info->numberOfNodesAllocated = 1;
+        info->numberOfNodesToFreeze = 1;
+        info->field = &p->ptrs[ixToL];
+        info->newNode = n;
+        info->insertedNodes[0] = n;
+        info->insertedNodes[1] = NULL;
+        info->deletedNodes[0] = l;
+        info->deletedNodes[1] = NULL;
+
+        void* oldValue = l->ptrs[keyIndex]; // since the node is a leaf, ptrs is not modified by any call to rqProvider->linearize_update_at_..., so we do not need to use read_addr to access it
+        if (scx(tid, info)) {
+            TRACE COUTATOMICTID("delete pair ("<<key<<", "<<oldValue<<"): SCX succeeded"<<endl);
 
-                /**
-                 * Compress may be needed at p after removing key from l.
-                 */
+            /**
+             * Compress may be needed at p after removing key from l.
+             */
 #ifndef REBALANCING_NONE
     #ifdef USE_SIMPLIFIED_ABTREE_REBALANCING
-                fixDegreeOrSlackViolation(tid, n);
+            fixDegreeOrSlackViolation(tid, n);
     #else
-                fixDegreeOrSlackViolation(tid, p);
+            fixDegreeOrSlackViolation(tid, p);
     #endif
 #endif
-                this->recordmgr->enterQuiescentState(tid);
-                return pair<void*,bool>(oldValue, true);
+            *result = pair<void*,bool>(oldValue, true);
+            return true;
+        }
+        TRACE COUTATOMICTID("delete pair ("<<key<<", "<<oldValue<<"): SCX FAILED"<<endl);
+        this->recordmgr->deallocate(tid, n);
+    }
+    return false;
+}
+
+// finds the leaf that key belongs in, starting from the deepest node in
+// finger that has not been removed from the tree and whose subtree can contain
+// key, and leaves the internal nodes on the path to that leaf in finger.
+// the index of the leaf in its parent (finger.back().node) is stored in ixToL.
+// this is only correct if keys are searched for in non-decreasing order, and
+// the caller stays in a non-quiescent state while it uses finger.
+// (rebalancing steps preserve the keys that separate a surviving node from its
+// siblings, so an upper bound observed earlier remains safe to use.)
+template <int DEGREE, typename K, class Compare, class RecManager>
+bslack_ns::Node<DEGREE,K>* bslack_ns::bslack<DEGREE,K,Compare,RecManager>::fingerSearch(const int tid, vector<FingerEntry<DEGREE,K> >& finger, const K& key, int * const ixToL) {
+    while (finger.size() > 1) { // note: entry is never removed
+        FingerEntry<DEGREE,K>& e = finger.back();
+        if (!e.node->marked && (!e.bounded || cmp(key, e.upper))) break;
+        finger.pop_back();
+    }
+    if (finger.empty()) {
+        finger.push_back(FingerEntry<DEGREE,K>(entry, key, false));
+    }
+    Node<DEGREE,K>* p = finger.back().node;
+    K upper = finger.back().upper;
+    bool bounded = finger.back().bounded;
+    int ix = p->getChildIndex(key, cmp);
+    Node<DEGREE,K>* l = rqProvider->read_addr(tid, &p->ptrs[ix]);
+    while (!l->isLeaf()) {
+        if (ix < p->getKeyCount()) {
+            upper = p->keys[ix];
+            bounded = true;
+        }
+        finger.push_back(FingerEntry<DEGREE,K>(l, upper, bounded));
+        p = l;
+        ix = l->getChildIndex(key, cmp);
+        l = rqProvider->read_addr(tid, &l->ptrs[ix]);
+        l->prefetchSearchData();
+    }
+    *ixToL = ix;
+    return l;
+}
+
+template <int DEGREE, typename K, class Compare, class RecManager>
+int bslack_ns::bslack<DEGREE,K,Compare,RecManager>::doInsertBatch(const int tid, K * const keys, void ** const values, const int n, void ** const results, const bool replace) {
+    vector<pair<K,void*> > items (n);
+    for (int i=0;i<n;++i) items[i] = pair<K,void*>(keys[i], values[i]);
+    Compare c = cmp;
+    std::sort(items.begin(), items.end(), [c](const pair<K,void*>& a, const pair<K,void*>& b) { return c(a.first, b.first); });
+    for (int i=0;i<n;++i) { keys[i] = items[i].first; values[i] = items[i].second; }
+
+    wrapper_info<DEGREE,K> _info;
+    wrapper_info<DEGREE,K>* info = &_info;
+    vector<FingerEntry<DEGREE,K> > finger;
+    int numInserted = 0;
+    this->recordmgr->leaveQuiescentState(tid);
+    for (int i=0;i<n;++i) {
+        void* result;
+        for (;;) {
+            int ixToL;
+            Node<DEGREE,K>* l = fingerSearch(tid, finger, keys[i], &ixToL);
+            if (doInsertAtLeaf(tid, info, finger.back().node, ixToL, l, keys[i], values[i], replace, &result)) break;
+        }
+        if (results) results[i] = result;
+        if (result == NO_VALUE) ++numInserted;
+    }
+    this->recordmgr->enterQuiescentState(tid);
+    return numInserted;
+}
+
+template <int DEGREE, typename K, class Compare, class RecManager>
+int bslack_ns::bslack<DEGREE,K,Compare,RecManager>::eraseBatch(const int tid, K * const keys, const int n, void ** const results) {
+    std::sort(keys, keys+n, cmp);
+
+    wrapper_info<DEGREE,K> _info;
+    wrapper_info<DEGREE,K>* info = &_info;
+    vector<FingerEntry<DEGREE,K> > finger;
+    int numErased = 0;
+    this->recordmgr->leaveQuiescentState(tid);
+    for (int i=0;i<n;++i) {
+        pair<void*,bool> result;
+        for (;;) {
+            int ixToL;
+            Node<DEGREE,K>* l = fingerSearch(tid, finger, keys[i], &ixToL);
+            if (eraseAtLeaf(tid, info, finger.back().node, ixToL, l, keys[i], &result)) break;
+        }
+        if (results) results[i] = result.first;
+        if (result.second) ++numErased;
+    }
+    this->recordmgr->enterQuiescentState(tid);
+    return numErased;
+}
+
+template <int DEGREE, typename K, class Compare, class RecManager>
+void * bslack_ns::bslack<DEGREE,K,Compare,RecManager>::bulkLoadThread(void * arg) {
+    BulkLoadTask * const task = (BulkLoadTask *) arg;
+    task->tree->bulkLoadNodes(task);
+    return NULL;
+}
+
+// builds this thread's share of the nodes at one level of a bulk-loaded tree.
+// items are spread evenly over the nodes of the level, so every node holds
+// either floor or ceiling of numItems/numNodes items, and the total slack at
+// the level is less than b.
+template <int DEGREE, typename K, class Compare, class RecManager>
+void bslack_ns::bslack<DEGREE,K,Compare,RecManager>::bulkLoadNodes(BulkLoadTask * const task) {
+    const int tid = task->tid;
+    initThread(tid);
+    const long long lo = task->numNodes * tid / task->numThreads;
+    const long long hi = task->numNodes * (tid+1) / task->numThreads;
+    for (long long i=lo;i<hi;++i) {
+        const long long start = task->numItems * i / task->numNodes;
+        const long long end = task->numItems * (i+1) / task->numNodes;
+        const int size = (int) (end - start);
+        assert(size > 0 && size <= b);
+
+        Node<DEGREE,K>* n = allocateNode(tid);
+        n->scxPtr = DUMMY;
+        n->marked = false;
+        n->weight = true;
+        n->size = size;
+        n->searchKey = task->keys[start];
+        if (task->children == NULL) {
+            n->leaf = true;
+            arraycopy(task->keys, start, n->keys, 0, size);
+            for (int j=0;j<size;++j) {
+                n->ptrs[j] = (Node<DEGREE,K>*) task->values[start+j]; // since n is a leaf, ptrs contains values, which are not modified by rqProvider->linearize_update_at_..., so we do not use write_addr.
+            }
+        } else {
+            n->leaf = false;
+            arraycopy(task->keys, start+1, n->keys, 0, size-1);
+            for (int j=0;j<size;++j) {
+                // simulate the insertion of each child, so that it gets an
+                // itime, as in the constructor (see the comment there).
+                Node<DEGREE,K>* insertedNodes[] = {task->children[start+j], NULL};
+                Node<DEGREE,K>* deletedNodes[] = {NULL};
+                rqProvider->write_addr(tid, &n->ptrs[j], (Node<DEGREE,K>*) NULL);
+                rqProvider->linearize_update_at_write(tid, &n->ptrs[j], task->children[start+j], insertedNodes, deletedNodes);
+            }
+        }
+        task->nodes[i] = n;
+        task->minKeys[i] = task->keys[start];
+    }
+}
+
+template <int DEGREE, typename K, class Compare, class RecManager>
+void bslack_ns::bslack<DEGREE,K,Compare,RecManager>::bulkLoad(const K * const keys, void * const * const values, const long long n, const int numBuildThreads) {
+    if (n <= 0) return;
+    const int numThreads = max(1, min(numBuildThreads, NUM_PROCESSES));
+
+    // build the leaves, then each level of internal nodes, until one node remains
+    const K * levelKeys = keys;
+    void * const * levelValues = values;
+    Node<DEGREE,K> ** levelNodes = NULL;
+    K * levelMinKeys = NULL;
+    long long numItems = n;
+    while (true) {
+        const long long numNodes = (numItems + b - 1) / b;
+        Node<DEGREE,K> ** nodes = new Node<DEGREE,K>*[numNodes];
+        K * minKeys = new K[numNodes];
+
+        const int workers = (int) min((long long) numThreads, numNodes);
+        vector<BulkLoadTask> tasks (workers);
+        vector<pthread_t> threads (workers);
+        for (int i=0;i<workers;++i) {
+            tasks[i].tree = this;
+            tasks[i].tid = i;
+            tasks[i].numThreads = workers;
+            tasks[i].keys = levelKeys;
+            tasks[i].values = levelValues;
+            tasks[i].children = levelNodes;
+            tasks[i].numItems = numItems;
+            tasks[i].numNodes = numNodes;
+            tasks[i].nodes = nodes;
+            tasks[i].minKeys = minKeys;
+            if (pthread_create(&threads[i], NULL, bulkLoadThread, &tasks[i])) {
+                cerr<<"ERROR: could not create thread"<<endl;
+                exit(-1);
+            }
+        }
+        for (int i=0;i<workers;++i) {
+            if (pthread_join(threads[i], NULL)) {
+                cerr<<"ERROR: could not join bulk loading thread"<<endl;
+                exit(-1);
             }
-            TRACE COUTATOMICTID("delete pair ("<<key<<", "<<oldValue<<"): SCX FAILED"<<endl);
-            this->recordmgr->enterQuiescentState(tid);
-            this->recordmgr->deallocate(tid, n);
         }
+        TRACE COUTATOMIC("bulk load: built "<<numNodes<<" nodes from "<<numItems<<" items"<<endl);
+
+        if (levelNodes) delete[] levelNodes;
+        if (levelMinKeys) delete[] levelMinKeys;
+        levelNodes = nodes;
+        levelMinKeys = minKeys;
+        levelKeys = minKeys;
+        levelValues = NULL;
+        numItems = numNodes;
+        if (numNodes == 1) break;
     }
+
+    // replace the empty leaf below entry with the root of the new tree
+    const int tid = 0;
+    Node<DEGREE,K>* oldLeaf = rqProvider->read_addr(tid, &entry->ptrs[0]);
+    Node<DEGREE,K>* insertedNodes[] = {levelNodes[0], NULL};
+    Node<DEGREE,K>* deletedNodes[] = {oldLeaf, NULL};
+    rqProvider->linearize_update_at_write(tid, &entry->ptrs[0], levelNodes[0], insertedNodes, deletedNodes);
+    delete[] levelNodes;
+    delete[] levelMinKeys;
 }
 
 /**
@@ -635,6 +1012,7 @@ bool bslack_ns::bslack<DEGREE,K,Compare,RecManager>::fixWeightViolation(const in
             gp = p;
             p = l;
             l = rqProvider->read_addr(tid, &l->ptrs[ixToL]);
+            l->prefetchSearchData();
         }
 
         if (l != viol) {
@@ -869,6 +1247,7 @@ bool bslack_ns::bslack<DEGREE,K,Compare,RecManager>::fixDegreeOrSlackViolation(c
             gp = p;
             p = l;
             l = rqProvider->read_addr(tid, &l->ptrs[ixToL]);
+            l->prefetchSearchData();
         }
 
         if (l != viol) {
@@ -1325,6 +1704,7 @@ bool bslack_ns::bslack<DEGREE,K,Compare,RecManager>::fixDegreeOrSlackViolation(c
             gp = p;
             p = l;
             l = rqProvider->read_addr(tid, &l->ptrs[ixToL]);
+            l->prefetchSearchData();
         }
 
         if (l != viol) {
@@ -20,6 +20,9 @@
 #include <pthread.h>
 #include <stdexcept>
 #include <bitset>
+#include <vector>
+#include <algorithm>
+#include <limits>
 #include "record_manager.h"
 #include "random.h"
 #include "scxrecord.h"
@@ -30,6 +33,8 @@
     #define MAX_NODES_INSERTED_OR_DELETED_ATOMICALLY 4
 #endif
 #include "rq_provider.h"
+#include "rq_parallel.h"
+#include "elimination.h"
 
 using namespace std;
 
@@ -51,6 +56,22 @@ namespace bst_ns {
         int lastAbort;
     };
 
+    /**
+     * an internal node on the search path of a batch update, together with
+     * an exclusive upper bound on the keys in its subtree (as observed when
+     * the node was traversed). since the keys of a batch are processed in
+     * sorted order, the upper bound is all we need to decide whether the
+     * next key can be found below this node.
+     */
+    template <class K, class V>
+    class FingerEntry {
+    public:
+        Node<K,V> * node;
+        K upper;
+        FingerEntry(Node<K,V> * const _node, const K& _upper)
+            : node(_node), upper(_upper) {}
+    };
+
     template <class K, class V, class Compare, class RecManager>
     class bst {
     private:
@@ -74,6 +95,10 @@ namespace bst_ns {
         // debug info
         debugCounters * const counters;
     #endif
+    #ifdef BST_ELIMINATION
+        // updates that fail their first attempt go through this layer
+        elimination_layer<K,V> * const elimination;
+    #endif
 
         // descriptor reduction algorithm
         #define DESC1_ARRAY records
@@ -119,6 +144,11 @@ namespace bst_ns {
         int rangeQuery_vlx(ReclamationInfo<K,V> * const, const int, void **input, void **output);
         bool updateInsert_search_llx_scx(ReclamationInfo<K,V> * const, const int, void **input, void **output); // input consists of: const K& key, const V& val, const bool onlyIfAbsent
         bool updateErase_search_llx_scx(ReclamationInfo<K,V> * const, const int, void **input, void **output); // input consists of: const K& key, const V& val, const bool onlyIfAbsent
+        bool updateInsert_llx_scx(ReclamationInfo<K,V> * const, const int, Node<K,V> * const p, Node<K,V> * const l, const K& key, const V& val, const bool onlyIfAbsent, V * const result);
+        bool updateErase_llx_scx(ReclamationInfo<K,V> * const, const int, Node<K,V> * const gp, Node<K,V> * const p, Node<K,V> * const l, const K& key, V * const result);
+        inline Node<K,V>* fingerSearch(const int tid, vector<FingerEntry<K,V> >& finger, const K& key);
+        template <typename Visitor>
+        int streamingRangeQuery(const int tid, const K& lo, const K& hi, const int limit, const bool descending, Visitor& visitor);
         void reclaimMemoryAfterSCX(
                     const int tid,
                     ReclamationInfo<K,V> * info);
@@ -141,7 +171,10 @@ namespace bst_ns {
         long long debugKeySum(Node<K,V> * node);
         bool validate(Node<K,V> * const node, const int currdepth, const int leafdepth);
 
-        const V doInsert(const int tid, const K& key, const V& val, bool onlyIfAbsent);
+        // op is ELIMINATION_OP_INSERT, ELIMINATION_OP_INSERT_IF_ABSENT or ELIMINATION_OP_ERASE
+        bool updateOnce(const int tid, const int op, const K& key, const V& val, V * const result); // one attempt; last arg is an output arg
+        V update(const int tid, const int op, const K& key, const V& val);
+        int doInsertBatch(const int tid, K * const keys, V * const values, const int n, V * const results, bool onlyIfAbsent);
         
         int init[MAX_TID_POW2] = {0,};
 
@@ -184,6 +217,9 @@ public:
                     , rqProvider(new RQProvider<K, V, Node<K,V>, bst<K,V,Compare,RecManager>, RecManager, false, false>(numProcesses, this, recmgr))
     #ifdef USE_DEBUGCOUNTERS
                     , counters(new debugCounters(numProcesses))
+    #endif
+    #ifdef BST_ELIMINATION
+                    , elimination(new elimination_layer<K,V>(numProcesses, _NO_VALUE))
     #endif
         {
 
@@ -267,6 +303,9 @@ public:
             delete recmgr;
     #ifdef USE_DEBUGCOUNTERS
             delete counters;
+    #endif
+    #ifdef BST_ELIMINATION
+            delete elimination;
     #endif
         }
 
@@ -274,8 +313,52 @@ public:
         const V insert(const int tid, const K& key, const V& val);
         const V insertIfAbsent(const int tid, const K& key, const V& val);
         const pair<V,bool> erase(const int tid, const K& key);
+
+        /**
+         * batch updates. keys (and values) are sorted in place, and each key
+         * is then searched for starting from the deepest node on the previous
+         * key's search path whose subtree can still contain it, instead of
+         * from the root. the whole batch runs in one non-quiescent interval.
+         * if results is not NULL, results[i] receives what insert /
+         * insertIfAbsent / erase would have returned for (sorted) keys[i].
+         * returns the number of keys that were inserted (resp. erased).
+         */
+        int insertBatch(const int tid, K * const keys, V * const values, const int n, V * const results = NULL);
+        int insertIfAbsentBatch(const int tid, K * const keys, V * const values, const int n, V * const results = NULL);
+        int eraseBatch(const int tid, K * const keys, const int n, V * const results = NULL);
         const pair<V,bool> find(const int tid, const K& key);
         int rangeQuery(const int tid, const K& lo, const K& hi, K * const resultKeys, V * const resultValues);
+        /**
+         * streaming range query: passes the keys in [lo, hi] (and their values)
+         * to bool visitor(const K& key, const V& value) in increasing order,
+         * until visitor returns false, or limit keys have been passed
+         * (limit <= 0 means no limit). returns the number of keys passed.
+         * requires an RQProvider that supports streaming (see rq_stream.h).
+         */
+        template <typename Visitor>
+        int rangeQuery(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor);
+        /**
+         * as above, but passes the keys in [lo, hi] to visitor in decreasing order.
+         */
+        template <typename Visitor>
+        int rangeQueryDescending(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor);
+        /**
+         * successor (resp. predecessor) returns false if there is no key >= key
+         * (resp. <= key), and otherwise returns true and stores the smallest
+         * such key (resp. largest such key) and its value in resultKey and
+         * resultValue. each is a linearizable streaming range query with limit 1
+         * (so it requires the same RQProviders), which stops at the first key
+         * it finds. K must be a type for which std::numeric_limits is specialized.
+         * see rq_cursor.h for iterating over many keys in order.
+         */
+        bool successor(const int tid, const K& key, K * const resultKey, V * const resultValue);
+        bool predecessor(const int tid, const K& key, K * const resultKey, V * const resultValue);
+        /**
+         * parallel range query: the keys in [lo, hi] are found by this thread
+         * and the threads in helpers (see rq_parallel.h), which traverse
+         * disjoint subtrees. requires rq_lockfree.
+         */
+        int rangeQuery(const int tid, const K& lo, const K& hi, K * const resultKeys, V * const resultValues, rq_parallel<K,V> * const helpers);
         bool contains(const int tid, const K& key);
         int size(void); /** warning: size is a LINEAR time operation, and does not return consistent results with concurrency **/
 
@@ -378,6 +461,11 @@ public:
         RecManager * const debugGetRecMgr() {
             return recmgr;
         }
+    #ifdef BST_ELIMINATION
+        elimination_layer<K,V> * const debugGetElimination() {
+            return elimination;
+        }
+    #endif
 
         bool validate(const long long keysum, const bool checkkeysum);
         long long debugKeySum() {
@@ -107,6 +107,160 @@ int bst_ns::bst<K,V,Compare,RecManager>::rangeQuery(const int tid, const K& lo,
     return size;
 }
 
+template<class K, class V, class Compare, class RecManager>
+template<typename Visitor>
+int bst_ns::bst<K,V,Compare,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor) {
+    return streamingRangeQuery(tid, lo, hi, limit, false, visitor);
+}
+
+template<class K, class V, class Compare, class RecManager>
+template<typename Visitor>
+int bst_ns::bst<K,V,Compare,RecManager>::rangeQueryDescending(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor) {
+    return streamingRangeQuery(tid, lo, hi, limit, true, visitor);
+}
+
+template<class K, class V, class Compare, class RecManager>
+bool bst_ns::bst<K,V,Compare,RecManager>::successor(const int tid, const K& key, K * const resultKey, V * const resultValue) {
+    bool found = false;
+    auto visitor = [&](const K& k, const V& v) {
+        *resultKey = k;
+        *resultValue = v;
+        found = true;
+        return false;
+    };
+    streamingRangeQuery(tid, key, numeric_limits<K>::max(), 1, false, visitor);
+    return found;
+}
+
+template<class K, class V, class Compare, class RecManager>
+bool bst_ns::bst<K,V,Compare,RecManager>::predecessor(const int tid, const K& key, K * const resultKey, V * const resultValue) {
+    bool found = false;
+    auto visitor = [&](const K& k, const V& v) {
+        *resultKey = k;
+        *resultValue = v;
+        found = true;
+        return false;
+    };
+    streamingRangeQuery(tid, numeric_limits<K>::lowest(), key, 1, true, visitor);
+    return found;
+}
+
+template<class K, class V, class Compare, class RecManager>
+template<typename Visitor>
+int bst_ns::bst<K,V,Compare,RecManager>::streamingRangeQuery(const int tid, const K& lo, const K& hi, const int limit, const bool descending, Visitor& visitor) {
+    block<Node<K,V> > stack (NULL);
+    recmgr->leaveQuiescentState(tid, true);
+    rqProvider->traversal_start(tid, limit, descending);
+    
+    // depth first traversal (of interesting subtrees), which visits leaves in
+    // increasing key order (or decreasing key order, if descending)
+    stack.push(root);
+    while (!stack.isEmpty()) {
+        Node<K,V> * node = stack.pop();
+        assert(node);
+        Node<K,V> * left = rqProvider->read_addr(tid, &node->left);
+        
+        // if internal node, explore its children
+        if (left != NULL) {
+            const bool exploreLeft = (node->key == this->NO_KEY || cmp(lo, node->key));
+            if (descending && exploreLeft) stack.push(left);
+            if (node->key != this->NO_KEY && !cmp(hi, node->key)) {
+                Node<K,V> * right = rqProvider->read_addr(tid, &node->right);
+                assert(right);
+                stack.push(right);
+            }
+            if (!descending && exploreLeft) {
+                assert(left);
+                stack.push(left);
+            }
+            
+        // else if leaf node, check if we should add its key to the traversal
+        } else {
+            rqProvider->traversal_try_add(tid, node, lo, hi);
+            if (rqProvider->traversal_chunk_full(tid) && !rqProvider->traversal_flush(tid, lo, hi, visitor)) {
+                while (!stack.isEmpty()) stack.pop(); // the visitor is done, so abandon the traversal
+            }
+        }
+    }
+    int size = rqProvider->traversal_end(tid, lo, hi, visitor);
+    recmgr->enterQuiescentState(tid);
+    return size;
+}
+
+template<class K, class V, class Compare, class RecManager>
+int bst_ns::bst<K,V,Compare,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi, K * const resultKeys, V * const resultValues, rq_parallel<K,V> * const helpers) {
+    Node<K,V> * parts[RQ_PARALLEL_MAX_PARTS];
+    Node<K,V> * next[RQ_PARALLEL_MAX_PARTS];
+    recmgr->leaveQuiescentState(tid, true);
+    rqProvider->traversal_start(tid);
+
+    // split the interesting subtrees level by level (from left to right)
+    // until there are enough of them to keep every thread busy
+    const int targetParts = min(RQ_PARALLEL_MAX_PARTS, helpers->getNumThreads() * RQ_PARALLEL_PARTS_PER_THREAD);
+    int numParts = 0;
+    parts[numParts++] = root;
+    while (numParts < targetParts && numParts*2 <= RQ_PARALLEL_MAX_PARTS) {
+        int numNext = 0;
+        bool expanded = false;
+        for (int i=0;i<numParts;++i) {
+            Node<K,V> * node = parts[i];
+            Node<K,V> * left = rqProvider->read_addr(tid, &node->left);
+            if (left == NULL) {
+                next[numNext++] = node;
+                continue;
+            }
+            expanded = true;
+            if (node->key == this->NO_KEY || cmp(lo, node->key)) {
+                next[numNext++] = left;
+            }
+            if (node->key != this->NO_KEY && !cmp(hi, node->key)) {
+                next[numNext++] = rqProvider->read_addr(tid, &node->right);
+            }
+        }
+        memcpy(parts, next, numNext*sizeof(parts[0]));
+        numParts = numNext;
+        if (!expanded) break; // every part is a leaf
+    }
+
+    // depth first traversal of each part, by the thread that claims it
+    auto traversePart = [&](const int partTid, const int part, K * const keys, V * const values, int * const size) {
+        if (partTid != tid) {
+            recmgr->leaveQuiescentState(partTid, true);
+            rqProvider->traversal_start_helper(partTid, tid);
+        }
+        block<Node<K,V> > stack (NULL);
+        stack.push(parts[part]);
+        while (!stack.isEmpty()) {
+            Node<K,V> * node = stack.pop();
+            assert(node);
+            Node<K,V> * left = rqProvider->read_addr(partTid, &node->left);
+            if (left != NULL) {
+                if (node->key != this->NO_KEY && !cmp(hi, node->key)) {
+                    Node<K,V> * right = rqProvider->read_addr(partTid, &node->right);
+                    assert(right);
+                    stack.push(right);
+                }
+                if (node->key == this->NO_KEY || cmp(lo, node->key)) {
+                    stack.push(left);
+                }
+            } else {
+                rqProvider->traversal_try_add(partTid, node, keys, values, size, lo, hi);
+            }
+        }
+        if (partTid != tid) {
+            recmgr->enterQuiescentState(partTid);
+        }
+    };
+    int size = 0;
+    helpers->run(numParts, resultKeys, resultValues, &size, traversePart);
+    for (int i=0;i<helpers->getNumHelpers();++i) {
+        rqProvider->traversal_merge(tid, helpers->getHelperKeys(i), helpers->getHelperValues(i), helpers->getHelperSize(i), resultKeys, resultValues, &size);
+    }
+    rqProvider->traversal_end(tid, resultKeys, resultValues, &size, lo, hi);
+    recmgr->enterQuiescentState(tid);
+    return size;
+}
+
 template<class K, class V, class Compare, class RecManager>
 const pair<V,bool> bst_ns::bst<K,V,Compare,RecManager>::find(const int tid, const K& key) {
     pair<V,bool> result;
@@ -166,50 +320,52 @@ const pair<V,bool> bst_ns::bst<K,V,Compare,RecManager>::find(const int tid, cons
 //}
 
 template<class K, class V, class Compare, class RecManager>
-const V bst_ns::bst<K,V,Compare,RecManager>::doInsert(const int tid, const K& key, const V& val, bool onlyIfAbsent) {
-    V result = NO_VALUE;
+bool bst_ns::bst<K,V,Compare,RecManager>::updateOnce(const int tid, const int op, const K& key, const V& val, V * const result) {
+    const bool onlyIfAbsent = (op == ELIMINATION_OP_INSERT_IF_ABSENT);
     void *input[] = {(void*) &key, (void*) &val, (void*) &onlyIfAbsent};
-    void *output[] = {(void*) &result};
+    void *output[] = {(void*) result};
 
     ReclamationInfo<K,V> info;
-    bool finished = 0;
-    for (;;) {
-        recmgr->leaveQuiescentState(tid);
-        finished = updateInsert_search_llx_scx(&info, tid, input, output);
-        recmgr->enterQuiescentState(tid);
-        if (finished) {
-            break;
-        }
-    }
+    recmgr->leaveQuiescentState(tid);
+    const bool finished = (op == ELIMINATION_OP_ERASE)
+            ? updateErase_search_llx_scx(&info, tid, input, output)
+            : updateInsert_search_llx_scx(&info, tid, input, output);
+    recmgr->enterQuiescentState(tid);
+    return finished;
+}
+
+// returns the value associated with key just before the update (or NO_VALUE)
+template<class K, class V, class Compare, class RecManager>
+V bst_ns::bst<K,V,Compare,RecManager>::update(const int tid, const int op, const K& key, const V& val) {
+    V result = NO_VALUE;
+    if (updateOnce(tid, op, key, val, &result)) return result;
+#ifdef BST_ELIMINATION
+    // the first attempt failed, so key is probably contended
+    auto apply = [this, tid](const int op, const K& key, const V& val) {
+        V result = NO_VALUE;
+        while (!updateOnce(tid, op, key, val, &result)) {}
+        return result;
+    };
+    return elimination->combine(tid, op, key, val, apply);
+#else
+    while (!updateOnce(tid, op, key, val, &result)) {}
     return result;
+#endif
 }
 
 template<class K, class V, class Compare, class RecManager>
 const V bst_ns::bst<K,V,Compare,RecManager>::insertIfAbsent(const int tid, const K& key, const V& val) {
-    return doInsert(tid, key, val, true);
+    return update(tid, ELIMINATION_OP_INSERT_IF_ABSENT, key, val);
 }
 
 template<class K, class V, class Compare, class RecManager>
 const V bst_ns::bst<K,V,Compare,RecManager>::insert(const int tid, const K& key, const V& val) {
-    return doInsert(tid, key, val, false);
+    return update(tid, ELIMINATION_OP_INSERT, key, val);
 }
 
 template<class K, class V, class Compare, class RecManager>
 const pair<V,bool> bst_ns::bst<K,V,Compare,RecManager>::erase(const int tid, const K& key) {
-    V result = NO_VALUE;
-    void *input[] = {(void*) &key};
-    void *output[] = {(void*) &result};
-    
-    ReclamationInfo<K,V> info;
-    bool finished = 0;
-    for (;;) {
-        recmgr->leaveQuiescentState(tid);
-        finished = updateErase_search_llx_scx(&info, tid, input, output);
-        recmgr->enterQuiescentState(tid);
-        if (finished) {
-            break;
-        }
-    }
+    const V result = update(tid, ELIMINATION_OP_ERASE, key, NO_VALUE);
     return pair<V,bool>(result, (result != NO_VALUE));
 }
 
@@ -237,6 +393,14 @@ inline bool bst_ns::bst<K,V,Compare,RecManager>::updateInsert_search_llx_scx(
             }
         }
     }
+    return updateInsert_llx_scx(info, tid, p, l, key, val, onlyIfAbsent, result);
+}
+
+// performs the llx/scx part of an insertion, given the leaf l reached by a
+// search for key, and its parent p.
+template<class K, class V, class Compare, class RecManager>
+inline bool bst_ns::bst<K,V,Compare,RecManager>::updateInsert_llx_scx(
+            ReclamationInfo<K,V> * const info, const int tid, Node<K,V> * const p, Node<K,V> * const l, const K& key, const V& val, const bool onlyIfAbsent, V * const result) {
     // if we find the key in the tree already
     if (key == l->key) {
         if (onlyIfAbsent) {
@@ -332,6 +496,14 @@ inline bool bst_ns::bst<K,V,Compare,RecManager>::updateErase_search_llx_scx(
             l = rqProvider->read_addr(tid, &p->right);
         }
     }
+    return updateErase_llx_scx(info, tid, gp, p, l, key, result);
+}
+
+// performs the llx/scx part of a deletion, given the leaf l reached by a
+// search for key, its parent p and its grandparent gp.
+template<class K, class V, class Compare, class RecManager>
+inline bool bst_ns::bst<K,V,Compare,RecManager>::updateErase_llx_scx(
+            ReclamationInfo<K,V> * const info, const int tid, Node<K,V> * const gp, Node<K,V> * const p, Node<K,V> * const l, const K& key, V * const result) {
     // if we fail to find the key in the tree
     if (key != l->key) {
         *result = NO_VALUE;
@@ -368,6 +540,104 @@ inline bool bst_ns::bst<K,V,Compare,RecManager>::updateErase_search_llx_scx(
     }
 }
 
+// finds the leaf that key belongs in, starting from the deepest node in
+// finger that has not been removed from the tree and whose subtree can contain
+// key, and leaves the internal nodes on the path to that leaf in finger.
+// this is only correct if keys are searched for in non-decreasing order, and
+// the caller stays in a non-quiescent state while it uses finger.
+// (a node's key range can only grow while it is in the tree, so an upper bound
+// observed earlier remains safe to use.)
+template<class K, class V, class Compare, class RecManager>
+inline bst_ns::Node<K,V>* bst_ns::bst<K,V,Compare,RecManager>::fingerSearch(const int tid, vector<FingerEntry<K,V> >& finger, const K& key) {
+    while (finger.size() > 1) { // note: the root is never removed
+        FingerEntry<K,V>& e = finger.back();
+        if (!e.node->marked && (e.upper == NO_KEY || cmp(key, e.upper))) break;
+        finger.pop_back();
+    }
+    if (finger.empty()) {
+        finger.push_back(FingerEntry<K,V>(root, NO_KEY));
+    }
+    Node<K,V> *p = finger.back().node;
+    K upper = finger.back().upper;
+    Node<K,V> *l;
+    // note: every key is less than NO_KEY, so searches go left at sentinels
+    if (p->key == NO_KEY || cmp(key, p->key)) {
+        if (p->key != NO_KEY) upper = p->key;
+        l = rqProvider->read_addr(tid, &p->left);
+    } else {
+        l = rqProvider->read_addr(tid, &p->right);
+    }
+    while (rqProvider->read_addr(tid, &l->left) != NULL) {
+        finger.push_back(FingerEntry<K,V>(l, upper));
+        p = l;
+        if (p->key == NO_KEY || cmp(key, p->key)) {
+            if (p->key != NO_KEY) upper = p->key;
+            l = rqProvider->read_addr(tid, &p->left);
+        } else {
+            l = rqProvider->read_addr(tid, &p->right);
+        }
+    }
+    return l;
+}
+
+template<class K, class V, class Compare, class RecManager>
+int bst_ns::bst<K,V,Compare,RecManager>::doInsertBatch(const int tid, K * const keys, V * const values, const int n, V * const results, bool onlyIfAbsent) {
+    vector<pair<K,V> > items (n);
+    for (int i=0;i<n;++i) items[i] = pair<K,V>(keys[i], values[i]);
+    Compare c = cmp;
+    std::sort(items.begin(), items.end(), [c](const pair<K,V>& a, const pair<K,V>& b) { return c(a.first, b.first); });
+    for (int i=0;i<n;++i) { keys[i] = items[i].first; values[i] = items[i].second; }
+
+    vector<FingerEntry<K,V> > finger;
+    ReclamationInfo<K,V> info;
+    int numInserted = 0;
+    recmgr->leaveQuiescentState(tid);
+    for (int i=0;i<n;++i) {
+        V result = NO_VALUE;
+        for (;;) {
+            Node<K,V> *l = fingerSearch(tid, finger, keys[i]);
+            if (updateInsert_llx_scx(&info, tid, finger.back().node, l, keys[i], values[i], onlyIfAbsent, &result)) break;
+        }
+        if (results) results[i] = result;
+        if (result == NO_VALUE) ++numInserted;
+    }
+    recmgr->enterQuiescentState(tid);
+    return numInserted;
+}
+
+template<class K, class V, class Compare, class RecManager>
+int bst_ns::bst<K,V,Compare,RecManager>::insertBatch(const int tid, K * const keys, V * const values, const int n, V * const results) {
+    return doInsertBatch(tid, keys, values, n, results, false);
+}
+
+template<class K, class V, class Compare, class RecManager>
+int bst_ns::bst<K,V,Compare,RecManager>::insertIfAbsentBatch(const int tid, K * const keys, V * const values, const int n, V * const results) {
+    return doInsertBatch(tid, keys, values, n, results, true);
+}
+
+template<class K, class V, class Compare, class RecManager>
+int bst_ns::bst<K,V,Compare,RecManager>::eraseBatch(const int tid, K * const keys, const int n, V * const results) {
+    std::sort(keys, keys+n, cmp);
+
+    vector<FingerEntry<K,V> > finger;
+    ReclamationInfo<K,V> info;
+    int numErased = 0;
+    recmgr->leaveQuiescentState(tid);
+    for (int i=0;i<n;++i) {
+        V result = NO_VALUE;
+        for (;;) {
+            Node<K,V> *l = fingerSearch(tid, finger, keys[i]);
+            if (finger.size() < 2) break; // only sentinels in tree...
+            const int depth = finger.size();
+            if (updateErase_llx_scx(&info, tid, finger[depth-2].node, finger[depth-1].node, l, keys[i], &result)) break;
+        }
+        if (results) results[i] = result;
+        if (result != NO_VALUE) ++numErased;
+    }
+    recmgr->enterQuiescentState(tid);
+    return numErased;
+}
+
 template<class K, class V, class Compare, class RecManager>
 bst_ns::Node<K,V>* bst_ns::bst<K,V,Compare,RecManager>::initializeNode(
             const int tid,
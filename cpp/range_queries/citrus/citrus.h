@@ -95,6 +95,10 @@ public:
     const pair<V, bool> erase(const int tid, const K& key);
     const pair<V, bool> find(const int tid, const K& key);
     int rangeQuery(const int tid, const K& lo, const K& hi, K * const resultKeys, V * const resultValues);
+    // streams the keys in [lo, hi] to visitor in increasing order, stopping early if visitor returns false
+    // or after limit keys (see rq_stream.h). returns the number of keys streamed.
+    template <typename Visitor>
+    int rangeQuery(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor);
     bool contains(const int tid, const K& key);
     int size(); // warning: this is a linear time operation, and is not linearizable
 
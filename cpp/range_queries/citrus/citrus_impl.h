@@ -401,6 +401,43 @@ int citrustree<K,V,RecManager>::rangeQuery(const int tid, const K& lo, const K&
     return size;
 }
 
+template <typename K, typename V, class RecManager>
+template <typename Visitor>
+int citrustree<K,V,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor) {
+    block<node_t<K,V> > stack (NULL);
+    recordmgr->leaveQuiescentState(tid, true);
+    rqProvider->traversal_start(tid, limit);
+    
+    // in-order traversal (of interesting subtrees), so keys are visited in
+    // increasing order. a node is pushed once to explore its children, and
+    // once more, with its low order bit set, to visit its key.
+    stack.push(root);
+    while (!stack.isEmpty()) {
+        nodeptr node = stack.pop();
+        if ((uintptr_t) node & 1) {
+            node = (nodeptr) ((uintptr_t) node & ~(uintptr_t) 1);
+            rqProvider->traversal_try_add(tid, node, lo, hi);
+            if (rqProvider->traversal_chunk_full(tid) && !rqProvider->traversal_flush(tid, lo, visitor)) {
+                while (!stack.isEmpty()) stack.pop(); // the visitor is done, so abandon the traversal
+            }
+            continue;
+        }
+        
+        nodeptr left = rqProvider->read_addr(tid, &node->child[0]);
+        nodeptr right = rqProvider->read_addr(tid, &node->child[1]);
+        if (right != NULL && hi > node->key) {
+            stack.push(right);
+        }
+        stack.push((nodeptr) ((uintptr_t) node | 1));
+        if (left != NULL && lo < node->key) {
+            stack.push(left);
+        }
+    }
+    int size = rqProvider->traversal_end(tid, lo, hi, visitor);
+    recordmgr->enterQuiescentState(tid);
+    return size;
+}
+
 template <typename K, typename V, class RecManager>
 long long citrustree<K,V,RecManager>::debugKeySum(nodeptr root) {
     if (root == NULL) return 0;
@@ -10,7 +10,119 @@
 #ifndef HASHLIST_H
 #define HASHLIST_H
 
-#ifdef USE_STL_HASHLIST
+// note: USE_OPEN_ADDRESSING_HASHLIST takes precedence over USE_STL_HASHLIST,
+//       which takes precedence over USE_SIMPLIFIED_HASHLIST, so any of them
+//       can be selected on the command line (e.g., make hashlist=STL)
+#if defined USE_OPEN_ADDRESSING_HASHLIST
+    #define HASHLIST_NAME open_addressing
+
+    #include <cstdlib>
+    #include <cstring>
+    #include <cassert>
+    #include "plaf.h"
+    #ifndef BIG_CONSTANT
+        #define BIG_CONSTANT(x) (x##LLU)
+    #endif
+
+    /*
+     * Flat open addressed hash set with linear probing.
+     * Each slot holds an element and the generation in which it was inserted.
+     * A slot is occupied iff its generation is the current generation,
+     * so clear() just starts a new generation, which is O(1) regardless of
+     * how many elements were inserted, and there are no nodes to recycle.
+     * Probes touch consecutive slots, rather than chasing pointers.
+     * The table keeps its capacity across clear(), so a thread's table is
+     * quickly sized for the largest set it is used for.
+     */
+    template <typename T>
+    class HashList {
+    private:
+        struct Slot {
+            T element;
+            unsigned int generation;
+        };
+
+        volatile char padding0[PREFETCH_SIZE_BYTES];
+        Slot * data;
+        long long capacity;         // power of 2
+        long long size;
+        unsigned int generation;    // slots with this generation are occupied
+        volatile char padding1[PREFETCH_SIZE_BYTES];
+
+        inline long long hash(const T& element) {
+            unsigned long long p = (unsigned long long) element;
+            p ^= p >> 33;
+            p *= BIG_CONSTANT(0xff51afd7ed558ccd);
+            p ^= p >> 33;
+            p *= BIG_CONSTANT(0xc4ceb9fe1a85ec53);
+            p ^= p >> 33;
+            return p & (capacity - 1);
+        }
+
+        // index of element's slot, or of the empty slot where it belongs
+        inline long long findIx(const T& element) {
+            long long ix = hash(element);
+            while (data[ix].generation == generation && !(data[ix].element == element)) {
+                ix = (ix + 1) & (capacity - 1);
+            }
+            return ix;
+        }
+
+        void expand() {
+            Slot * const oldData = data;
+            const long long oldCapacity = capacity;
+            capacity *= 2;
+            data = (Slot *) malloc(sizeof(Slot) * capacity);
+            memset(data, 0, sizeof(Slot) * capacity);
+            for (long long i=0;i<oldCapacity;++i) {
+                if (oldData[i].generation == generation) {
+                    const long long ix = findIx(oldData[i].element);
+                    data[ix] = oldData[i];
+                }
+            }
+            free(oldData);
+        }
+
+    public:
+        void init(const long long initialCapacityPow2) {
+            assert(__builtin_popcountll(initialCapacityPow2) == 1);
+            capacity = 2 * initialCapacityPow2;
+            size = 0;
+            generation = 1;
+            data = (Slot *) malloc(sizeof(Slot) * capacity);
+            memset(data, 0, sizeof(Slot) * capacity);
+        }
+
+        void destroy() {
+            free(data);
+        }
+
+        inline void clear() {
+            size = 0;
+            if (++generation == 0) {    // wrapped around, so old generations could look current
+                memset(data, 0, sizeof(Slot) * capacity);
+                generation = 1;
+            }
+        }
+
+        inline bool contains(const T& element) {
+            return data[findIx(element)].generation == generation;
+        }
+
+        inline void insert(const T& element) {
+            const long long ix = findIx(element);
+            if (data[ix].generation == generation) return;
+            data[ix].element = element;
+            data[ix].generation = generation;
+            if (2 * (++size) > capacity) expand();
+        }
+
+        inline long long getSize() { return size; }
+    };
+
+#elif defined USE_STL_HASHLIST
+    #define HASHLIST_NAME stl
+
     #include <unordered_set>
     using namespace std;
 
@@ -47,6 +159,7 @@
     };
 
 #elif defined USE_SIMPLIFIED_HASHLIST
+    #define HASHLIST_NAME simplified
 
     #include "plaf.h"
     #ifndef BIG_CONSTANT
@@ -280,6 +393,7 @@
     };
 
 #else
+    #define HASHLIST_NAME tl2
 
     #define HASHTABLE_CLEAR_FROM_LIST
     #define USE_FULL_HASHTABLE
@@ -698,7 +812,7 @@
         }
     };
 
-#endif // #if !defined USE_STL_HASHLIST
+#endif // #if defined USE_OPEN_ADDRESSING_HASHLIST
 
 #endif /* HASHLIST_H */
 
@@ -0,0 +1,133 @@
+/*
+ * File:   list_index.h
+ *
+ * Sparse, lazily maintained index over a sorted linked list (lazylist, lflist).
+ * The key range [0, keyRange) is divided into segments of 2^LIST_INDEX_SEGMENT_BITS
+ * keys, and each segment has a slot that holds a hint: some node of the list
+ * whose key is in the segment (preferably the smallest). Searches, updates and
+ * range queries for a key k start from a hint with key < k in k's segment (or
+ * one of the preceding segments) instead of from the head of the list.
+ * Updates install the nodes they insert (and the predecessors they find)
+ * as hints, so the index fills in as the list is built.
+ *
+ * Hints are only accessed between leaveQuiescentState and enterQuiescentState,
+ * and a node is never retired while a slot points to it, so the index is safe
+ * to use with epoch based reclamation:
+ *  - a node is installed by first storing it in its slot with the PENDING bit
+ *    set, then checking that it is not marked, and only then clearing the bit
+ *    (entries with the PENDING bit are ignored by searches).
+ *  - the thread that retires a node calls clear (after the node is marked,
+ *    and before it is retired), which removes the node from its slot,
+ *    whether or not it is pending.
+ * So, once a node is cleared, it can never appear in a slot without the
+ * PENDING bit: an installer that stores it afterwards sees the mark and
+ * removes it again.
+ *
+ * The index never changes the list, so the RQProvider hooks are unaffected.
+ * A hint that is not marked when it is read is in the list at that time,
+ * so a traversal that starts from it is equivalent to a traversal from
+ * the head that reached it at that time.
+ */
+
+#ifndef LIST_INDEX_H
+#define LIST_INDEX_H
+
+#include <stdint.h>
+#include "plaf.h"
+
+// number of keys per segment is 2^LIST_INDEX_SEGMENT_BITS
+#ifndef LIST_INDEX_SEGMENT_BITS
+    #define LIST_INDEX_SEGMENT_BITS 5
+#endif
+
+// number of slots a search examines before it gives up and starts from the head
+#ifndef LIST_INDEX_MAX_PROBES
+    #define LIST_INDEX_MAX_PROBES 8
+#endif
+
+#define LIST_INDEX_PENDING 0x1
+
+template <typename K, typename NodeT>
+class list_index {
+private:
+    volatile char padding0[PREFETCH_SIZE_BYTES];
+    const long long numSlots;
+    uintptr_t volatile * const slots;
+    volatile char padding1[PREFETCH_SIZE_BYTES];
+
+    inline long long segmentOf(const K& key) {
+        if (key < 0) return -1;
+        long long seg = ((long long) key) >> LIST_INDEX_SEGMENT_BITS;
+        return (seg < numSlots) ? seg : numSlots-1;
+    }
+
+public:
+    list_index(const K keyRange)
+            : numSlots((((long long) keyRange) >> LIST_INDEX_SEGMENT_BITS) + 1)
+            , slots(new uintptr_t volatile[numSlots]) {
+        for (long long i=0;i<numSlots;++i) {
+            slots[i] = 0;
+        }
+    }
+    ~list_index() {
+        delete[] slots;
+    }
+
+    /**
+     * Returns an unmarked node with key < key that was in the list at some
+     * point during this call, or NULL if no suitable hint was found (in which
+     * case the caller should start from the head).
+     */
+    template <typename RQProvider>
+    inline NodeT * find(const int tid, const K& key, RQProvider * const prov) {
+        long long seg = segmentOf(key);
+        for (int i=0; i<LIST_INDEX_MAX_PROBES && seg >= 0; ++i, --seg) {
+            uintptr_t word = slots[seg];
+            if (word == 0 || (word & LIST_INDEX_PENDING)) continue;
+            NodeT * node = (NodeT *) word;
+            if (node->key < key && !node->isMarked(tid, prov)) return node;
+        }
+        return NULL;
+    }
+
+    /**
+     * Tries to make node the hint for its segment.
+     * node must be protected by the caller, and should be in the list.
+     */
+    template <typename RQProvider>
+    inline void install(const int tid, NodeT * const node, RQProvider * const prov) {
+        const long long seg = segmentOf(node->key);
+        if (seg < 0) return;
+        uintptr_t word = slots[seg];
+        if (word & LIST_INDEX_PENDING) return;
+        if (word) {
+            NodeT * curr = (NodeT *) word;
+            if (curr == node) return;
+            // keep the smaller key, unless the current hint is deleted
+            if (curr->key <= node->key && !curr->isMarked(tid, prov)) return;
+        }
+        const uintptr_t pending = ((uintptr_t) node) | LIST_INDEX_PENDING;
+        if (!__sync_bool_compare_and_swap(&slots[seg], word, pending)) return;
+        if (node->isMarked(tid, prov)) {
+            __sync_bool_compare_and_swap(&slots[seg], pending, (uintptr_t) 0);
+        } else {
+            __sync_bool_compare_and_swap(&slots[seg], pending, (uintptr_t) node);
+        }
+    }
+
+    /**
+     * Removes node from the index.
+     * Must be called after node is marked, and before it is retired.
+     */
+    inline void clear(NodeT * const node) {
+        const long long seg = segmentOf(node->key);
+        if (seg < 0) return;
+        while (true) {
+            uintptr_t word = slots[seg];
+            if ((word & ~((uintptr_t) LIST_INDEX_PENDING)) != (uintptr_t) node) return;
+            if (__sync_bool_compare_and_swap(&slots[seg], word, (uintptr_t) 0)) return;
+        }
+    }
+};
+
+#endif /* LIST_INDEX_H */
@@ -22,5 +22,14 @@
 #define PREFETCH_SIZE_BYTES 192
 #define BYTES_IN_CACHE_LINE 64
 
+// libnuma is used (by pool_numa.h and allocator_bump.h) if its header is
+// available, unless NO_LIBNUMA is defined. without it, all threads are
+// treated as if they run on NUMA node 0.
+#if !defined(NO_LIBNUMA) && defined(__has_include)
+    #if __has_include(<numa.h>)
+        #define HAS_LIBNUMA
+    #endif
+#endif
+
 #endif	/* MACHINECONSTANTS_H */
 
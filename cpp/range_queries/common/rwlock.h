@@ -169,6 +169,146 @@ public:
     }
 };
 
+#elif defined RWLOCK_BRAVO
+
+/**
+ * BRAVO-style reader-writer lock (Dice and Kogan, USENIX ATC 2019).
+ * Readers (here, the updates of the data structure) normally announce
+ * themselves by CASing a private, padded slot in a table of visible readers,
+ * instead of incrementing a shared counter, so concurrent readers do not
+ * bounce a cache line between cores and sockets. If the reader bias is off,
+ * or the reader's slot is taken (more threads than slots), the reader falls
+ * back to an underlying lock with a shared reader count (favoring writers).
+ *
+ * A writer (here, a range query) acquires the underlying lock, then revokes
+ * the reader bias and waits until every slot is empty. Since revocation is
+ * expensive, the bias is only re-enabled (by a slow-path reader) after
+ * RWLOCK_BRAVO_INHIBIT_MULTIPLIER times as long as the revocation took.
+ */
+
+#include <chrono>
+
+#ifndef SOFTWARE_BARRIER
+#define SOFTWARE_BARRIER asm volatile("": : :"memory")
+#endif
+
+#ifndef RWLOCK_BRAVO_SLOTS
+    #define RWLOCK_BRAVO_SLOTS MAX_TID_POW2
+#endif
+#ifndef RWLOCK_BRAVO_INHIBIT_MULTIPLIER
+    #define RWLOCK_BRAVO_INHIBIT_MULTIPLIER 9
+#endif
+
+// the slot of this thread, assigned on its first read-lock, and the slot it
+// currently holds (or -1 if it holds the underlying lock) in the lock it last
+// read-locked (a thread never holds more than one read-lock at a time)
+static __thread int rwlockBravoSlot = -1;
+static __thread int rwlockBravoHeldSlot = -1;
+static volatile int rwlockBravoNextSlot = 0;
+
+class RWLock {
+private:
+    struct slot_t {
+        volatile long long v;
+        volatile char padding[PREFETCH_SIZE_BYTES-sizeof(long long)];
+    };
+    
+    volatile char padding0[PREFETCH_SIZE_BYTES];
+    volatile long long lock; // two bit fields: [ number of readers ] [ writer bit ]
+    volatile bool rbias;
+    volatile long long inhibitUntil; // nanoseconds
+    volatile char padding1[PREFETCH_SIZE_BYTES];
+    slot_t slots[RWLOCK_BRAVO_SLOTS];
+    
+    static inline long long now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    inline int mySlot() {
+        if (rwlockBravoSlot < 0) {
+            rwlockBravoSlot = __sync_fetch_and_add(&rwlockBravoNextSlot, 1) % RWLOCK_BRAVO_SLOTS;
+        }
+        return rwlockBravoSlot;
+    }
+    
+public:
+    RWLock() {
+        lock = 0;
+        rbias = true;
+        inhibitUntil = 0;
+        for (int i=0;i<RWLOCK_BRAVO_SLOTS;++i) {
+            slots[i].v = 0;
+        }
+    }
+    inline bool isWriteLocked() {
+        return lock & 1;
+    }
+    inline bool isReadLocked() {
+        if (lock & ~1) return true;
+        for (int i=0;i<RWLOCK_BRAVO_SLOTS;++i) {
+            if (slots[i].v) return true;
+        }
+        return false;
+    }
+    inline bool isLocked() {
+        return isWriteLocked() || isReadLocked();
+    }
+    inline void readLock() {
+        if (rbias) {
+            const int s = mySlot();
+            if (__sync_bool_compare_and_swap(&slots[s].v, 0, 1)) { // implies fence (on x86/64)
+                if (rbias) {
+                    rwlockBravoHeldSlot = s;
+                    return;
+                }
+                slots[s].v = 0; // a writer revoked the bias; use the underlying lock
+            }
+        }
+        while (1) {
+            while (isWriteLocked()) {}
+            if ((__sync_add_and_fetch(&lock, 2) & 1) == 0) break; // when we tentatively read-locked, there was no writer
+            __sync_add_and_fetch(&lock, -2); // release our tentative read-lock
+        }
+        rwlockBravoHeldSlot = -1;
+        // no writer holds the lock, so it is safe to re-enable the bias
+        if (!rbias && now() >= inhibitUntil) {
+            rbias = true;
+        }
+    }
+    inline void readUnlock() {
+        if (rwlockBravoHeldSlot >= 0) {
+            SOFTWARE_BARRIER;
+            slots[rwlockBravoHeldSlot].v = 0;
+        } else {
+            __sync_add_and_fetch(&lock, -2);
+        }
+    }
+    inline void writeLock() {
+        while (1) {
+            long long v = lock;
+            if (__sync_bool_compare_and_swap(&lock, v & ~1, v | 1)) {
+                while (v & ~1) { // while there are still readers
+                    v = lock;
+                }
+                break;
+            }
+        }
+        if (rbias) {
+            rbias = false;
+            __sync_synchronize();
+            const long long start = now();
+            for (int i=0;i<RWLOCK_BRAVO_SLOTS;++i) {
+                while (slots[i].v) {}
+            }
+            const long long end = now();
+            inhibitUntil = end + (end - start) * RWLOCK_BRAVO_INHIBIT_MULTIPLIER;
+        }
+    }
+    inline void writeUnlock() {
+        __sync_add_and_fetch(&lock, -1);
+    }
+};
+
 #else
 #error Must specify RWLOCK implementation; see rwlock.h
 #endif
@@ -0,0 +1,150 @@
+/*
+ * File:   simd_search.h
+ *
+ * Searches of the keys of a B-tree node with SIMD comparisons.
+ * Each function compares a node's keys against the search key a whole vector
+ * at a time, and finds the first lane that satisfies the predicate with a
+ * bit scan of the comparison mask, which has the same result as the scalar
+ * loop it replaces (whether or not the keys are sorted).
+ *
+ * SIMD searches are used when K is a 32 or 64 bit signed integer, Compare is
+ * std::less<K>, and the code is compiled with AVX2 or SSE4.2 enabled
+ * (e.g., -mavx2 or -msse4.2). In every other case, simd_search<K,Compare>::enabled
+ * is false, and callers should use their scalar loops.
+ *
+ * keys must point to an array of CAPACITY keys (of which the first n are
+ * examined). Vectors are never loaded from beyond the end of the array.
+ *
+ * 3path_htm/common/ and range_queries/common/ have identical copies of this
+ * file (each project is built on its own). Change them together.
+ */
+
+#ifndef SIMD_SEARCH_H
+#define SIMD_SEARCH_H
+
+#include <functional>
+
+#if defined __AVX2__
+    #include <immintrin.h>
+    #define SIMD_SEARCH_SUPPORTED
+    #define SIMD_SEARCH_BYTES 32
+    typedef __m256i simd_search_vec_t;
+    #define SIMD_SEARCH_LOAD(p) _mm256_loadu_si256((const __m256i *) (p))
+    #define SIMD_SEARCH_SET1_32(x) _mm256_set1_epi32((x))
+    #define SIMD_SEARCH_SET1_64(x) _mm256_set1_epi64x((x))
+    #define SIMD_SEARCH_CMPGT_32(a, b) _mm256_cmpgt_epi32((a), (b))
+    #define SIMD_SEARCH_CMPGT_64(a, b) _mm256_cmpgt_epi64((a), (b))
+    #define SIMD_SEARCH_CMPEQ_32(a, b) _mm256_cmpeq_epi32((a), (b))
+    #define SIMD_SEARCH_CMPEQ_64(a, b) _mm256_cmpeq_epi64((a), (b))
+    #define SIMD_SEARCH_MOVEMASK_32(a) _mm256_movemask_ps(_mm256_castsi256_ps((a)))
+    #define SIMD_SEARCH_MOVEMASK_64(a) _mm256_movemask_pd(_mm256_castsi256_pd((a)))
+#elif defined __SSE4_2__
+    #include <nmmintrin.h>
+    #define SIMD_SEARCH_SUPPORTED
+    #define SIMD_SEARCH_BYTES 16
+    typedef __m128i simd_search_vec_t;
+    #define SIMD_SEARCH_LOAD(p) _mm_loadu_si128((const __m128i *) (p))
+    #define SIMD_SEARCH_SET1_32(x) _mm_set1_epi32((x))
+    #define SIMD_SEARCH_SET1_64(x) _mm_set1_epi64x((x))
+    #define SIMD_SEARCH_CMPGT_32(a, b) _mm_cmpgt_epi32((a), (b))
+    #define SIMD_SEARCH_CMPGT_64(a, b) _mm_cmpgt_epi64((a), (b))
+    #define SIMD_SEARCH_CMPEQ_32(a, b) _mm_cmpeq_epi32((a), (b))
+    #define SIMD_SEARCH_CMPEQ_64(a, b) _mm_cmpeq_epi64((a), (b))
+    #define SIMD_SEARCH_MOVEMASK_32(a) _mm_movemask_ps(_mm_castsi128_ps((a)))
+    #define SIMD_SEARCH_MOVEMASK_64(a) _mm_movemask_pd(_mm_castsi128_pd((a)))
+#endif
+
+// keys and comparators that cannot be searched with SIMD instructions
+// (these functions only exist so callers compile; they are never invoked)
+template <typename K, class Compare>
+struct simd_search {
+    static const bool enabled = false;
+    template <int CAPACITY>
+    static inline int findFirstGreater(const K * const keys, const int n, const K& key) { return n; }
+    template <int CAPACITY>
+    static inline int findFirstGreaterOrEqual(const K * const keys, const int n, const K& key) { return n; }
+    template <int CAPACITY>
+    static inline int findEqual(const K * const keys, const int n, const K& key) { return n; }
+};
+
+#ifdef SIMD_SEARCH_SUPPORTED
+
+// comparisons of vectors of 4 and 8 byte signed integers
+template <int BYTES>
+struct simd_search_ops {};
+
+template <>
+struct simd_search_ops<4> {
+    static const int LANES = SIMD_SEARCH_BYTES / 4;
+    template <typename K>
+    static inline simd_search_vec_t set1(const K& x) { return SIMD_SEARCH_SET1_32(x); }
+    static inline int gt(const simd_search_vec_t a, const simd_search_vec_t b) { return SIMD_SEARCH_MOVEMASK_32(SIMD_SEARCH_CMPGT_32(a, b)); }
+    static inline int eq(const simd_search_vec_t a, const simd_search_vec_t b) { return SIMD_SEARCH_MOVEMASK_32(SIMD_SEARCH_CMPEQ_32(a, b)); }
+};
+
+template <>
+struct simd_search_ops<8> {
+    static const int LANES = SIMD_SEARCH_BYTES / 8;
+    template <typename K>
+    static inline simd_search_vec_t set1(const K& x) { return SIMD_SEARCH_SET1_64(x); }
+    static inline int gt(const simd_search_vec_t a, const simd_search_vec_t b) { return SIMD_SEARCH_MOVEMASK_64(SIMD_SEARCH_CMPGT_64(a, b)); }
+    static inline int eq(const simd_search_vec_t a, const simd_search_vec_t b) { return SIMD_SEARCH_MOVEMASK_64(SIMD_SEARCH_CMPEQ_64(a, b)); }
+};
+
+template <typename K>
+struct simd_search_integer {
+    static const bool enabled = true;
+    typedef simd_search_ops<sizeof(K)> ops;
+
+    // lanes [0, r) of a vector hold keys that should be examined
+    static inline int validLanes(const int r) {
+        return (r >= ops::LANES) ? (1<<ops::LANES)-1 : (1<<r)-1;
+    }
+
+    // index of the first key in keys[0, n) that is > key, or n if there is none
+    template <int CAPACITY>
+    static inline int findFirstGreater(const K * const keys, const int n, const K& key) {
+        const simd_search_vec_t k = ops::set1(key);
+        int i = 0;
+        for (; i < n && i+ops::LANES <= CAPACITY; i += ops::LANES) {
+            const int mask = ops::gt(SIMD_SEARCH_LOAD(keys+i), k) & validLanes(n-i);
+            if (mask) return i + __builtin_ctz(mask);
+        }
+        for (; i < n; ++i) if (key < keys[i]) return i;
+        return n;
+    }
+
+    // index of the first key in keys[0, n) that is >= key, or n if there is none
+    template <int CAPACITY>
+    static inline int findFirstGreaterOrEqual(const K * const keys, const int n, const K& key) {
+        const simd_search_vec_t k = ops::set1(key);
+        int i = 0;
+        for (; i < n && i+ops::LANES <= CAPACITY; i += ops::LANES) {
+            const int mask = ~ops::gt(k, SIMD_SEARCH_LOAD(keys+i)) & validLanes(n-i);
+            if (mask) return i + __builtin_ctz(mask);
+        }
+        for (; i < n; ++i) if (!(keys[i] < key)) return i;
+        return n;
+    }
+
+    // index of the first key in keys[0, n) that is == key, or n if there is none
+    template <int CAPACITY>
+    static inline int findEqual(const K * const keys, const int n, const K& key) {
+        const simd_search_vec_t k = ops::set1(key);
+        int i = 0;
+        for (; i < n && i+ops::LANES <= CAPACITY; i += ops::LANES) {
+            const int mask = ops::eq(SIMD_SEARCH_LOAD(keys+i), k) & validLanes(n-i);
+            if (mask) return i + __builtin_ctz(mask);
+        }
+        for (; i < n; ++i) if (keys[i] == key) return i;
+        return n;
+    }
+};
+
+template <> struct simd_search<int, std::less<int> > : simd_search_integer<int> {};
+template <> struct simd_search<long, std::less<long> > : simd_search_integer<long> {};
+template <> struct simd_search<long long, std::less<long long> > : simd_search_integer<long long> {};
+
+#endif /* SIMD_SEARCH_SUPPORTED */
+
+#endif /* SIMD_SEARCH_H */
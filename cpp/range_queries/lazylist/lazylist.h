@@ -13,6 +13,9 @@
     #define MAX_NODES_INSERTED_OR_DELETED_ATOMICALLY 4
 #endif
 #include "rq_provider.h"
+#ifdef USE_LIST_INDEX
+    #include "list_index.h"
+#endif
 #include "lazylist_impl.h"
 
 template <typename K, typename V>
@@ -28,6 +31,12 @@ private:
     debugCounters * const counters;
 #endif
     nodeptr head;
+#ifdef USE_LIST_INDEX
+    list_index<K, node_t<K,V> > * const index;
+#endif
+
+    // returns the node from which a search for key should start (head, or a hint with a smaller key)
+    inline nodeptr searchStart(const int tid, const K& key);
 
     int validateLinks(const int tid, nodeptr pred, nodeptr curr);
     nodeptr new_node(const int tid, const K& key, const V& val, nodeptr next);
@@ -41,7 +50,12 @@ public:
     const K KEY_MIN;
     const K KEY_MAX;
     const V NO_VALUE;
+#ifdef USE_LIST_INDEX
+    // the index covers keys in [0, indexKeyRange) (see list_index.h)
+    lazylist(int numProcesses, const K _KEY_MIN, const K _KEY_MAX, const V NO_VALUE, const K indexKeyRange);
+#else
     lazylist(int numProcesses, const K _KEY_MIN, const K _KEY_MAX, const V NO_VALUE);
+#endif
     ~lazylist();
     bool contains(const int tid, const K& key);
     V insert(const int tid, const K& key, const V& value) {
@@ -52,6 +66,10 @@ public:
     }
     V erase(const int tid, const K& key);
     int rangeQuery(const int tid, const K& lo, const K& hi, K * const resultKeys, V * const resultValues);
+    // streams the keys in [lo, hi] to visitor in increasing order, stopping early if visitor returns false
+    // or after limit keys (see rq_stream.h). returns the number of keys streamed.
+    template <typename Visitor>
+    int rangeQuery(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor);
     
     /**
      * This function must be called once by each thread that will
@@ -40,11 +40,18 @@ public:
 };
 
 template <typename K, typename V, class RecManager>
+#ifdef USE_LIST_INDEX
+lazylist<K,V,RecManager>::lazylist(const int numProcesses, const K _KEY_MIN, const K _KEY_MAX, const V _NO_VALUE, const K indexKeyRange)
+#else
 lazylist<K,V,RecManager>::lazylist(const int numProcesses, const K _KEY_MIN, const K _KEY_MAX, const V _NO_VALUE)
+#endif
         : recordmgr(new RecManager(numProcesses, SIGQUIT))
         , rqProvider(new RQProvider<K, V, node_t<K,V>, lazylist<K,V,RecManager>, RecManager, true, false>(numProcesses, this, recordmgr))
 #ifdef USE_DEBUGCOUNTERS
         , counters(new debugCounters(numProcesses))
+#endif
+#ifdef USE_LIST_INDEX
+        , index(new list_index<K, node_t<K,V> >(indexKeyRange))
 #endif
         , KEY_MIN(_KEY_MIN)
         , KEY_MAX(_KEY_MAX)
@@ -65,6 +72,9 @@ lazylist<K,V,RecManager>::~lazylist() {
         curr = next;
     }
     recordmgr->deallocate(dummyTid, curr);
+#ifdef USE_LIST_INDEX
+    delete index;
+#endif
     delete rqProvider;
     delete recordmgr;
 #ifdef USE_DEBUGCOUNTERS
@@ -107,6 +117,15 @@ nodeptr lazylist<K,V,RecManager>::new_node(const int tid, const K& key, const V&
     return nnode;
 }
 
+template <typename K, typename V, class RecManager>
+inline nodeptr lazylist<K,V,RecManager>::searchStart(const int tid, const K& key) {
+#ifdef USE_LIST_INDEX
+    nodeptr hint = index->find(tid, key, rqProvider);
+    if (hint) return hint;
+#endif
+    return head;
+}
+
 template <typename K, typename V, class RecManager>
 inline int lazylist<K,V,RecManager>::validateLinks(const int tid, nodeptr pred, nodeptr curr) {
     return (!rqProvider->read_addr(tid, &pred->marked)
@@ -117,7 +136,7 @@ inline int lazylist<K,V,RecManager>::validateLinks(const int tid, nodeptr pred,
 template <typename K, typename V, class RecManager>
 bool lazylist<K,V,RecManager>::contains(const int tid, const K& key) {
     recordmgr->leaveQuiescentState(tid, true);
-    nodeptr curr = head;
+    nodeptr curr = searchStart(tid, key);
     while (curr->key < key) {
         curr = rqProvider->read_addr(tid, &curr->next);
     }
@@ -138,7 +157,7 @@ V lazylist<K,V,RecManager>::doInsert(const int tid, const K& key, const V& val,
     V result;
     while (true) {
         recordmgr->leaveQuiescentState(tid);
-        pred = head;
+        pred = searchStart(tid, key);
         curr = rqProvider->read_addr(tid, &pred->next);
         while (curr->key < key) {
             pred = curr;
@@ -177,6 +196,9 @@ V lazylist<K,V,RecManager>::doInsert(const int tid, const K& key, const V& val,
             nodeptr insertedNodes[] = {newnode, NULL};
             nodeptr deletedNodes[] = {NULL};
             rqProvider->linearize_update_at_write(tid, &pred->next, newnode, insertedNodes, deletedNodes);
+#ifdef USE_LIST_INDEX
+            index->install(tid, newnode, rqProvider);
+#endif
             releaseLock(&(pred->lock));
             return result;
         }
@@ -196,7 +218,7 @@ V lazylist<K,V,RecManager>::erase(const int tid, const K& key) {
     V result;
     while (true) {
         recordmgr->leaveQuiescentState(tid);
-        pred = head;
+        pred = searchStart(tid, key);
         curr = rqProvider->read_addr(tid, &pred->next);
         while (curr->key < key) {
             pred = curr;
@@ -220,10 +242,16 @@ V lazylist<K,V,RecManager>::erase(const int tid, const K& key) {
             nodeptr insertedNodes[] = {NULL};
             nodeptr deletedNodes[] = {curr, NULL};
             rqProvider->linearize_update_at_write(tid, &curr->marked, 1LL, insertedNodes, deletedNodes);
+#ifdef USE_LIST_INDEX
+            index->clear(curr); // before curr is retired
+#endif
 
             rqProvider->announce_physical_deletion(tid, deletedNodes);
             rqProvider->write_addr(tid, &pred->next, c_nxt);
             rqProvider->physical_deletion_succeeded(tid, deletedNodes);
+#ifdef USE_LIST_INDEX
+            if (pred != head) index->install(tid, pred, rqProvider);
+#endif
 
             releaseLock(&(curr->lock));
             releaseLock(&(pred->lock));
@@ -241,7 +269,7 @@ int lazylist<K,V,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi
     recordmgr->leaveQuiescentState(tid, true);
     rqProvider->traversal_start(tid);
     int cnt = 0;
-    nodeptr curr = rqProvider->read_addr(tid, &head->next);
+    nodeptr curr = rqProvider->read_addr(tid, &searchStart(tid, lo)->next);
     while (curr->key < lo) {
         curr = rqProvider->read_addr(tid, &curr->next);
     }
@@ -255,6 +283,26 @@ int lazylist<K,V,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi
     return cnt;
 }
 
+template <typename K, typename V, class RecManager>
+template <typename Visitor>
+int lazylist<K,V,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor) {
+    recordmgr->leaveQuiescentState(tid, true);
+    rqProvider->traversal_start(tid, limit);
+    nodeptr curr = rqProvider->read_addr(tid, &searchStart(tid, lo)->next);
+    while (curr->key < lo) {
+        curr = rqProvider->read_addr(tid, &curr->next);
+    }
+    while (curr->key <= hi) {
+        __builtin_prefetch(curr->next);
+        rqProvider->traversal_try_add(tid, curr, lo, hi);
+        if (rqProvider->traversal_chunk_full(tid) && !rqProvider->traversal_flush(tid, lo, visitor)) break;
+        curr = rqProvider->read_addr(tid, &curr->next);
+    }
+    int cnt = rqProvider->traversal_end(tid, lo, hi, visitor);
+    recordmgr->enterQuiescentState(tid);
+    return cnt;
+}
+
 template <typename K, typename V, class RecManager>
 long long lazylist<K,V,RecManager>::debugKeySum(nodeptr head) {
     long long result = 0;
@@ -16,6 +16,9 @@
     #define MAX_NODES_INSERTED_OR_DELETED_ATOMICALLY 4
 #endif
 #include "rq_provider.h"
+#ifdef USE_LIST_INDEX
+    #include "list_index.h"
+#endif
 
 template <typename K, typename V>
 class node_t;
@@ -34,6 +37,12 @@ private:
     debugCounters * const counters;
 #endif
     nodeptr head;
+#ifdef USE_LIST_INDEX
+    list_index<K, node_t<K,V> > * index;
+#endif
+
+    // returns the node from which a search for key should start (head, or a hint with a smaller key)
+    inline nodeptr searchStart(const int tid, const K& key);
 
     nodeptr new_node(const int tid, const K& key, const V& val, nodeptr next);
     long long debugKeySum(nodeptr head);
@@ -46,7 +55,12 @@ public:
     const K KEY_MIN;
     const K KEY_MAX;
     const V NO_VALUE;
+#ifdef USE_LIST_INDEX
+    // the index covers keys in [0, indexKeyRange) (see list_index.h)
+    lflist(int numProcesses, const K KEY_MIN, const K KEY_MAX, const V NO_VALUE, const K indexKeyRange);
+#else
     lflist(int numProcesses, const K KEY_MIN, const K KEY_MAX, const V NO_VALUE);
+#endif
     ~lflist();
     bool contains(const int tid, const K& key);
     V insert(const int tid, const K& key, const V& value) {
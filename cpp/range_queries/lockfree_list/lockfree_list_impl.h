@@ -52,7 +52,11 @@ inline nodeptr getMarked(nodeptr val) {
 }
 
 template <typename K, typename V, class RecManager>
+#ifdef USE_LIST_INDEX
+lflist<K,V,RecManager>::lflist(const int numProcesses, const K _KEY_MIN, const K _KEY_MAX, const V _NO_VALUE, const K indexKeyRange)
+#else
 lflist<K,V,RecManager>::lflist(const int numProcesses, const K _KEY_MIN, const K _KEY_MAX, const V _NO_VALUE)
+#endif
         :
 #ifdef USE_DEBUGCOUNTERS
           counters(new debugCounters(numProcesses))
@@ -64,6 +68,9 @@ lflist<K,V,RecManager>::lflist(const int numProcesses, const K _KEY_MIN, const K
         , NO_VALUE(_NO_VALUE)
 {
     rqProvider = new RQProvider<K, V, node_t<K,V>, lflist<K,V,RecManager>, RecManager, true, true>(numProcesses, this, recordmgr);
+#ifdef USE_LIST_INDEX
+    index = new list_index<K, node_t<K,V> >(indexKeyRange);
+#endif
     
     // note: initThread calls rqProvider->initThread
 
@@ -89,6 +96,9 @@ lflist<K,V,RecManager>::~lflist() {
     }
     recordmgr->deallocate(tid,pred);
     recordmgr->deallocate(tid,curr);
+#ifdef USE_LIST_INDEX
+    delete index;
+#endif
     delete rqProvider;
     recordmgr->printStatus();
     delete recordmgr;
@@ -130,11 +140,20 @@ nodeptr lflist<K,V,RecManager>::new_node(const int tid, const K& key, const V& v
     return nnode;
 }
 
+template <typename K, typename V, class RecManager>
+inline nodeptr lflist<K,V,RecManager>::searchStart(const int tid, const K& key) {
+#ifdef USE_LIST_INDEX
+    nodeptr hint = index->find(tid, key, rqProvider);
+    if (hint) return hint;
+#endif
+    return head;
+}
+
 template <typename K, typename V, class RecManager>
 bool lflist<K,V,RecManager>::contains(const int tid, const K& key) {
     bool res; 
     recordmgr->leaveQuiescentState(tid, true);
-    nodeptr curr = rqProvider->read_addr(tid,&head->next);
+    nodeptr curr = getUnmarked(rqProvider->read_addr(tid,&searchStart(tid, key)->next));
     while(curr->key < key){
         curr = (nodeptr) getUnmarked(rqProvider->read_addr(tid, &curr->next)); 
     }
@@ -160,9 +179,10 @@ V lflist<K,V,RecManager>::doInsert(const int tid, const K& key, const V& val, bo
     while(true){
 retry_insert:
         recordmgr->leaveQuiescentState(tid);
-        pred = head;
-        curr = rqProvider->read_addr(tid,&head->next); //head is never marked
-        assert(((casword_t)curr & MARK_BIT) == 0);
+        pred = searchStart(tid, key);
+        // head is never marked, but a hint may have been marked since it was found.
+        // if so, the CASs on pred->next below fail, and we retry.
+        curr = getUnmarked(rqProvider->read_addr(tid,&pred->next));
         while(true){
             nodeptr succ_field = rqProvider->read_addr(tid, &curr->next);
             succ = getUnmarked(succ_field);
@@ -173,6 +193,9 @@ retry_insert:
                 rqProvider->announce_physical_deletion(tid, deletedNodes);
                 assert(curr->isMarked(tid, rqProvider));
                 if(BOOL_CAS(&(pred->next), (casword_t)curr, (casword_t)succ)){
+#ifdef USE_LIST_INDEX
+                    index->clear(curr); // before curr is retired
+#endif
                     rqProvider->physical_deletion_succeeded(tid, deletedNodes);
                     assert(curr->isMarked(tid,rqProvider));
                     assert(getUnmarked(rqProvider->read_addr(tid, &curr->next)) == succ);
@@ -237,6 +260,9 @@ retry_insert:
         nodeptr insertedNodes[] = {node, NULL};
         nodeptr deletedNodes[] = {NULL};
         if(rqProvider->linearize_update_at_cas(tid,&pred->next,curr,node,insertedNodes, deletedNodes) ==  curr){
+#ifdef USE_LIST_INDEX
+            index->install(tid, node, rqProvider);
+#endif
             recordmgr->enterQuiescentState(tid);
             return result;
         } else {
@@ -257,9 +283,10 @@ V lflist<K,V,RecManager>::erase(const int tid, const K& key) {
     while(true){
 retry_erase:
         recordmgr->leaveQuiescentState(tid);
-        pred = head;
-        curr = rqProvider->read_addr(tid,&head->next); //head is never marked
-        assert(((casword_t)curr & MARK_BIT) == 0);
+        pred = searchStart(tid, key);
+        // head is never marked, but a hint may have been marked since it was found.
+        // if so, the CASs on pred->next below fail, and we retry.
+        curr = getUnmarked(rqProvider->read_addr(tid,&pred->next));
         while(true){
             assert(curr != NULL);
             nodeptr succ_field = rqProvider->read_addr(tid, &curr->next);
@@ -271,6 +298,9 @@ retry_erase:
                 rqProvider->announce_physical_deletion(tid, deletedNodes);
                 assert(curr->isMarked(tid, rqProvider));
                 if(BOOL_CAS(&(pred->next), (casword_t)curr, (casword_t)succ)){
+#ifdef USE_LIST_INDEX
+                    index->clear(curr); // before curr is retired
+#endif
                     rqProvider->physical_deletion_succeeded(tid, deletedNodes);
                     assert(curr->isMarked(tid,rqProvider));
                     assert(getUnmarked(rqProvider->read_addr(tid, &curr->next)) == succ);
@@ -309,6 +339,9 @@ retry_erase:
             rqProvider->announce_physical_deletion(tid, deletedNodes);
             assert(curr->isMarked(tid, rqProvider));
             if (BOOL_CAS(&(pred->next), (casword_t)curr, (casword_t)succ)){
+#ifdef USE_LIST_INDEX
+                index->clear(curr); // before curr is retired
+#endif
                 rqProvider->physical_deletion_succeeded(tid, deletedNodes);
             } else {
                 rqProvider->physical_deletion_failed(tid, deletedNodes);
@@ -325,9 +358,9 @@ int lflist<K,V,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi,
     recordmgr->leaveQuiescentState(tid, true);
     rqProvider->traversal_start(tid);
     int cnt = 0;
-    nodeptr curr = rqProvider->read_addr(tid, &head->next);
 //    int iterations = 0;
 #ifdef RQ_SNAPCOLLECTOR
+    nodeptr curr = rqProvider->read_addr(tid, &head->next);
     while (rqProvider->traversal_is_active(tid)) {
         nodeptr nextptr = rqProvider->read_addr(tid, &curr->next);
         if (!isMarked(nextptr)) {
@@ -351,6 +384,7 @@ int lflist<K,V,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi,
 //    }
     }
 #else
+    nodeptr curr = (nodeptr) getUnmarked(rqProvider->read_addr(tid, &searchStart(tid, lo)->next));
     while (curr->key < lo) {
         curr = (nodeptr) getUnmarked(rqProvider->read_addr(tid, &curr->next)); 
     }
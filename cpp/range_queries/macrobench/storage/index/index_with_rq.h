@@ -146,7 +146,9 @@ typedef reclaimer_debra<> RECLAIMER_TYPE;
     #endif
     #include "bslack_impl.h"
     using namespace bslack_ns;
-    #define ABTREE_DEGREE 16
+    #ifndef ABTREE_DEGREE
+        #define ABTREE_DEGREE 16
+    #endif
     typedef Node<ABTREE_DEGREE, KEY_TYPE> NODE_TYPE;
     typedef SCXRecord<ABTREE_DEGREE, KEY_TYPE> DESCRIPTOR_TYPE;
     typedef record_manager<RECLAIMER_TYPE, ALLOCATOR_TYPE, POOL_TYPE, NODE_TYPE> RECORD_MANAGER_TYPE;
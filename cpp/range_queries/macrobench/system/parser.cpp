@@ -22,6 +22,8 @@ void print_usage() {
 	printf("\t-GbINT      ; TS_BATCH_ALLOC\n");
 	printf("\t-GuINT      ; TS_BATCH_NUM\n");
 	
+	printf("\t-pin STRING ; thread pinning, e.g., 0-3,8-11 or compact, scatter-sockets,\n");
+	printf("\t              physical-cores-first, one-per-L2\n");
 	printf("\t-o STRING   ; output file\n\n");
 	printf("  [YCSB]:\n");
 	printf("\t-cINT       ; PART_PER_TXN\n");
@@ -7,19 +7,39 @@ namespace thread_pinning {
     cpu_set_t ** cpusets;
     int * customBinding;
     int numCustomBindings;
+    int cpusetSize;     // cpu sets hold logical processors 0..cpusetSize-1
 
     void configurePolicy(const int numProcessors, string policy) {
         cpusets = new cpu_set_t * [numProcessors];
         customBinding = new int[numProcessors];
-        parseCustom(policy);
+        if (topology_isPolicy(policy)) {
+            numCustomBindings = 0;
+            vector<int> cpus = topology_getBinding(policy);
+            for (int i=0;i<cpus.size() && numCustomBindings < numProcessors;++i) {
+                customBinding[numCustomBindings++] = cpus[i];
+            }
+        } else {
+            parseCustom(policy);
+        }
         if (numCustomBindings > 0) {
+            // policies can bind threads to logical processors >= numProcessors
+            cpusetSize = numProcessors;
+            for (int i=0;i<numCustomBindings;++i) {
+                cpusetSize = max(cpusetSize, customBinding[i]+1);
+            }
             // create cpu sets for binding threads to cores
-            int size = CPU_ALLOC_SIZE(numProcessors);
+            int size = CPU_ALLOC_SIZE(cpusetSize);
             for (int i=0;i<numProcessors;++i) {
-                cpusets[i] = CPU_ALLOC(numProcessors);
+                cpusets[i] = CPU_ALLOC(cpusetSize);
                 CPU_ZERO_S(size, cpusets[i]);
                 CPU_SET_S(customBinding[i%numCustomBindings], size, cpusets[i]);
             }
+            // print the mapping, so the run can be reproduced with an explicit list
+            cout<<"thread pinning ("<<policy<<"): ";
+            for (int i=0;i<numProcessors;++i) {
+                cout<<(i?",":"")<<customBinding[i%numCustomBindings];
+            }
+            cout<<endl;
         }
     }
 
@@ -35,8 +55,8 @@ namespace thread_pinning {
             return result;
         }
         unsigned bindings = 0;
-        for (int i=0;i<nprocessors;++i) {
-            if (CPU_ISSET_S(i, CPU_ALLOC_SIZE(nprocessors), cpusets[tid%nprocessors])) {
+        for (int i=0;i<cpusetSize;++i) {
+            if (CPU_ISSET_S(i, CPU_ALLOC_SIZE(cpusetSize), cpusets[tid%nprocessors])) {
                 result = i;
                 ++bindings;
             }
@@ -52,8 +72,8 @@ namespace thread_pinning {
         if (numCustomBindings == 0) {
             return true;
         }
-        bool covered[nprocessors];
-        for (int i=0;i<nprocessors;++i) covered[i] = 0;
+        bool covered[cpusetSize];
+        for (int i=0;i<cpusetSize;++i) covered[i] = 0;
         for (int i=0;i<nthreads;++i) {
             int ix = getActualBinding(i, nprocessors);
             if (covered[ix]) return false;
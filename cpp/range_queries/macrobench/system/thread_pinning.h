@@ -12,6 +12,8 @@
  *      e.g., "1,2,3,8-11,4-7,0".
  *      the string contains the IDs of logical processors, or ranges of IDs,
  *      separated by commas. to skip thread binding, pass the empty string.
+ *      the string can also name a topology-aware policy: compact,
+ *      scatter-sockets, physical-cores-first or one-per-L2 (see topology.h).
  *  2.  have each thread invoke bindThread.
  * [3.] OPTIONAL: you can confirm the binding for a given thread by invoking
  *      getActualBinding. you can also check whether all
@@ -27,6 +29,7 @@
 #include <iostream>
 #include <stdlib.h>
 #include <string>
+#include "topology.h"
 
 namespace thread_pinning {
     
@@ -35,6 +38,7 @@ namespace thread_pinning {
     extern cpu_set_t ** cpusets;
     extern int * customBinding;
     extern int numCustomBindings;
+    extern int cpusetSize;
 
     /**
      * Public functions
@@ -119,7 +123,7 @@ namespace thread_pinning {
     }
 
     static void doBindThread(const int tid, const int nprocessors) {
-        if (sched_setaffinity(0, CPU_ALLOC_SIZE(nprocessors), cpusets[tid%nprocessors])) { // bind thread to core
+        if (sched_setaffinity(0, CPU_ALLOC_SIZE(cpusetSize), cpusets[tid%nprocessors])) { // bind thread to core
             cout<<"ERROR: could not bind thread "<<tid<<" to cpuset "<<cpusets[tid%nprocessors]<<endl;
             exit(-1);
         }
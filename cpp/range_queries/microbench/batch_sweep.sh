@@ -0,0 +1,33 @@
+#!/bin/bash
+#
+# Measures the throughput of batched updates (insertBatch/eraseBatch)
+# for batch sizes 1..1024 (and of ordinary updates, as batch size 0).
+#
+# Usage: ./batch_sweep.sh [millis]
+
+source ../config.mk
+
+machine=`hostname`
+millis=3000
+if [ "$#" -eq "1" ] ; then millis=$1 ; fi
+
+trials=3
+u=50
+nwork=$maxthreads
+alg=lockfree
+
+cols="%8s %8s %8s %6s %8s %16s %16s\n"
+printf "${cols}" ds k nwork batch trial throughput updates
+
+for ds in abtree bst ; do
+    k=100000
+    if [ "$ds" == "abtree" ] ; then k=1000000 ; fi
+    for batch in 0 1 2 4 8 16 32 64 128 256 512 1024 ; do
+    for ((trial=0;trial<$trials;++trial)) ; do
+        cmd="./${machine}.${ds}.rq_${alg}.out -i $u -d $u -k $k -rq 0 -rqsize 1 -p -t $millis -nrq 0 -nwork $nwork -batch $batch ${pinning_policy}"
+        out=`env LD_PRELOAD=../lib/libjemalloc.so TREE_MALLOC=../lib/libjemalloc.so $cmd`
+        if [ "`echo "$out" | grep 'Validation OK' | wc -l`" -eq "0" ] ; then echo "WARNING: validation failed for: $cmd" ; fi
+        printf "${cols}" $ds $k $nwork $batch $trial "`echo "$out" | grep 'total throughput' | cut -d':' -f2 | tr -d ' '`" "`echo "$out" | grep 'total updates' | cut -d':' -f2 | tr -d ' '`"
+    done
+    done
+done
@@ -43,7 +43,12 @@ const test_type KEY_MAX = numeric_limits<test_type>::max()-1; // must be less th
     #if defined ABTREE
         #define USE_SIMPLIFIED_ABTREE_REBALANCING
     #endif
-    #define ABTREE_DEGREE 16
+    #ifndef ABTREE_DEGREE
+        #define ABTREE_DEGREE 16
+    #endif
+    #if ABTREE_DEGREE >= RQ_DEBUGGING_MAX_KEYS_PER_NODE
+        #error "RQ_DEBUGGING_MAX_KEYS_PER_NODE must be larger than ABTREE_DEGREE (see make degree=...)"
+    #endif
     #include "record_manager.h"
     #include "bslack_impl.h"
     using namespace bslack_ns;
@@ -51,6 +56,8 @@ const test_type KEY_MAX = numeric_limits<test_type>::max()-1; // must be less th
     #define DS_DECLARATION bslack<ABTREE_DEGREE, test_type, less<test_type>, MEMMGMT_T>
     #define MEMMGMT_T record_manager<RECLAIM, ALLOC, POOL, Node<ABTREE_DEGREE, test_type> >
     #define DS_CONSTRUCTOR new DS_DECLARATION(TOTAL_THREADS, ABTREE_DEGREE, KEY_MAX, SIGQUIT)
+    #define BULK_LOAD_SUPPORTED
+    #define DS_BULK_CONSTRUCTOR(keys, values, n) new DS_DECLARATION(TOTAL_THREADS, ABTREE_DEGREE, KEY_MAX, SIGQUIT, (keys), (values), (n), TOTAL_THREADS)
 
     // note: INSERT success checks use "== NO_VALUE" so that prefilling can tell that a new KEY has been inserted
     #define INSERT_AND_CHECK_SUCCESS ds->INSERT_FUNC(tid, key, VALUE) == ds->NO_VALUE
@@ -58,6 +65,9 @@ const test_type KEY_MAX = numeric_limits<test_type>::max()-1; // must be less th
     #define FIND_AND_CHECK_SUCCESS ds->FIND_FUNC(tid, key)
     #define RQ_AND_CHECK_SUCCESS(rqcnt) (rqcnt) = ds->RQ_FUNC(tid, key, key+RQSIZE-1, rqResultKeys, (VALUE_TYPE *) rqResultValues)
     #define RQ_GARBAGE(rqcnt) rqResultKeys[0] + rqResultKeys[(rqcnt)-1]
+    #define BATCH_UPDATES_SUPPORTED
+    #define INSERT_BATCH(keys, values, n, results) ds->insertBatch(tid, (keys), (values), (n), (results))
+    #define DELETE_BATCH(keys, n, results) ds->eraseBatch(tid, (keys), (n), (results))
     #define INIT_THREAD(tid) ds->initThread(tid)
     #define DEINIT_THREAD(tid) ds->deinitThread(tid)
     #define INIT_ALL
@@ -79,6 +89,9 @@ const test_type KEY_MAX = numeric_limits<test_type>::max()-1; // must be less th
     #define FIND_AND_CHECK_SUCCESS ds->FIND_FUNC(tid, key)
     #define RQ_AND_CHECK_SUCCESS(rqcnt) (rqcnt) = ds->RQ_FUNC(tid, key, key+RQSIZE-1, rqResultKeys, (VALUE_TYPE *) rqResultValues)
     #define RQ_GARBAGE(rqcnt) rqResultKeys[0] + rqResultKeys[(rqcnt)-1]
+    #define BATCH_UPDATES_SUPPORTED
+    #define INSERT_BATCH(keys, values, n, results) ds->insertBatch(tid, (keys), (values), (n), (results))
+    #define DELETE_BATCH(keys, n, results) ds->eraseBatch(tid, (keys), (n), (results))
     #define INIT_THREAD(tid) ds->initThread(tid)
     #define DEINIT_THREAD(tid) ds->deinitThread(tid)
     #define INIT_ALL 
@@ -112,7 +125,11 @@ const test_type KEY_MAX = numeric_limits<test_type>::max()-1; // must be less th
 
     #define DS_DECLARATION lazylist<test_type, test_type, MEMMGMT_T>
     #define MEMMGMT_T record_manager<RECLAIM, ALLOC, POOL, node_t<test_type, test_type> >
-    #define DS_CONSTRUCTOR new DS_DECLARATION(TOTAL_THREADS, KEY_MIN, KEY_MAX, NO_VALUE)
+    #ifdef USE_LIST_INDEX
+        #define DS_CONSTRUCTOR new DS_DECLARATION(TOTAL_THREADS, KEY_MIN, KEY_MAX, NO_VALUE, MAXKEY)
+    #else
+        #define DS_CONSTRUCTOR new DS_DECLARATION(TOTAL_THREADS, KEY_MIN, KEY_MAX, NO_VALUE)
+    #endif
 
     #define INSERT_AND_CHECK_SUCCESS ds->INSERT_FUNC(tid, key, VALUE) == ds->NO_VALUE
     #define DELETE_AND_CHECK_SUCCESS ds->ERASE_FUNC(tid, key) != ds->NO_VALUE
@@ -152,7 +169,11 @@ const test_type KEY_MAX = numeric_limits<test_type>::max()-1; // must be less th
 
     #define DS_DECLARATION lflist<test_type, test_type, MEMMGMT_T>
     #define MEMMGMT_T record_manager<RECLAIM, ALLOC, POOL, node_t<test_type, test_type> RQ_SNAPCOLLECTOR_OBJECT_TYPES>
-    #define DS_CONSTRUCTOR new DS_DECLARATION(TOTAL_THREADS, KEY_MIN, KEY_MAX, NO_VALUE)
+    #ifdef USE_LIST_INDEX
+        #define DS_CONSTRUCTOR new DS_DECLARATION(TOTAL_THREADS, KEY_MIN, KEY_MAX, NO_VALUE, MAXKEY)
+    #else
+        #define DS_CONSTRUCTOR new DS_DECLARATION(TOTAL_THREADS, KEY_MIN, KEY_MAX, NO_VALUE)
+    #endif
 
     #define INSERT_AND_CHECK_SUCCESS ds->INSERT_FUNC(tid, key, VALUE) == ds->NO_VALUE
     #define DELETE_AND_CHECK_SUCCESS ds->ERASE_FUNC(tid, key) != ds->NO_VALUE
@@ -236,5 +257,27 @@ const test_type KEY_MAX = numeric_limits<test_type>::max()-1; // must be less th
     #error "Failed to define a data structure"
 #endif
 
+#if (defined RQ_LOCKFREE || defined RQ_RWLOCK) && (defined ABTREE || defined BSLACK || defined BST || defined CITRUS || defined LAZYLIST || defined SKIPLISTLOCK)
+    // the visitor copies keys into rqResultKeys, so RQ_GARBAGE works as usual
+    #define RQ_STREAMING_SUPPORTED
+    #define RQ_STREAM_AND_CHECK_SUCCESS(rqcnt) ((rqcnt) = 0, (rqcnt) = ds->rangeQuery(tid, key, key+RQSIZE-1, RQ_LIMIT, [&](const test_type& __k, VALUE_TYPE const & __v) { rqResultKeys[(rqcnt)++] = __k; return true; }))
+#endif
+
+#if (defined RQ_LOCKFREE || defined RQ_RWLOCK) && (defined ABTREE || defined BSLACK || defined BST)
+    // ordered queries built on streaming range queries: successor, predecessor,
+    // descending range queries, and range queries that iterate with an rq_cursor
+    #define RQ_ORDERED_SUPPORTED
+    #define SUCCESSOR_AND_CHECK_SUCCESS(resultKey, resultValue) ds->successor(tid, key, &(resultKey), &(resultValue))
+    #define PREDECESSOR_AND_CHECK_SUCCESS(resultKey, resultValue) ds->predecessor(tid, key, &(resultKey), &(resultValue))
+    #define RQ_STREAM_DESCENDING_AND_CHECK_SUCCESS(rqcnt) ((rqcnt) = 0, (rqcnt) = ds->rangeQueryDescending(tid, key, key+RQSIZE-1, RQ_LIMIT, [&](const test_type& __k, VALUE_TYPE const & __v) { rqResultKeys[(rqcnt)++] = __k; return true; }))
+    #define RQ_CURSOR_AND_CHECK_SUCCESS(rqcnt) ((rqcnt) = cursorRangeQuery(ds, tid, key, key+RQSIZE-1, RQ_LIMIT, rqResultKeys, rqResultValues))
+#endif
+
+#if defined RQ_LOCKFREE && (defined ABTREE || defined BSLACK || defined BST)
+    // range queries split into subtrees that are traversed by helper threads (see rq_parallel.h)
+    #define RQ_PARALLEL_SUPPORTED
+    #define RQ_PARALLEL_AND_CHECK_SUCCESS(rqcnt, helpers) (rqcnt) = ds->rangeQuery(tid, key, key+RQSIZE-1, rqResultKeys, (VALUE_TYPE *) rqResultValues, (helpers))
+#endif
+
 #endif /* DATA_STRUCTURE_H */
 
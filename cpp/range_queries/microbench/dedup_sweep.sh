@@ -0,0 +1,42 @@
+#!/bin/bash
+#
+# Compares the hashlists that can be used to deduplicate range query results
+# (see common/hashlist.h) across range query sizes.
+# Builds one binary per hashlist (with suffix .<hashlist>), then runs
+# range query heavy workloads with each.
+#
+# Usage: ./dedup_sweep.sh [millis]
+
+source ../config.mk
+
+machine=`hostname`
+millis=3000
+if [ "$#" -eq "1" ] ; then millis=$1 ; fi
+
+trials=3
+hashlists="SIMPLIFIED STL OPEN_ADDRESSING"
+algs="bst.rq_lockfree abtree.rq_lockfree"
+
+for h in $hashlists ; do
+    make $algs hashlist=$h filesuffix=.$h > /dev/null || exit 1
+done
+
+nrq=1
+nwork=$((maxthreads - nrq))
+
+cols="%20s %8s %16s %8s %6s %16s %16s\n"
+printf "${cols}" alg k hashlist rqsize trial throughput rqs
+for alg in $algs ; do
+    k=100000
+    if [ "$alg" == "abtree.rq_lockfree" ] ; then k=1000000 ; fi
+    for rqsize in 1 10 100 1000 10000 100000 ; do
+    for h in $hashlists ; do
+    for ((trial=0;trial<$trials;++trial)) ; do
+        cmd="./${machine}.${alg}.${h}.out -i 10 -d 10 -k $k -rq 10 -rqsize $rqsize -p -t $millis -nrq $nrq -nwork $nwork ${pinning_policy}"
+        out=`env LD_PRELOAD=../lib/libjemalloc.so TREE_MALLOC=../lib/libjemalloc.so $cmd`
+        if [ "`echo "$out" | grep 'Validation OK' | wc -l`" -eq "0" ] ; then echo "WARNING: validation failed for: $cmd" ; fi
+        printf "${cols}" $alg $k $h $rqsize $trial "`echo "$out" | grep 'total throughput' | cut -d':' -f2 | tr -d ' '`" "`echo "$out" | grep 'total rq' | head -1 | cut -d':' -f2 | tr -d ' '`"
+    done
+    done
+    done
+done
@@ -0,0 +1,54 @@
+#!/bin/bash
+#
+# Measures search-only throughput of abtree and bslack (with rq_lockfree)
+# for several node degrees, with and without SIMD searches of the keys in
+# each node (see common/simd_search.h), and with SIMD searches but without
+# prefetching the keys of each node (noprefetch), on a large, bulk loaded tree.
+# Builds one binary per degree and setting (with suffix .<degree>.<setting>),
+# then runs each.
+#
+# Usage: ./degree_sweep.sh [millis [keyrange [simd]]]
+#        (simd is the instruction set passed to make, e.g., avx2 or sse4.2)
+
+source ../config.mk
+
+machine=`hostname`
+millis=3000
+k=100000000
+simd=avx2
+if [ "$#" -ge "1" ] ; then millis=$1 ; fi
+if [ "$#" -ge "2" ] ; then k=$2 ; fi
+if [ "$#" -ge "3" ] ; then simd=$3 ; fi
+
+trials=3
+degrees="8 16 32 64 128"
+settings="scalar $simd noprefetch"
+dss="abtree bslack"
+
+for d in $degrees ; do
+    for s in $settings ; do
+        knobs="simd=$simd"
+        if [ "$s" == "scalar" ] ; then knobs="" ; fi
+        if [ "$s" == "noprefetch" ] ; then knobs="simd=$simd noprefetch=1" ; fi
+        for ds in $dss ; do
+            make ${ds}.rq_lockfree $knobs degree=$d filesuffix=.$d.$s > /dev/null || exit 1
+        done
+    done
+done
+
+cols="%10s %12s %8s %12s %6s %6s %16s\n"
+printf "${cols}" ds k degree setting nwork trial throughput
+for ds in $dss ; do
+    for ((nwork=1;nwork<=$maxthreads;nwork=(nwork<$threadincrement ? nwork*2 : nwork+$threadincrement))) ; do
+    for d in $degrees ; do
+    for s in $settings ; do
+    for ((trial=0;trial<$trials;++trial)) ; do
+        cmd="./${machine}.${ds}.rq_lockfree.${d}.${s}.out -i 0 -d 0 -k $k -rq 0 -rqsize 1 -pbulk -t $millis -nrq 0 -nwork $nwork ${pinning_policy}"
+        out=`env LD_PRELOAD=../lib/libjemalloc.so TREE_MALLOC=../lib/libjemalloc.so $cmd`
+        if [ "`echo "$out" | grep 'Validation OK' | wc -l`" -eq "0" ] ; then echo "WARNING: validation failed for: $cmd" ; fi
+        printf "${cols}" $ds $k $d $s $nwork $trial "`echo "$out" | grep 'total throughput' | cut -d':' -f2 | tr -d ' '`"
+    done
+    done
+    done
+    done
+done
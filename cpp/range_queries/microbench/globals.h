@@ -26,14 +26,45 @@ int RQSIZE;
 int MAXKEY;
 int MILLIS_TO_RUN;
 bool PREFILL;
+bool BULK_PREFILL; // if true, prefilling uses the data structure's bulk loading constructor
 int WORK_THREADS;
 int RQ_THREADS;
 int TOTAL_THREADS;
+int BATCH_SIZE; // if positive, each insert/delete is a batch of this many keys
+bool RQ_STREAMING; // if true, range queries pass their keys to a visitor (see rq_stream.h)
+int RQ_LIMIT; // if positive, streaming range queries stop after this many keys
+bool RQ_DESCENDING; // if true, streaming range queries pass their keys in decreasing order
+bool RQ_CURSOR; // if true, range queries iterate over their range with an rq_cursor (see rq_cursor.h)
+double SUCC; // percentage of operations that are successor or predecessor queries (half each)
+int RQ_PARALLELISM; // number of threads that perform each range query of a range query thread (itself and its helpers)
+int LATENCY_SAMPLE_PERIOD; // each thread measures the latency of one in this many operations
+char * JSON_OUTPUT_FILE; // if non-NULL, results are also written to this file in JSON format
+int STALL_THREADS; // number of worker threads to park in a non-quiescent state
+int STALL_MILLIS; // how long each park lasts
+int STALL_PERIOD_MILLIS; // time between the starts of consecutive parks
+int SAMPLE_MILLIS; // how often to sample unreclaimed records and RSS (0 = never)
 
 /**
  * Configure global statistics using stats_global.h and stats.h
  */
 
+// latency_log2_* stats count sampled operations whose latency in nanoseconds
+// is in [2^i, 2^(i+1)) at index i
+#define LATENCY_LOG2_BUCKETS 64
+
+// only built with BLOCKBAG_SUMMARIES (so the output is unchanged without it)
+#ifdef BLOCKBAG_SUMMARIES
+#define __HANDLE_BLOCKBAG_SUMMARY_STATS(handle_stat) \
+    handle_stat(LONG_LONG, summary_skipped_in_bags, 10000, { \
+            stat_output_item(PRINT_HISTOGRAM_LOG, NONE, FULL_DATA) \
+          C stat_output_item(PRINT_RAW, SUM, TOTAL) \
+          C stat_output_item(PRINT_RAW, AVERAGE, TOTAL) \
+          C stat_output_item(PRINT_RAW, STDEV, TOTAL) \
+    })
+#else
+#define __HANDLE_BLOCKBAG_SUMMARY_STATS(handle_stat)
+#endif
+
 #define __HANDLE_STATS(handle_stat) \
     handle_stat(LONG_LONG, node_allocated_addresses, 100, { \
             stat_output_item(PRINT_RAW, FIRST, BY_INDEX) \
@@ -79,6 +110,15 @@ int TOTAL_THREADS;
           C stat_output_item(PRINT_RAW, AVERAGE, TOTAL) \
           C stat_output_item(PRINT_RAW, STDEV, TOTAL) \
     }) \
+    __HANDLE_BLOCKBAG_SUMMARY_STATS(handle_stat) \
+    handle_stat(LONG_LONG, epoch_advances, 1000, { \
+            stat_output_item(PRINT_RAW, SUM, BY_INDEX) \
+          C stat_output_item(PRINT_RAW, SUM, TOTAL) \
+    }) \
+    handle_stat(LONG_LONG, limbo_size, 1000, { \
+            stat_output_item(PRINT_RAW, SUM, BY_INDEX) \
+          C stat_output_item(PRINT_RAW, MAX, TOTAL) \
+    }) \
     handle_stat(LONG_LONG, latency_rqs, 10000, { \
             stat_output_item(PRINT_HISTOGRAM_LOG, NONE, FULL_DATA) \
           /*C stat_output_item(PRINT_RAW, NONE, FULL_DATA)*/ \
@@ -106,6 +146,18 @@ int TOTAL_THREADS;
           C stat_output_item(PRINT_RAW, MIN, TOTAL) \
           C stat_output_item(PRINT_RAW, MAX, TOTAL) \
     }) \
+    handle_stat(LONG_LONG, latency_log2_inserts, LATENCY_LOG2_BUCKETS, { \
+            stat_output_item(PRINT_RAW, SUM, BY_INDEX) \
+    }) \
+    handle_stat(LONG_LONG, latency_log2_erases, LATENCY_LOG2_BUCKETS, { \
+            stat_output_item(PRINT_RAW, SUM, BY_INDEX) \
+    }) \
+    handle_stat(LONG_LONG, latency_log2_searches, LATENCY_LOG2_BUCKETS, { \
+            stat_output_item(PRINT_RAW, SUM, BY_INDEX) \
+    }) \
+    handle_stat(LONG_LONG, latency_log2_rqs, LATENCY_LOG2_BUCKETS, { \
+            stat_output_item(PRINT_RAW, SUM, BY_INDEX) \
+    }) \
     handle_stat(LONG_LONG, skiplist_inserted_on_level, 30, { \
             /*stat_output_item(PRINT_RAW, NONE, FULL_DATA)*/ \
           /*C stat_output_item(PRINT_RAW, SUM, BY_INDEX)*/ \
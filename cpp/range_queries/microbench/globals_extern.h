@@ -56,9 +56,17 @@ extern int RQSIZE;
 extern int MAXKEY;
 extern int MILLIS_TO_RUN;
 extern bool PREFILL;
+extern bool BULK_PREFILL;
 extern int WORK_THREADS;
 extern int RQ_THREADS;
 extern int TOTAL_THREADS;
+extern int BATCH_SIZE;
+extern bool RQ_STREAMING;
+extern int RQ_LIMIT;
+extern bool RQ_DESCENDING;
+extern bool RQ_CURSOR;
+extern double SUCC;
+extern int RQ_PARALLELISM;
 
 #define NUMBER_OF_PATHS 1
 
@@ -79,8 +87,18 @@ extern int TOTAL_THREADS;
  */
 
 #define RECLAIM reclaimer_debra<test_type>
+#if defined USE_ALLOC_BUMP
+#define ALLOC allocator_bump<test_type>
+#else
 #define ALLOC allocator_new_segregated<test_type>
+#endif
+#if defined USE_POOL_NUMA
+#define POOL pool_numa<test_type>
+#elif defined USE_POOL_PERTHREAD_AND_SHARED
+#define POOL pool_perthread_and_shared<test_type>
+#else
 #define POOL pool_none<test_type>
+#endif
 
 #endif	/* GLOBALS_EXTERN_H */
 
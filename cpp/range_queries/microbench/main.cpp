@@ -25,7 +25,9 @@ typedef long long test_type;
 #include <pthread.h>
 #include <atomic>
 #include <chrono>
+#include <thread>
 #include <cassert>
+#include <fstream>
 #include "globals.h"
 #include "globals_extern.h"
 #include "rq_debugging.h"
@@ -38,6 +40,9 @@ typedef long long test_type;
     #include "debugcounters.h"
 #endif
 #include "data_structures.h"
+#ifdef RQ_ORDERED_SUPPORTED
+    #include "rq_cursor.h"
+#endif
 
 using namespace std;
 
@@ -80,6 +85,28 @@ struct main_globals_t {
     volatile char padding10[PREFETCH_SIZE_BYTES];
     long long prefillKeySum;
     volatile char padding11[PREFETCH_SIZE_BYTES];
+    
+    // if nonzero, thread tid parks until stallDeadlines[tid*PREFETCH_SIZE_WORDS]
+    // (in milliseconds, from stallClockMillis())
+    volatile long long stallDeadlines[MAX_TID_POW2*PREFETCH_SIZE_WORDS];
+    volatile char padding12[PREFETCH_SIZE_BYTES];
+    
+    // statistics sampled by the main thread while the trial runs
+    long long samples;
+    long long stallsStarted;
+    long long peakUnreclaimed;
+    long long sumUnreclaimed;
+    long long peakRSSBytes;
+    long long sumRSSBytes;
+    long long opsWhileStalled;
+    long long millisWhileStalled;
+    long long opsWhileNotStalled;
+    long long millisWhileNotStalled;
+    volatile char padding13[PREFETCH_SIZE_BYTES];
+
+    // number of ordered queries (successor, predecessor and streaming range
+    // queries) whose results were out of order or outside of their range
+    atomic_llong orderViolations;
 };
 
 main_globals_t glob = {0,};
@@ -88,8 +115,11 @@ const long long PREFILL_INTERVAL_MILLIS = 100;
 
 #define STR(x) XSTR(x)
 #define XSTR(x) #x
+#define STR_VA(...) XSTR_VA(__VA_ARGS__)
+#define XSTR_VA(...) #__VA_ARGS__
 
 #define PRINTI(name) { cout<<#name<<"="<<name<<endl; }
+#define PRINTI_POLICY(policy, field) { cout<<#policy<<"."<<#field<<"="<<policy().field<<endl; }
 #define PRINTS(name) { cout<<#name<<"="<<STR(name)<<endl; }
 
 #ifndef OPS_BETWEEN_TIME_CHECKS
@@ -99,6 +129,83 @@ const long long PREFILL_INTERVAL_MILLIS = 100;
 #define RQS_BETWEEN_TIME_CHECKS 10
 #endif
 
+#ifdef RQ_ORDERED_SUPPORTED
+/**
+ * finds the keys in [lo, hi] (at most limit keys, if limit is positive) by
+ * iterating over them with an rq_cursor, and returns the number of keys found.
+ */
+template <class DataStructure>
+int cursorRangeQuery(DataStructure * const ds, const int tid, const test_type lo, const test_type hi, const int limit, test_type * const resultKeys, VALUE_TYPE * const resultValues) {
+    rq_cursor<test_type, VALUE_TYPE, DataStructure> cursor (ds, tid, lo, hi);
+    int cnt = 0;
+    while ((limit <= 0 || cnt < limit) && cursor.next(&resultKeys[cnt], &resultValues[cnt])) ++cnt;
+    return cnt;
+}
+
+/**
+ * returns true if keys[0...n-1] are in [lo, hi] and strictly increasing
+ * (or strictly decreasing, if descending).
+ */
+bool rqResultIsOrdered(const test_type * const keys, const int n, const test_type lo, const test_type hi, const bool descending) {
+    for (int i=0;i<n;++i) {
+        if (keys[i] < lo || keys[i] > hi) return false;
+        if (i > 0 && (descending ? !(keys[i] < keys[i-1]) : !(keys[i-1] < keys[i]))) return false;
+    }
+    return true;
+}
+
+#define DO_RQ(rqcnt) (RQ_CURSOR ? (RQ_CURSOR_AND_CHECK_SUCCESS(rqcnt)) \
+                    : RQ_DESCENDING ? (RQ_STREAM_DESCENDING_AND_CHECK_SUCCESS(rqcnt)) \
+                    : RQ_STREAMING ? (RQ_STREAM_AND_CHECK_SUCCESS(rqcnt)) \
+                    : (RQ_AND_CHECK_SUCCESS(rqcnt)))
+// the keys returned by a streaming range query must be in order
+#define CHECK_RQ_ORDER(rqcnt) if (RQ_STREAMING && !rqResultIsOrdered(rqResultKeys, (rqcnt), key, key+RQSIZE-1, RQ_DESCENDING)) glob.orderViolations.fetch_add(1)
+#elif defined RQ_STREAMING_SUPPORTED
+#define DO_RQ(rqcnt) (RQ_STREAMING ? (RQ_STREAM_AND_CHECK_SUCCESS(rqcnt)) : (RQ_AND_CHECK_SUCCESS(rqcnt)))
+#define CHECK_RQ_ORDER(rqcnt)
+#else
+#define DO_RQ(rqcnt) (RQ_AND_CHECK_SUCCESS(rqcnt))
+#define CHECK_RQ_ORDER(rqcnt)
+#endif
+
+#ifdef RQ_PARALLEL_SUPPORTED
+/**
+ * With -rqpar N, each range query thread has N-1 helper threads, which help it
+ * traverse the data structure in each of its range queries. The helpers of
+ * range query thread WORK_THREADS+r have thread ids
+ * WORK_THREADS+RQ_THREADS+r*(N-1), ..., WORK_THREADS+RQ_THREADS+(r+1)*(N-1)-1.
+ */
+rq_parallel<test_type, VALUE_TYPE> * rqHelpers[MAX_TID_POW2];
+#define DO_RQ_PARALLEL(rqcnt) (RQ_PARALLELISM > 1 ? (RQ_PARALLEL_AND_CHECK_SUCCESS(rqcnt, rqHelpers[tid])) : (DO_RQ(rqcnt)))
+#else
+#define DO_RQ_PARALLEL(rqcnt) (DO_RQ(rqcnt))
+#endif
+
+/**
+ * Each thread measures the latency of one in every LATENCY_SAMPLE_PERIOD of
+ * its operations (with rdtsc, via get_server_clock()), so timing does not
+ * perturb throughput. A sampled operation appends its latency to raw_stat,
+ * and counts it in its log2 bucket in log2_stat.
+ */
+#ifdef USE_GSTATS
+#define LATENCY_LOG2_BUCKET(ns) ((ns) <= 1 ? 0 : min(LATENCY_LOG2_BUCKETS-1, 63 - __builtin_clzll((unsigned long long) (ns))))
+#define LATENCY_START \
+    const bool __latencySampled = (--latencyCountdown <= 0); \
+    if (__latencySampled) { \
+        latencyCountdown = LATENCY_SAMPLE_PERIOD; \
+        GSTATS_TIMER_RESET(tid, timer_latency); \
+    }
+#define LATENCY_END(raw_stat, log2_stat) \
+    if (__latencySampled) { \
+        const long long __ns = GSTATS_TIMER_ELAPSED(tid, timer_latency); \
+        GSTATS_APPEND(tid, raw_stat, __ns); \
+        GSTATS_ADD_IX(tid, log2_stat, 1, LATENCY_LOG2_BUCKET(__ns)); \
+    }
+#else
+#define LATENCY_START
+#define LATENCY_END(raw_stat, log2_stat)
+#endif
+
 #ifdef USE_DEBUGCOUNTERS
     #define GET_COUNTERS ds->debugGetCounters()
     #define CLEAR_COUNTERS ds->clearCounters();
@@ -107,6 +214,28 @@ const long long PREFILL_INTERVAL_MILLIS = 100;
     #define CLEAR_COUNTERS 
 #endif
     
+inline long long stallClockMillis() {
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Park thread tid until its stall deadline (or the end of the trial),
+ * in a non-quiescent state, as if it were descheduled in the middle of an
+ * operation. Since RECLAIM is DEBRA, which does not protect individual
+ * records, this prevents the epoch from advancing just like a stall inside
+ * an operation would.
+ */
+void stallUntilDeadline(const int tid, DS_DECLARATION * ds) {
+    MEMMGMT_T * recmgr = (MEMMGMT_T *) ds->debugGetRecMgr();
+    if (recmgr) recmgr->leaveQuiescentState(tid);
+    long long deadline;
+    while ((deadline = glob.stallDeadlines[tid*PREFETCH_SIZE_WORDS]) && !glob.done && stallClockMillis() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    if (recmgr) recmgr->enterQuiescentState(tid);
+    glob.stallDeadlines[tid*PREFETCH_SIZE_WORDS] = 0;
+}
+
 void *thread_prefill(void *_id) {
     int tid = *((int*) _id);
     binding_bindThread(tid, LOGICAL_PROCESSORS);
@@ -306,6 +435,43 @@ void prefill(DS_DECLARATION * ds) {
 #endif
 }
 
+#ifdef BULK_LOAD_SUPPORTED
+/**
+ * creates a prefilled data structure with its bulk loading constructor.
+ * each key in [0, MAXKEY) is included independently, with the probability
+ * that it is present in the steady state of the update workload.
+ */
+DS_DECLARATION * prefill_bulk() {
+    chrono::time_point<chrono::high_resolution_clock> prefillStartTime = chrono::high_resolution_clock::now();
+
+    const double expectedFullness = (INS+DEL ? INS / (double)(INS+DEL) : 0.5); // percent full in expectation
+    Random rng (rand());
+    vector<test_type> keys;
+    vector<VALUE_TYPE> values;
+    long long keysum = 0;
+    for (int key=0;key<MAXKEY;++key) {
+        if (rng.nextNatural(1000000) < expectedFullness * 1000000) {
+            keys.push_back(key);
+            values.push_back(VALUE);
+            keysum += key;
+        }
+    }
+    DS_DECLARATION * ds = DS_BULK_CONSTRUCTOR(keys.data(), values.data(), keys.size());
+
+#ifdef USE_DEBUGCOUNTERS
+    glob.keysum->add(0, keysum);
+    glob.prefillSize->add(0, keys.size());
+#endif
+#ifdef USE_GSTATS
+    glob.prefillKeySum = keysum;
+#endif
+    chrono::time_point<chrono::high_resolution_clock> prefillEndTime = chrono::high_resolution_clock::now();
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(prefillEndTime-prefillStartTime).count();
+    COUTATOMIC("finished bulk loading to size "<<keys.size()<<" keysum="<<keysum<<" dskeysum="<<ds->debugKeySum()<<" dssize="<<ds->getSize()<<" in "<<(elapsed/1000.)<<"s"<<endl);
+    return ds;
+}
+#endif
+
 void *thread_timed(void *_id) {
     int tid = *((int*) _id);
     binding_bindThread(tid, LOGICAL_PROCESSORS);
@@ -315,6 +481,11 @@ void *thread_timed(void *_id) {
 
     test_type * rqResultKeys = new test_type[RQSIZE+RQ_DEBUGGING_MAX_KEYS_PER_NODE];
     VALUE_TYPE * rqResultValues = new VALUE_TYPE[RQSIZE+RQ_DEBUGGING_MAX_KEYS_PER_NODE];
+#ifdef BATCH_UPDATES_SUPPORTED
+    test_type * batchKeys = new test_type[max(1, BATCH_SIZE)];
+    VALUE_TYPE * batchValues = new VALUE_TYPE[max(1, BATCH_SIZE)];
+    VALUE_TYPE * batchResults = new VALUE_TYPE[max(1, BATCH_SIZE)];
+#endif
     
     INIT_THREAD(tid);
     papi_create_eventset(tid);
@@ -324,8 +495,9 @@ void *thread_timed(void *_id) {
     papi_start_counters(tid);
     int cnt = 0;
     int rq_cnt = 0;
+    int latencyCountdown = LATENCY_SAMPLE_PERIOD;
     while (!glob.done) {
-        if (((++cnt) % OPS_BETWEEN_TIME_CHECKS) == 0 || (rq_cnt % RQS_BETWEEN_TIME_CHECKS) == 0) {
+        if (((++cnt) % OPS_BETWEEN_TIME_CHECKS) == 0 || (rq_cnt % RQS_BETWEEN_TIME_CHECKS) == 0 || BATCH_SIZE > 0) {
             chrono::time_point<chrono::high_resolution_clock> __endTime = chrono::high_resolution_clock::now();
             if (chrono::duration_cast<chrono::milliseconds>(__endTime-glob.startTime).count() >= abs(MILLIS_TO_RUN)) {
                 __sync_synchronize();
@@ -335,11 +507,44 @@ void *thread_timed(void *_id) {
             }
         }
         
+        if (glob.stallDeadlines[tid*PREFETCH_SIZE_WORDS]) {
+            stallUntilDeadline(tid, ds);
+            continue;
+        }
+        
         VERBOSE if (cnt&&((cnt % 1000000) == 0)) COUTATOMICTID("op# "<<cnt<<endl);
         int key = rng->nextNatural(MAXKEY);
         double op = rng->nextNatural(100000000) / 1000000.;
+#ifdef BATCH_UPDATES_SUPPORTED
+        if (BATCH_SIZE > 0 && op < INS+DEL) {
+            const bool isInsert = (op < INS);
+            for (int i=0;i<BATCH_SIZE;++i) {
+                if (i) key = rng->nextNatural(MAXKEY);
+                batchKeys[i] = key;
+                batchValues[i] = VALUE;
+            }
+            LATENCY_START;
+            if (isInsert) {
+                INSERT_BATCH(batchKeys, batchValues, BATCH_SIZE, batchResults);
+            } else {
+                DELETE_BATCH(batchKeys, BATCH_SIZE, batchResults);
+            }
+            LATENCY_END(latency_updates, (isInsert ? latency_log2_inserts : latency_log2_erases));
+            // note: the batch is sorted in place, and results[i] corresponds to the sorted batchKeys[i]
+            for (int i=0;i<BATCH_SIZE;++i) {
+                if (isInsert && batchResults[i] == ds->NO_VALUE) {
+                    GSTATS_ADD(tid, key_checksum, batchKeys[i]);
+                } else if (!isInsert && batchResults[i] != ds->NO_VALUE) {
+                    GSTATS_ADD(tid, key_checksum, -batchKeys[i]);
+                }
+            }
+            GSTATS_ADD(tid, num_updates, BATCH_SIZE);
+            GSTATS_ADD(tid, num_operations, BATCH_SIZE);
+            continue;
+        }
+#endif
         if (op < INS) {
-            GSTATS_TIMER_RESET(tid, timer_latency);
+            LATENCY_START;
             if (INSERT_AND_CHECK_SUCCESS) {
                 GSTATS_ADD(tid, key_checksum, key);
 #ifdef USE_DEBUGCOUNTERS
@@ -349,10 +554,10 @@ void *thread_timed(void *_id) {
                 GET_COUNTERS->insertFail->inc(tid);
 #endif
             }
-            GSTATS_TIMER_APPEND_ELAPSED(tid, timer_latency, latency_updates);
+            LATENCY_END(latency_updates, latency_log2_inserts);
             GSTATS_ADD(tid, num_updates, 1);
         } else if (op < INS+DEL) {
-            GSTATS_TIMER_RESET(tid, timer_latency);
+            LATENCY_START;
             if (DELETE_AND_CHECK_SUCCESS) {
                 GSTATS_ADD(tid, key_checksum, -key);
 #ifdef USE_DEBUGCOUNTERS
@@ -362,7 +567,7 @@ void *thread_timed(void *_id) {
                 GET_COUNTERS->eraseFail->inc(tid);
 #endif
             }
-            GSTATS_TIMER_APPEND_ELAPSED(tid, timer_latency, latency_updates);
+            LATENCY_END(latency_updates, latency_log2_erases);
             GSTATS_ADD(tid, num_updates, 1);
         } else if (op < INS+DEL+RQ) {
             unsigned _key = rng->nextNatural() % max(1, MAXKEY - RQSIZE);
@@ -374,19 +579,39 @@ void *thread_timed(void *_id) {
             
             ++rq_cnt;
             int rqcnt;
-            GSTATS_TIMER_RESET(tid, timer_latency);
-            if (RQ_AND_CHECK_SUCCESS(rqcnt)) { // prevent rqResultKeys and count from being optimized out
+            LATENCY_START;
+            if (DO_RQ(rqcnt)) { // prevent rqResultKeys and count from being optimized out
                 garbage += RQ_GARBAGE(rqcnt);
+                CHECK_RQ_ORDER(rqcnt);
 #ifdef USE_DEBUGCOUNTERS
                 GET_COUNTERS->rqSuccess->inc(tid);
             } else {
                 GET_COUNTERS->rqFail->inc(tid);
 #endif
             }
-            GSTATS_TIMER_APPEND_ELAPSED(tid, timer_latency, latency_rqs);
+            LATENCY_END(latency_rqs, latency_log2_rqs);
             GSTATS_ADD(tid, num_rq, 1);
+#ifdef RQ_ORDERED_SUPPORTED
+        } else if (op < INS+DEL+RQ+SUCC) {
+            // successor and predecessor queries are counted as searches
+            const bool isSuccessor = (op < INS+DEL+RQ+SUCC/2);
+            test_type resultKey;
+            VALUE_TYPE resultValue;
+            LATENCY_START;
+            if (isSuccessor ? SUCCESSOR_AND_CHECK_SUCCESS(resultKey, resultValue) : PREDECESSOR_AND_CHECK_SUCCESS(resultKey, resultValue)) {
+                garbage += resultKey;
+                if (isSuccessor ? resultKey < key : resultKey > key) glob.orderViolations.fetch_add(1);
+#ifdef USE_DEBUGCOUNTERS
+                GET_COUNTERS->findSuccess->inc(tid);
+            } else {
+                GET_COUNTERS->findFail->inc(tid);
+#endif
+            }
+            LATENCY_END(latency_searches, latency_log2_searches);
+            GSTATS_ADD(tid, num_searches, 1);
+#endif
         } else {
-            GSTATS_TIMER_RESET(tid, timer_latency);
+            LATENCY_START;
             if (FIND_AND_CHECK_SUCCESS) {
 #ifdef USE_DEBUGCOUNTERS
                 GET_COUNTERS->findSuccess->inc(tid);
@@ -394,7 +619,7 @@ void *thread_timed(void *_id) {
                 GET_COUNTERS->findFail->inc(tid);
 #endif
             }
-            GSTATS_TIMER_APPEND_ELAPSED(tid, timer_latency, latency_searches);
+            LATENCY_END(latency_searches, latency_log2_searches);
             GSTATS_ADD(tid, num_searches, 1);
         }
         GSTATS_ADD(tid, num_operations, 1);
@@ -406,6 +631,11 @@ void *thread_timed(void *_id) {
     DEINIT_THREAD(tid);
     delete[] rqResultKeys;
     delete[] rqResultValues;
+#ifdef BATCH_UPDATES_SUPPORTED
+    delete[] batchKeys;
+    delete[] batchValues;
+    delete[] batchResults;
+#endif
     glob.__garbage += garbage;
     pthread_exit(NULL);
 }
@@ -427,6 +657,7 @@ void *thread_rq(void *_id) {
     while (!glob.start) { __sync_synchronize(); TRACE COUTATOMICTID("waiting to start"<<endl); } // wait to start
     papi_start_counters(tid);
     int cnt = 0;
+    int latencyCountdown = LATENCY_SAMPLE_PERIOD;
     while (!glob.done) {
         if (((++cnt) % RQS_BETWEEN_TIME_CHECKS) == 0) {
             chrono::time_point<chrono::high_resolution_clock> __endTime = chrono::high_resolution_clock::now();
@@ -447,19 +678,23 @@ void *thread_rq(void *_id) {
         
         int key = (int) _key;
         int rqcnt;
-        GSTATS_TIMER_RESET(tid, timer_latency);
-        if (RQ_AND_CHECK_SUCCESS(rqcnt)) { // prevent rqResultKeys and count from being optimized out
+        LATENCY_START;
+        if (DO_RQ_PARALLEL(rqcnt)) { // prevent rqResultKeys and count from being optimized out
             garbage += RQ_GARBAGE(rqcnt);
+            CHECK_RQ_ORDER(rqcnt);
 #ifdef USE_DEBUGCOUNTERS
                 GET_COUNTERS->rqSuccess->inc(tid);
             } else {
                 GET_COUNTERS->rqFail->inc(tid);
 #endif
         }
-        GSTATS_TIMER_APPEND_ELAPSED(tid, timer_latency, latency_rqs);
+        LATENCY_END(latency_rqs, latency_log2_rqs);
         GSTATS_ADD(tid, num_rq, 1);
         GSTATS_ADD(tid, num_operations, 1);
     }
+#ifdef RQ_PARALLEL_SUPPORTED
+    if (RQ_PARALLELISM > 1) rqHelpers[tid]->stop();
+#endif
     glob.running.fetch_add(-1);
     while (glob.running.load()) {
         // wait
@@ -473,6 +708,92 @@ void *thread_rq(void *_id) {
     pthread_exit(NULL);
 }
 
+#ifdef RQ_PARALLEL_SUPPORTED
+void *thread_rq_helper(void *_id) {
+    int tid = *((int*) _id);
+    binding_bindThread(tid, LOGICAL_PROCESSORS);
+    DS_DECLARATION * ds = (DS_DECLARATION *) glob.__ds;
+    const int helperIx = tid - WORK_THREADS - RQ_THREADS;
+    const int ownerTid = WORK_THREADS + helperIx / (RQ_PARALLELISM-1);
+
+    INIT_THREAD(tid);
+    papi_create_eventset(tid);
+    glob.running.fetch_add(1);
+    __sync_synchronize();
+    while (!glob.start) { __sync_synchronize(); TRACE COUTATOMICTID("waiting to start"<<endl); } // wait to start
+    papi_start_counters(tid);
+    rqHelpers[ownerTid]->helperLoop(helperIx % (RQ_PARALLELISM-1)); // returns once the owner stops
+    glob.running.fetch_add(-1);
+    while (glob.running.load()) {
+        // wait
+    }
+
+    papi_stop_counters(tid);
+    DEINIT_THREAD(tid);
+    pthread_exit(NULL);
+}
+#endif
+
+#ifdef USE_GSTATS
+/**
+ * Run by the main thread until the trial is done.
+ * Every SAMPLE_MILLIS, samples the number of unreclaimed records, RSS and
+ * throughput, and every STALL_PERIOD_MILLIS, parks worker threads
+ * 0..STALL_THREADS-1 for STALL_MILLIS.
+ */
+void sampleUntilDone(DS_DECLARATION * ds) {
+    MEMMGMT_T * recmgr = (MEMMGMT_T *) ds->debugGetRecMgr();
+    long long lastTime = stallClockMillis();
+    long long lastOps = 0;
+    long long nextStall = lastTime + STALL_PERIOD_MILLIS;
+    long long stallEnd = 0;
+    while (!glob.done) {
+        this_thread::sleep_for(chrono::milliseconds(SAMPLE_MILLIS));
+        const long long now = stallClockMillis();
+        if (MILLIS_TO_RUN > 0 && chrono::duration_cast<chrono::milliseconds>(chrono::high_resolution_clock::now() - glob.startTime).count() >= MILLIS_TO_RUN) {
+            glob.done = true;
+            __sync_synchronize();
+        }
+        
+        // attribute the operations completed since the last sample
+        long long ops = 0;
+        for (int tid=0;tid<TOTAL_THREADS;++tid) {
+            ops += GSTATS_GET(tid, num_operations);
+        }
+        if (lastTime < stallEnd) {
+            glob.opsWhileStalled += ops - lastOps;
+            glob.millisWhileStalled += now - lastTime;
+        } else {
+            glob.opsWhileNotStalled += ops - lastOps;
+            glob.millisWhileNotStalled += now - lastTime;
+        }
+        lastOps = ops;
+        lastTime = now;
+        
+        if (STALL_THREADS > 0 && now >= nextStall && !glob.done) {
+            stallEnd = now + STALL_MILLIS;
+            for (int tid=0;tid<STALL_THREADS;++tid) {
+                glob.stallDeadlines[tid*PREFETCH_SIZE_WORDS] = stallEnd;
+            }
+            nextStall = now + STALL_PERIOD_MILLIS;
+            ++glob.stallsStarted;
+        }
+        
+        const long long unreclaimed = (recmgr ? recmgr->getApproxSizeInNodes() : 0);
+        const long long rss = debugInfo::getResidentBytes();
+        if (unreclaimed > glob.peakUnreclaimed) glob.peakUnreclaimed = unreclaimed;
+        if (rss > glob.peakRSSBytes) glob.peakRSSBytes = rss;
+        glob.sumUnreclaimed += unreclaimed;
+        glob.sumRSSBytes += rss;
+        ++glob.samples;
+    }
+    // release any threads that are still parked
+    for (int tid=0;tid<STALL_THREADS;++tid) {
+        glob.stallDeadlines[tid*PREFETCH_SIZE_WORDS] = 0;
+    }
+}
+#endif
+
 void trial() {
     INIT_ALL;
     papi_init_program(TOTAL_THREADS);
@@ -482,15 +803,20 @@ void trial() {
     glob.start = false;
     glob.done = false;
     glob.running = 0;
-    glob.__ds = (void *) DS_CONSTRUCTOR;
     glob.prefillIntervalElapsedMillis = 0;
     glob.prefillKeySum = 0;
-    DS_DECLARATION * ds = (DS_DECLARATION *) glob.__ds;
     
     // get random number generator seeded with time
     // we use this rng to seed per-thread rng's that use a different algorithm
     srand(time(NULL));
 
+#ifdef BULK_LOAD_SUPPORTED
+    glob.__ds = (void *) (PREFILL && BULK_PREFILL ? prefill_bulk() : DS_CONSTRUCTOR);
+#else
+    glob.__ds = (void *) DS_CONSTRUCTOR;
+#endif
+    DS_DECLARATION * ds = (DS_DECLARATION *) glob.__ds;
+
     // create thread data
     pthread_t *threads[TOTAL_THREADS];
     int ids[TOTAL_THREADS];
@@ -502,7 +828,7 @@ void trial() {
 
     DEINIT_ALL;
     
-    if (PREFILL) prefill((DS_DECLARATION *) glob.__ds);
+    if (PREFILL && !BULK_PREFILL) prefill((DS_DECLARATION *) glob.__ds);
 
     INIT_ALL;
 
@@ -515,11 +841,28 @@ void trial() {
     tsNap.tv_sec = 0;
     tsNap.tv_nsec = 10000000; // 10ms
 
+#ifdef RQ_PARALLEL_SUPPORTED
+    // create the helpers of each range query thread
+    if (RQ_PARALLELISM > 1) {
+        for (int r=0;r<RQ_THREADS;++r) {
+            int helperTids[RQ_PARALLELISM-1];
+            for (int j=0;j<RQ_PARALLELISM-1;++j) {
+                helperTids[j] = WORK_THREADS + RQ_THREADS + r*(RQ_PARALLELISM-1) + j;
+            }
+            rqHelpers[WORK_THREADS+r] = new rq_parallel<test_type, VALUE_TYPE>(WORK_THREADS+r, RQ_PARALLELISM-1, helperTids, RQSIZE+RQ_DEBUGGING_MAX_KEYS_PER_NODE);
+        }
+    }
+#endif
+
     // start all threads
     for (int i=0;i<TOTAL_THREADS;++i) {
         if (pthread_create(threads[i], NULL,
                     (i < WORK_THREADS
                        ? thread_timed
+#ifdef RQ_PARALLEL_SUPPORTED
+                       : i >= WORK_THREADS + RQ_THREADS
+                       ? thread_rq_helper
+#endif
                        : thread_rq), &ids[i])) {
             cerr<<"ERROR: could not create thread"<<endl;
             exit(-1);
@@ -539,6 +882,7 @@ void trial() {
     
     SOFTWARE_BARRIER;
     glob.startTime = chrono::high_resolution_clock::now();
+    debraEpochPolicy().statsStartTime = get_server_clock();
     __sync_synchronize();
     glob.start = true;
     SOFTWARE_BARRIER;
@@ -549,6 +893,11 @@ void trial() {
     //      if not, loop and sleep in small increments for up to 5s,
     //      and exit(-1) if running doesn't hit 0.
 
+#ifdef USE_GSTATS
+    if (SAMPLE_MILLIS > 0) {
+        sampleUntilDone(ds);
+    } else
+#endif
     if (MILLIS_TO_RUN > 0) {
         nanosleep(&tsExpected, NULL);
         SOFTWARE_BARRIER;
@@ -608,7 +957,205 @@ void trial() {
     for (int i=0;i<TOTAL_THREADS;++i) {
         delete threads[i];
     }
+#ifdef RQ_PARALLEL_SUPPORTED
+    if (RQ_PARALLELISM > 1) {
+        for (int r=0;r<RQ_THREADS;++r) {
+            delete rqHelpers[WORK_THREADS+r];
+        }
+    }
+#endif
+}
+
+#ifdef USE_GSTATS
+string jsonString(const string & str) {
+    string result = "\"";
+    for (unsigned i=0;i<str.size();++i) {
+        if (str[i] == '"' || str[i] == '\\') result += '\\';
+        result += str[i];
+    }
+    return result + "\"";
+}
+
+// sum of a stat over all threads, for each of its first n indices,
+// with trailing zeros removed
+vector<long long> jsonSumByIndex(const int stat, const int n) {
+    vector<long long> result;
+    for (int ix=0;ix<n;++ix) {
+        long long sum = 0;
+        for (int tid=0;tid<TOTAL_THREADS;++tid) {
+            sum += GSTATS_GET_IX(tid, stat, ix);
+        }
+        result.push_back(sum);
+    }
+    while (!result.empty() && result.back() == 0) result.pop_back();
+    return result;
+}
+
+string jsonArray(const vector<long long> & values) {
+    stringstream ss;
+    ss<<"[";
+    for (unsigned i=0;i<values.size();++i) ss<<(i?", ":"")<<values[i];
+    ss<<"]";
+    return ss.str();
+}
+
+string jsonLatency(const int log2_stat) {
+    vector<long long> buckets = jsonSumByIndex(log2_stat, LATENCY_LOG2_BUCKETS);
+    long long samples = 0;
+    for (unsigned i=0;i<buckets.size();++i) samples += buckets[i];
+    stringstream ss;
+    ss<<"{\"samples\": "<<samples<<", \"log2_buckets\": "<<jsonArray(buckets)<<"}";
+    return ss.str();
+}
+
+/**
+ * Write the results of a trial to JSON_OUTPUT_FILE, so scripts can track
+ * performance across builds without scraping the output above.
+ * Must be called after GSTATS_PRINT, and before the data structure is deleted.
+ * 
+ * latency.*.log2_buckets[i] is the number of sampled operations that took
+ * [2^i, 2^(i+1)) nanoseconds. limbo_size[i] and epoch_advances[i] describe
+ * the i-th slice of epoch_slice_millis milliseconds of the trial.
+ */
+void printOutputJSON(DS_DECLARATION * ds) {
+    ofstream out(JSON_OUTPUT_FILE);
+    if (!out) {
+        cout<<"ERROR: could not open "<<JSON_OUTPUT_FILE<<" for writing"<<endl;
+        exit(-1);
+    }
+    const double SECONDS_TO_RUN = (MILLIS_TO_RUN)/1000.;
+    const long long totalSearches = GSTATS_GET_STAT_METRICS(num_searches, TOTAL)[0].sum;
+    const long long totalRQs = GSTATS_GET_STAT_METRICS(num_rq, TOTAL)[0].sum;
+    const long long totalUpdates = GSTATS_GET_STAT_METRICS(num_updates, TOTAL)[0].sum;
+    const long long totalAll = totalSearches + totalRQs + totalUpdates;
+
+    out<<"{"<<endl;
+    out<<"  \"config\": {"<<endl;
+    out<<"    \"data_structure\": "<<jsonString(STR_VA(DS_DECLARATION))<<","<<endl;
+    out<<"    \"rq_func\": "<<jsonString(STR(RQ_FUNC))<<","<<endl;
+    out<<"    \"reclaim\": "<<jsonString(STR(RECLAIM))<<","<<endl;
+    out<<"    \"alloc\": "<<jsonString(STR(ALLOC))<<","<<endl;
+    out<<"    \"pool\": "<<jsonString(STR(POOL))<<","<<endl;
+    out<<"    \"ins\": "<<INS<<", \"del\": "<<DEL<<", \"rq\": "<<RQ<<", \"rqsize\": "<<RQSIZE<<", \"maxkey\": "<<MAXKEY<<","<<endl;
+    out<<"    \"work_threads\": "<<WORK_THREADS<<", \"rq_threads\": "<<RQ_THREADS<<", \"millis_to_run\": "<<MILLIS_TO_RUN<<","<<endl;
+    out<<"    \"prefill\": "<<PREFILL<<", \"bulk_prefill\": "<<BULK_PREFILL<<", \"batch_size\": "<<BATCH_SIZE<<","<<endl;
+    out<<"    \"succ\": "<<SUCC<<", \"rq_descending\": "<<RQ_DESCENDING<<", \"rq_cursor\": "<<RQ_CURSOR<<","<<endl;
+    out<<"    \"rq_streaming\": "<<RQ_STREAMING<<", \"rq_limit\": "<<RQ_LIMIT<<", \"rq_parallelism\": "<<RQ_PARALLELISM<<", \"latency_sample_period\": "<<LATENCY_SAMPLE_PERIOD<<endl;
+    out<<"  },"<<endl;
+    out<<"  \"elapsed_millis\": "<<glob.elapsedMillis<<","<<endl;
+    out<<"  \"throughput\": {\"total\": "<<(long long) (totalAll / SECONDS_TO_RUN)
+            <<", \"find\": "<<(long long) (totalSearches / SECONDS_TO_RUN)
+            <<", \"rq\": "<<(long long) (totalRQs / SECONDS_TO_RUN)
+            <<", \"update\": "<<(long long) (totalUpdates / SECONDS_TO_RUN)<<"},"<<endl;
+    out<<"  \"threads\": ["<<endl;
+    for (int tid=0;tid<TOTAL_THREADS;++tid) {
+        const long long ops = GSTATS_GET(tid, num_operations);
+        out<<"    {\"tid\": "<<tid<<", \"role\": "<<(tid < WORK_THREADS ? "\"work\"" : "\"rq\"")
+                <<", \"ops\": "<<ops<<", \"throughput\": "<<(long long) (ops / SECONDS_TO_RUN)<<"}"<<(tid+1 < TOTAL_THREADS ? "," : "")<<endl;
+    }
+    out<<"  ],"<<endl;
+    out<<"  \"latency\": {"<<endl;
+    out<<"    \"insert\": "<<jsonLatency(latency_log2_inserts)<<","<<endl;
+    out<<"    \"erase\": "<<jsonLatency(latency_log2_erases)<<","<<endl;
+    out<<"    \"find\": "<<jsonLatency(latency_log2_searches)<<","<<endl;
+    out<<"    \"rq\": "<<jsonLatency(latency_log2_rqs)<<endl;
+    out<<"  },"<<endl;
+    out<<"  \"epoch_slice_millis\": "<<debraEpochPolicy().statsSliceMillis<<","<<endl;
+    out<<"  \"limbo_size\": "<<jsonArray(jsonSumByIndex(limbo_size, 1000))<<","<<endl;
+    out<<"  \"epoch_advances\": "<<jsonArray(jsonSumByIndex(epoch_advances, 1000))<<","<<endl;
+    out<<"  \"memory\": {"<<endl;
+    out<<"    \"rss_bytes\": "<<debugInfo::getResidentBytes()<<","<<endl;
+    if (SAMPLE_MILLIS > 0) {
+        const long long samples = glob.samples;
+        out<<"    \"stalls\": {\"threads\": "<<STALL_THREADS<<", \"count\": "<<glob.stallsStarted
+                <<", \"millis\": "<<STALL_MILLIS<<", \"period_millis\": "<<STALL_PERIOD_MILLIS
+                <<", \"sample_millis\": "<<SAMPLE_MILLIS<<", \"samples\": "<<samples
+                <<", \"peak_unreclaimed\": "<<glob.peakUnreclaimed
+                <<", \"avg_unreclaimed\": "<<(samples ? glob.sumUnreclaimed / samples : 0)
+                <<", \"peak_rss_bytes\": "<<glob.peakRSSBytes
+                <<", \"avg_rss_bytes\": "<<(samples ? glob.sumRSSBytes / samples : 0)
+                <<", \"throughput_stalled\": "<<(glob.millisWhileStalled ? glob.opsWhileStalled * 1000 / glob.millisWhileStalled : 0)
+                <<", \"throughput_not_stalled\": "<<(glob.millisWhileNotStalled ? glob.opsWhileNotStalled * 1000 / glob.millisWhileNotStalled : 0)<<"},"<<endl;
+    }
+    out<<"    \"record_managers\": ";
+    MEMMGMT_T * recmgr = (MEMMGMT_T *) ds->debugGetRecMgr();
+    if (recmgr) recmgr->printStatusJSON(out); else out<<"[]";
+    out<<endl;
+    out<<"  }"<<endl;
+    out<<"}"<<endl;
+    out.close();
+    cout<<"wrote JSON output to "<<JSON_OUTPUT_FILE<<endl;
+}
+#endif
+
+#ifdef RQ_ORDERED_SUPPORTED
+/**
+ * once the trial is over (so the data structure does not change), walks all
+ * keys with chains of successor and predecessor queries, an ascending and a
+ * descending streaming range query, and an rq_cursor. each walk must visit
+ * keys in order, and the sum of the keys it visits must equal keySum.
+ */
+bool validateOrderedQueries(DS_DECLARATION * ds, const long long keySum) {
+    const int tid = 0;
+    INIT_THREAD(tid);
+    bool ordered = true;
+    test_type key;
+    VALUE_TYPE value;
+
+    long long successorSum = 0;
+    for (test_type from = 0; ds->successor(tid, from, &key, &value); from = key+1) {
+        if (key < from) { ordered = false; break; }
+        successorSum += key;
+    }
+    long long predecessorSum = 0;
+    for (test_type from = MAXKEY; ds->predecessor(tid, from, &key, &value); from = key-1) {
+        if (key > from) { ordered = false; break; }
+        predecessorSum += key;
+        if (key == 0) break;
+    }
+    long long ascendingSum = 0;
+    bool first = true;
+    test_type last = 0;
+    ds->rangeQuery(tid, 0, MAXKEY, 0, [&](const test_type& k, VALUE_TYPE const & v) {
+        if (!first && !(last < k)) ordered = false;
+        first = false;
+        last = k;
+        ascendingSum += k;
+        return true;
+    });
+    long long descendingSum = 0;
+    first = true;
+    ds->rangeQueryDescending(tid, 0, MAXKEY, 0, [&](const test_type& k, VALUE_TYPE const & v) {
+        if (!first && !(k < last)) ordered = false;
+        first = false;
+        last = k;
+        descendingSum += k;
+        return true;
+    });
+    long long cursorSum = 0;
+    {
+        rq_cursor<test_type, VALUE_TYPE, DS_DECLARATION> cursor (ds, tid, 0, MAXKEY);
+        first = true;
+        while (cursor.next(&key, &value)) {
+            if (!first && !(last < key)) ordered = false;
+            first = false;
+            last = key;
+            cursorSum += key;
+        }
+    }
+    DEINIT_THREAD(tid);
+
+    const long long violations = glob.orderViolations.load();
+    const bool ok = ordered && violations == 0
+            && successorSum == keySum && predecessorSum == keySum
+            && ascendingSum == keySum && descendingSum == keySum && cursorSum == keySum;
+    cout<<"Ordered query validation "<<(ok ? "OK" : "FAILURE")<<": keySum="<<keySum
+            <<" successorSum="<<successorSum<<" predecessorSum="<<predecessorSum
+            <<" ascendingSum="<<ascendingSum<<" descendingSum="<<descendingSum<<" cursorSum="<<cursorSum
+            <<" inOrder="<<ordered<<" orderViolations="<<violations<<endl;
+    return ok;
 }
+#endif
 
 void printOutput() {
     cout<<"PRODUCING OUTPUT"<<endl;
@@ -652,6 +1199,9 @@ void printOutput() {
         cout<<"Structural validation FAILURE."<<endl;
         exit(-1);
     }
+#ifdef RQ_ORDERED_SUPPORTED
+    if (!validateOrderedQueries(ds, threadsKeySum)) exit(-1);
+#endif
 
     long long totalAll = 0;
 
@@ -711,6 +1261,13 @@ void printOutput() {
         COUTATOMIC("update throughput             : "<<throughputUpdates<<endl);
         COUTATOMIC("query throughput              : "<<throughputQueries<<endl);
         COUTATOMIC("total throughput              : "<<throughputAll<<endl);
+#ifdef BLOCKBAG_SUMMARIES
+        const long long totalVisitedInBags = GSTATS_GET_STAT_METRICS(visited_in_bags, TOTAL)[0].sum;
+        const long long totalSummarySkippedInBags = GSTATS_GET_STAT_METRICS(summary_skipped_in_bags, TOTAL)[0].sum;
+        if (totalVisitedInBags + totalSummarySkippedInBags > 0) {
+            COUTATOMIC("limbo bag block skip ratio    : "<<(totalSummarySkippedInBags / (double) (totalVisitedInBags + totalSummarySkippedInBags))<<endl);
+        }
+#endif
         COUTATOMIC(endl);
     }
 #endif
@@ -719,6 +1276,25 @@ void printOutput() {
     COUTATOMIC("napping milliseconds overtime : "<<glob.elapsedMillisNapping<<endl);
     COUTATOMIC("data structure size           : "<<ds->getSizeString()<<endl);
     COUTATOMIC(endl);
+    if (SAMPLE_MILLIS > 0) {
+        const long long samples = glob.samples;
+        COUTATOMIC("stalled threads               : "<<STALL_THREADS<<endl);
+        COUTATOMIC("stalls                        : "<<glob.stallsStarted<<" ("<<STALL_MILLIS<<"ms every "<<STALL_PERIOD_MILLIS<<"ms)"<<endl);
+        COUTATOMIC("samples                       : "<<samples<<" (every "<<SAMPLE_MILLIS<<"ms)"<<endl);
+        COUTATOMIC("peak unreclaimed records      : "<<glob.peakUnreclaimed<<endl);
+        COUTATOMIC("avg unreclaimed records       : "<<(samples ? glob.sumUnreclaimed / samples : 0)<<endl);
+        COUTATOMIC("peak rss bytes                : "<<glob.peakRSSBytes<<endl);
+        COUTATOMIC("avg rss bytes                 : "<<(samples ? glob.sumRSSBytes / samples : 0)<<endl);
+        COUTATOMIC("throughput while stalled      : "<<(glob.millisWhileStalled ? glob.opsWhileStalled * 1000 / glob.millisWhileStalled : 0)<<endl);
+        COUTATOMIC("throughput while not stalled  : "<<(glob.millisWhileNotStalled ? glob.opsWhileNotStalled * 1000 / glob.millisWhileNotStalled : 0)<<endl);
+        COUTATOMIC(endl);
+    }
+    MEMMGMT_T * recmgr = (MEMMGMT_T *) ds->debugGetRecMgr();
+    if (recmgr) recmgr->printStatus();
+    
+#ifdef USE_GSTATS
+    if (JSON_OUTPUT_FILE) printOutputJSON(ds);
+#endif
     
 #if defined(USE_DEBUGCOUNTERS) || defined(USE_GSTATS)
     cout<<"begin papi_print_counters..."<<endl;
@@ -741,6 +1317,7 @@ int main(int argc, char** argv) {
     
     // setup default args
     PREFILL = false;            // must be false, or else there's no way to specify no prefilling on the command line...
+    BULK_PREFILL = false;
     MILLIS_TO_RUN = 1000;
     RQ_THREADS = 0;
     WORK_THREADS = 4;
@@ -749,6 +1326,19 @@ int main(int argc, char** argv) {
     INS = 10;
     DEL = 10;
     MAXKEY = 100000;
+    BATCH_SIZE = 0;
+    RQ_STREAMING = false;
+    RQ_LIMIT = 0;
+    RQ_DESCENDING = false;
+    RQ_CURSOR = false;
+    SUCC = 0;
+    RQ_PARALLELISM = 1;
+    LATENCY_SAMPLE_PERIOD = 64;
+    JSON_OUTPUT_FILE = NULL;
+    STALL_THREADS = 0;
+    STALL_MILLIS = 100;
+    STALL_PERIOD_MILLIS = 500;
+    SAMPLE_MILLIS = 0;
     
     // read command line args
     // example args: -i 25 -d 25 -k 10000 -rq 0 -rqsize 1000 -p -t 1000 -nrq 0 -nwork 8
@@ -769,8 +1359,57 @@ int main(int argc, char** argv) {
             WORK_THREADS = atoi(argv[++i]);
         } else if (strcmp(argv[i], "-t") == 0) {
             MILLIS_TO_RUN = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-batch") == 0) {
+            BATCH_SIZE = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-rqstream") == 0) {
+            RQ_STREAMING = true;
+        } else if (strcmp(argv[i], "-rqlimit") == 0) { // streaming range queries that stop after this many keys
+            RQ_STREAMING = true;
+            RQ_LIMIT = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-rqdesc") == 0) { // streaming range queries that pass their keys in decreasing order
+            RQ_STREAMING = true;
+            RQ_DESCENDING = true;
+        } else if (strcmp(argv[i], "-rqcursor") == 0) { // range queries that iterate over their range with an rq_cursor
+            RQ_STREAMING = true;
+            RQ_CURSOR = true;
+        } else if (strcmp(argv[i], "-succ") == 0) { // percentage of successor and predecessor queries
+            SUCC = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-rqpar") == 0) { // threads that perform each range query of a range query thread
+            RQ_PARALLELISM = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "-epochops") == 0) { // operations between checks of other threads' epochs (see debra_epoch_policy)
+            debraEpochPolicy().maxOpsBeforeRead = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-epochadapt") == 0) {
+            debraEpochPolicy().adaptive = true;
+        } else if (strcmp(argv[i], "-limbotarget") == 0) {
+            debraEpochPolicy().adaptive = true;
+            debraEpochPolicy().limboTarget = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-limboceiling") == 0) {
+            debraEpochPolicy().limboCeiling = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-latsample") == 0) { // measure the latency of one in this many operations
+            LATENCY_SAMPLE_PERIOD = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "-json") == 0) {
+            JSON_OUTPUT_FILE = argv[++i];
+        } else if (strcmp(argv[i], "-stall") == 0) { // park this many worker threads periodically
+            STALL_THREADS = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-stallms") == 0) {
+            STALL_MILLIS = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-stallperiod") == 0) {
+            STALL_PERIOD_MILLIS = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-sample") == 0) {
+            SAMPLE_MILLIS = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-slabsize") == 0) { // bytes per slab for allocator_bump (see allocator_bump_slab_policy)
+            bumpSlabPolicy().slabBytes = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-slabmmap") == 0) {
+            bumpSlabPolicy().useMmap = true;
+        } else if (strcmp(argv[i], "-slabhuge") == 0) {
+            bumpSlabPolicy().hugePages = true;
+        } else if (strcmp(argv[i], "-slabnuma") == 0) {
+            bumpSlabPolicy().numaLocal = true;
         } else if (strcmp(argv[i], "-p") == 0) {
             PREFILL = true;
+        } else if (strcmp(argv[i], "-pbulk") == 0) { // prefill with the bulk loading constructor
+            PREFILL = true;
+            BULK_PREFILL = true;
         } else if (strcmp(argv[i], "-bind") == 0) { // e.g., "-bind 1,2,3,8-11,4-7,0"
             binding_parseCustom(argv[++i]); // e.g., "1,2,3,8-11,4-7,0"
             cout<<"parsed custom binding: "<<argv[i]<<endl;
@@ -779,17 +1418,84 @@ int main(int argc, char** argv) {
             exit(1);
         }
     }
-    TOTAL_THREADS = WORK_THREADS + RQ_THREADS;
+    TOTAL_THREADS = WORK_THREADS + RQ_THREADS * RQ_PARALLELISM; // range query threads, then their helpers
+#ifndef BULK_LOAD_SUPPORTED
+    if (BULK_PREFILL) {
+        cout<<"ERROR: bulk loading (-pbulk) is not supported by this data structure"<<endl;
+        exit(-1);
+    }
+#endif
+#ifndef RQ_STREAMING_SUPPORTED
+    if (RQ_STREAMING) {
+        cout<<"ERROR: streaming range queries (-rqstream, -rqlimit) are not supported by this data structure and range query provider"<<endl;
+        exit(-1);
+    }
+#endif
+#ifndef RQ_ORDERED_SUPPORTED
+    if (RQ_DESCENDING || RQ_CURSOR || SUCC > 0) {
+        cout<<"ERROR: ordered queries (-rqdesc, -rqcursor, -succ) are not supported by this data structure and range query provider"<<endl;
+        exit(-1);
+    }
+#endif
+    if (RQ_DESCENDING && RQ_CURSOR) {
+        cout<<"ERROR: range queries cannot be both descending (-rqdesc) and use a cursor (-rqcursor)"<<endl;
+        exit(-1);
+    }
+    if (INS+DEL+RQ+SUCC > 100) {
+        cout<<"ERROR: -i, -d, -rq and -succ must add up to at most 100"<<endl;
+        exit(-1);
+    }
+#ifndef RQ_PARALLEL_SUPPORTED
+    if (RQ_PARALLELISM > 1) {
+        cout<<"ERROR: parallel range queries (-rqpar) are not supported by this data structure and range query provider"<<endl;
+        exit(-1);
+    }
+#endif
+    if (RQ_PARALLELISM > 1 && RQ_STREAMING) {
+        cout<<"ERROR: parallel range queries (-rqpar) cannot be streamed (-rqstream, -rqlimit)"<<endl;
+        exit(-1);
+    }
+    if (TOTAL_THREADS > MAX_TID_POW2) {
+        cout<<"ERROR: too many threads (-nwork + -nrq * -rqpar > MAX_TID_POW2="<<MAX_TID_POW2<<")"<<endl;
+        exit(-1);
+    }
+#ifndef USE_GSTATS
+    if (JSON_OUTPUT_FILE) {
+        cout<<"ERROR: JSON output (-json) requires USE_GSTATS"<<endl;
+        exit(-1);
+    }
+#endif
+    if (STALL_THREADS > 0 && SAMPLE_MILLIS <= 0) SAMPLE_MILLIS = 5;
+#ifndef USE_GSTATS
+    if (SAMPLE_MILLIS > 0) {
+        cout<<"ERROR: stalling and sampling (-stall, -sample) require USE_GSTATS"<<endl;
+        exit(-1);
+    }
+#endif
+    if (STALL_THREADS >= WORK_THREADS && STALL_THREADS > 0) {
+        cout<<"ERROR: -stall must be smaller than -nwork"<<endl;
+        exit(-1);
+    }
+#ifndef BATCH_UPDATES_SUPPORTED
+    if (BATCH_SIZE > 0) {
+        cout<<"ERROR: batch updates (-batch) are not supported by this data structure"<<endl;
+        exit(-1);
+    }
+#endif
     
     // print used args
     PRINTS(FIND_FUNC);
     PRINTS(INSERT_FUNC);
     PRINTS(ERASE_FUNC);
     PRINTS(RQ_FUNC);
+#ifdef HASHLIST_NAME
+    PRINTS(HASHLIST_NAME);
+#endif
     PRINTS(RECLAIM);
     PRINTS(ALLOC);
     PRINTS(POOL);
     PRINTI(PREFILL);
+    PRINTI(BULK_PREFILL);
     PRINTI(MILLIS_TO_RUN);
     PRINTI(INS);
     PRINTI(DEL);
@@ -798,6 +1504,27 @@ int main(int argc, char** argv) {
     PRINTI(MAXKEY);
     PRINTI(WORK_THREADS);
     PRINTI(RQ_THREADS);
+    PRINTI(BATCH_SIZE);
+    PRINTI(RQ_STREAMING);
+    PRINTI(RQ_LIMIT);
+    PRINTI(RQ_DESCENDING);
+    PRINTI(RQ_CURSOR);
+    PRINTI(SUCC);
+    PRINTI(RQ_PARALLELISM);
+    PRINTI(LATENCY_SAMPLE_PERIOD);
+    PRINTI(STALL_THREADS);
+    PRINTI(STALL_MILLIS);
+    PRINTI(STALL_PERIOD_MILLIS);
+    PRINTI(SAMPLE_MILLIS);
+    PRINTI_POLICY(debraEpochPolicy, adaptive);
+    PRINTI_POLICY(debraEpochPolicy, maxOpsBeforeRead);
+    PRINTI_POLICY(debraEpochPolicy, limboTarget);
+    PRINTI_POLICY(debraEpochPolicy, limboCeiling);
+    PRINTI_POLICY(debraEpochPolicy, statsSliceMillis);
+    PRINTI_POLICY(bumpSlabPolicy, useMmap);
+    PRINTI_POLICY(bumpSlabPolicy, hugePages);
+    PRINTI_POLICY(bumpSlabPolicy, numaLocal);
+    PRINTI_POLICY(bumpSlabPolicy, slabBytes);
 #ifdef WIDTH_SEQ
     PRINTI(WIDTH_SEQ);
 #endif
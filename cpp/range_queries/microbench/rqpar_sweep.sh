@@ -0,0 +1,38 @@
+#!/bin/bash
+#
+# Measures the throughput of large range queries that are split into
+# subtrees and traversed by 1..maxthreads threads (-rqpar), alongside updates.
+#
+# Usage: ./rqpar_sweep.sh [millis]
+
+source ../config.mk
+
+machine=`hostname`
+millis=3000
+if [ "$#" -eq "1" ] ; then millis=$1 ; fi
+
+trials=3
+u=10
+nwork=1
+nrq=1
+k=2000000
+rqsize=1000000
+alg=lockfree
+
+for ds in bst bslack ; do
+    make ${ds}.rq_${alg} > /dev/null || exit 1
+done
+
+cols="%8s %8s %8s %6s %6s %16s %16s\n"
+printf "${cols}" ds k rqsize rqpar trial throughput rqs
+
+for ds in bst bslack ; do
+    for ((rqpar=1;nwork+nrq*rqpar<=$maxthreads;rqpar=(rqpar<$threadincrement ? rqpar*2 : rqpar+$threadincrement))) ; do
+    for ((trial=0;trial<$trials;++trial)) ; do
+        cmd="./${machine}.${ds}.rq_${alg}.out -i $u -d $u -k $k -rq 0 -rqsize $rqsize -p -t $millis -nrq $nrq -nwork $nwork -rqpar $rqpar ${pinning_policy}"
+        out=`env LD_PRELOAD=../lib/libjemalloc.so TREE_MALLOC=../lib/libjemalloc.so $cmd`
+        if [ "`echo "$out" | grep 'Validation OK' | wc -l`" -eq "0" ] ; then echo "WARNING: validation failed for: $cmd" ; fi
+        printf "${cols}" $ds $k $rqsize $rqpar $trial "`echo "$out" | grep 'total throughput' | cut -d':' -f2 | tr -d ' '`" "`echo "$out" | grep 'total rq' | head -1 | cut -d':' -f2 | tr -d ' '`"
+    done
+    done
+done
@@ -0,0 +1,46 @@
+#!/bin/bash
+#
+# Compares the reader-writer locks that can be used by rq_rwlock
+# (see common/rwlock.h) on every data structure that supports rq_rwlock,
+# from 1 to maxthreads updating threads, plus one range query thread.
+# (Note: updates acquire the lock as readers, and range queries as writers.)
+# Builds one binary per lock (with suffix .<lock>), then runs each.
+#
+# Usage: ./rwlock_sweep.sh [millis]
+
+source ../config.mk
+
+machine=`hostname`
+millis=3000
+if [ "$#" -eq "1" ] ; then millis=$1 ; fi
+
+trials=3
+locks="FAVOR_READERS FAVOR_WRITERS BRAVO"
+dss="abtree bslack bst citrus lazylist lflist skiplistlock"
+
+for l in $locks ; do
+    for ds in $dss ; do
+        make ${ds}.rq_rwlock rwlock=$l filesuffix=.$l > /dev/null || exit 1
+    done
+done
+
+nrq=1
+rqsize=100
+
+cols="%14s %8s %14s %6s %6s %16s %16s\n"
+printf "${cols}" ds k rwlock nwork trial throughput updates
+for ds in $dss ; do
+    k=10000
+    if [ "$ds" == "lazylist" ] || [ "$ds" == "lflist" ] ; then k=1000 ; fi
+    if [ "$ds" == "abtree" ] || [ "$ds" == "bslack" ] ; then k=1000000 ; fi
+    for ((nwork=1;nwork<=$maxthreads;nwork=(nwork<$threadincrement ? nwork*2 : nwork+$threadincrement))) ; do
+    for l in $locks ; do
+    for ((trial=0;trial<$trials;++trial)) ; do
+        cmd="./${machine}.${ds}.rq_rwlock.${l}.out -i 50 -d 50 -k $k -rq 0 -rqsize $rqsize -p -t $millis -nrq $nrq -nwork $nwork ${pinning_policy}"
+        out=`env LD_PRELOAD=../lib/libjemalloc.so TREE_MALLOC=../lib/libjemalloc.so $cmd`
+        if [ "`echo "$out" | grep 'Validation OK' | wc -l`" -eq "0" ] ; then echo "WARNING: validation failed for: $cmd" ; fi
+        printf "${cols}" $ds $k $l $nwork $trial "`echo "$out" | grep 'total throughput' | cut -d':' -f2 | tr -d ' '`" "`echo "$out" | grep 'total updates' | cut -d':' -f2 | tr -d ' '`"
+    done
+    done
+    done
+done
@@ -15,33 +15,96 @@
 #include <cassert>
 #include <iostream>
 #include <vector>
+#include <sched.h>
+#include <sys/mman.h>
+#include "plaf.h"
+#ifdef HAS_LIBNUMA
+#include <numa.h>
+#endif
 using namespace std;
 
+/**
+ * How allocator_bump obtains its slabs (the large arrays that it
+ * bump-allocates objects from). Set these before creating a record manager.
+ * 
+ * By default, each slab is obtained with malloc. If useMmap is set, slabs are
+ * instead mapped with mmap, so they can be returned to the OS with munmap.
+ * If hugePages is set (which implies useMmap), each slab is first mapped with
+ * MAP_HUGETLB, and, if no huge pages are reserved, it is mapped normally and
+ * marked with madvise(MADV_HUGEPAGE) so transparent huge pages can back it.
+ * If numaLocal is set (which implies useMmap), each slab is bound to the
+ * NUMA node of the thread that allocates it (if libnuma is available;
+ * see HAS_LIBNUMA in plaf.h).
+ * 
+ * slabBytes is rounded up to a multiple of hugePageBytes when hugePages is set.
+ */
+struct allocator_bump_slab_policy {
+    bool useMmap;
+    bool hugePages;
+    bool numaLocal;
+    size_t slabBytes;
+    size_t hugePageBytes;
+};
+// the policy is shared by all translation units (see debraEpochPolicy in
+// reclaimer_debra.h)
+inline allocator_bump_slab_policy& bumpSlabPolicy() {
+    static allocator_bump_slab_policy policy = {false, false, false, 1<<24, 1<<21};
+    return policy;
+}
+
 template<typename T = void>
 class allocator_bump : public allocator_interface<T> {
     private:
         const int cachelines;    // # cachelines needed to store an object of type T
         // for bump allocation from a contiguous chunk of memory
         T ** mem;             // mem[tid*PREFETCH_SIZE_WORDS] = pointer to current array to perform bump allocation from
-        int * memBytes;       // memBytes[tid*PREFETCH_SIZE_WORDS] = size of mem in bytes
+        size_t * memBytes;    // memBytes[tid*PREFETCH_SIZE_WORDS] = size of mem in bytes
         T ** current;         // current[tid*PREFETCH_SIZE_WORDS] = pointer to current position in array mem
         vector<T*> ** toFree; // toFree[tid] = pointer to vector of bump allocation arrays to free when this allocator is destroyed
+        const allocator_bump_slab_policy policy; // copy of bumpSlabPolicy when this allocator was created
+        const bool mapped;    // whether slabs are obtained with mmap (and must be released with munmap)
 
         T* bump_memory_next(const int tid) {
             T* result = current[tid*PREFETCH_SIZE_WORDS];
             current[tid*PREFETCH_SIZE_WORDS] = (T*) (((char*) current[tid*PREFETCH_SIZE_WORDS]) + (cachelines*BYTES_IN_CACHE_LINE));
             return result;
         }
-        int bump_memory_bytes_remaining(const int tid) {
+        long bump_memory_bytes_remaining(const int tid) {
             return (((char*) mem[tid*PREFETCH_SIZE_WORDS])+memBytes[tid*PREFETCH_SIZE_WORDS]) - ((char*) current[tid*PREFETCH_SIZE_WORDS]);
         }
         bool bump_memory_full(const int tid) {
             return (((char*) current[tid*PREFETCH_SIZE_WORDS])+cachelines*BYTES_IN_CACHE_LINE > ((char*) mem[tid*PREFETCH_SIZE_WORDS])+memBytes[tid*PREFETCH_SIZE_WORDS]);
         }
+        // map a slab of the given size (see allocator_bump_slab_policy)
+        void * bump_memory_map(const size_t bytes) {
+            void * slab = MAP_FAILED;
+#ifdef MAP_HUGETLB
+            if (policy.hugePages) {
+                slab = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            }
+#endif
+            if (slab == MAP_FAILED) {
+                slab = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (slab == MAP_FAILED) {
+                    cerr<<"could not map a slab of "<<bytes<<" bytes"<<endl;
+                    exit(-1);
+                }
+#ifdef MADV_HUGEPAGE
+                if (policy.hugePages) madvise(slab, bytes, MADV_HUGEPAGE);
+#endif
+            }
+#ifdef HAS_LIBNUMA
+            // bind the slab before it is touched, so its pages are placed on our node
+            if (policy.numaLocal && numa_available() >= 0) {
+                numa_tonode_memory(slab, bytes, numa_node_of_cpu(sched_getcpu()));
+            }
+#endif
+            return slab;
+        }
         // call this when mem is null, or doesn't contain enough space to allocate an object
         void bump_memory_allocate(const int tid) {
-            mem[tid*PREFETCH_SIZE_WORDS] = (T*) malloc(1<<24);
-            memBytes[tid*PREFETCH_SIZE_WORDS] = 1<<24;
+            mem[tid*PREFETCH_SIZE_WORDS] = (T*) (mapped ? bump_memory_map(policy.slabBytes) : malloc(policy.slabBytes));
+            memBytes[tid*PREFETCH_SIZE_WORDS] = policy.slabBytes;
             current[tid*PREFETCH_SIZE_WORDS] = mem[tid*PREFETCH_SIZE_WORDS];
             toFree[tid]->push_back(mem[tid*PREFETCH_SIZE_WORDS]); // remember we allocated this to free it later
 #ifdef HAS_FUNCTION_aligned_alloc
@@ -72,6 +135,7 @@ class allocator_bump : public allocator_interface<T> {
                 bump_memory_allocate(tid);
                 MEMORY_STATS {
                     this->debug->addAllocated(tid, memBytes[tid*PREFETCH_SIZE_WORDS] / cachelines / BYTES_IN_CACHE_LINE);
+                    this->debug->addSlabs(tid, 1, memBytes[tid*PREFETCH_SIZE_WORDS]);
                     VERBOSE DEBUG2 {
 //                        if ((this->debug->getAllocated(tid) % 2000) == 0) {
 //                            this->debugInterfaces->reclaim->debugPrintStatus(tid);
@@ -102,12 +166,22 @@ class allocator_bump : public allocator_interface<T> {
 
         void initThread(const int tid) {}
         
+        static allocator_bump_slab_policy roundSlabPolicy(allocator_bump_slab_policy p) {
+            if (p.hugePages && p.hugePageBytes > 0) {
+                p.slabBytes = ((p.slabBytes + p.hugePageBytes - 1) / p.hugePageBytes) * p.hugePageBytes;
+            }
+            return p;
+        }
+
         allocator_bump(const int numProcesses, debugInfo * const _debug)
                 : allocator_interface<T>(numProcesses, _debug)
-                , cachelines((sizeof(T)+(BYTES_IN_CACHE_LINE-1))/BYTES_IN_CACHE_LINE){
+                , cachelines((sizeof(T)+(BYTES_IN_CACHE_LINE-1))/BYTES_IN_CACHE_LINE)
+                , policy(roundSlabPolicy(bumpSlabPolicy()))
+                , mapped(bumpSlabPolicy().useMmap || bumpSlabPolicy().hugePages || bumpSlabPolicy().numaLocal) {
             VERBOSE DEBUG COUTATOMIC("constructor allocator_bump"<<endl);
+            assert(policy.slabBytes >= (size_t) (2*cachelines*BYTES_IN_CACHE_LINE));
             mem = new T*[numProcesses*PREFETCH_SIZE_WORDS];
-            memBytes = new int[numProcesses*PREFETCH_SIZE_WORDS];
+            memBytes = new size_t[numProcesses*PREFETCH_SIZE_WORDS];
             current = new T*[numProcesses*PREFETCH_SIZE_WORDS];
             toFree = new vector<T*>*[numProcesses];
             for (int tid=0;tid<numProcesses;++tid) {
@@ -123,7 +197,12 @@ class allocator_bump : public allocator_interface<T> {
             for (int tid=0;tid<this->NUM_PROCESSES;++tid) {
                 int n = toFree[tid]->size();
                 for (int i=0;i<n;++i) {
-                    free((*toFree[tid])[i]);
+                    if (mapped) {
+                        // every slab this allocator mapped has the same size
+                        munmap((*toFree[tid])[i], policy.slabBytes);
+                    } else {
+                        free((*toFree[tid])[i]);
+                    }
                 }
                 delete toFree[tid];
             }
@@ -134,5 +213,5 @@ class allocator_bump : public allocator_interface<T> {
         }
     };
 
-#endif	/* ALLOC_NEW_H */
+#endif	/* ALLOC_BUMP_H */
 
@@ -9,6 +9,7 @@
 #define	BLOCKLIST_H
 
 #include <cassert>
+#include <climits>
 #include <iostream>
 #include "blockpool.h"
 #include "plaf.h"
@@ -28,18 +29,65 @@ class block;
 // BLOCK_SIZE must be a power of two, or else the bitwise math is invalid.
 #define BLOCK_SIZE (1<<8)
     
+#ifdef BLOCKBAG_SUMMARIES
+    // summary of the objects in a block: the range of their keys and of their
+    // (deletion) times. keys and times are opaque to the record manager.
+    // they are supplied by whoever adds an object to a bag, and let concurrent
+    // iterators (e.g., range queries scanning limbo bags) skip entire blocks.
+    // an empty key range has minKey > maxKey.
+    // an object added without a summary makes the summary unbounded.
+    struct blockbag_summary {
+        long long minKey;
+        long long maxKey;
+        long long minTime;
+        long long maxTime;
+        
+        void clear() {
+            minKey = LLONG_MAX; maxKey = LLONG_MIN;
+            minTime = LLONG_MAX; maxTime = LLONG_MIN;
+        }
+        void setUnbounded() {
+            minKey = LLONG_MIN; maxKey = LLONG_MAX;
+            minTime = LLONG_MIN; maxTime = LLONG_MAX;
+        }
+        void addKey(const long long key) {
+            if (key < minKey) minKey = key;
+            if (key > maxKey) maxKey = key;
+        }
+        void addTime(const long long time) {
+            if (time < minTime) minTime = time;
+            if (time > maxTime) maxTime = time;
+        }
+        void add(const blockbag_summary& other) {
+            if (other.minKey < minKey) minKey = other.minKey;
+            if (other.maxKey > maxKey) maxKey = other.maxKey;
+            if (other.minTime < minTime) minTime = other.minTime;
+            if (other.maxTime > maxTime) maxTime = other.maxTime;
+        }
+    };
+#endif
+
     template <typename T>
     class block { // stack implemented as an array
         private:
             volatile char padding0[PREFETCH_SIZE_BYTES];
             T * data[BLOCK_SIZE];
             int size;
+#ifdef BLOCKBAG_SUMMARIES
+            // only ever grows while the block is in use, and it is updated
+            // BEFORE size, so anyone who reads size and THEN the summary
+            // sees a summary that covers every object they can see.
+            blockbag_summary summary;
+#endif
             volatile char padding1[PREFETCH_SIZE_BYTES];
         public:
             block<T> *next;
             
             block(block<T> * const _next) : next(_next) {
                 size = 0;
+#ifdef BLOCKBAG_SUMMARIES
+                summary.clear();
+#endif
             }
             ~block() {
                 assert(size == 0);
@@ -57,9 +105,32 @@ class block;
                 const int sz = size;
                 //assert(interruptible[((long) ((int *) pthread_getspecific(pthreadkey)))*PREFETCH_SIZE_WORDS] == false);
                 data[size] = obj;
+#ifdef BLOCKBAG_SUMMARIES
+                summary.setUnbounded();
+#endif
+                SOFTWARE_BARRIER;
+                size = sz+1;
+            }
+#ifdef BLOCKBAG_SUMMARIES
+            // precondition: !isFull()
+            void push(T * const obj, const blockbag_summary& objSummary) {
+                assert(size < BLOCK_SIZE);
+                const int sz = size;
+                data[size] = obj;
+                summary.add(objSummary);
                 SOFTWARE_BARRIER;
                 size = sz+1;
             }
+            // read the summary AFTER computeSize() (see above)
+            blockbag_summary getSummary() {
+                SOFTWARE_BARRIER;
+                return summary;
+            }
+            void addToSummary(const blockbag_summary& other) {
+                summary.add(other);
+                SOFTWARE_BARRIER;
+            }
+#endif
             // precondition: !isEmpty()
             T* pop() {
                 assert(size > 0);
@@ -224,6 +295,11 @@ class block;
             }
             return *this;
         }
+        // the next increment will move to the next block,
+        // skipping the remaining items in the current block
+        inline void skipToEndOfBlock() {
+            ix = 0;
+        }
         void swap(block<T> * const otherCurr, const int otherIx) {
             T * const temp = otherCurr->peek(otherIx);
             otherCurr->replace(otherIx, curr->peek(ix));
@@ -378,6 +454,23 @@ class block;
             DEBUG2 validate();
         }
         
+#ifdef BLOCKBAG_SUMMARIES
+        void add(T * const obj, const blockbag_summary& objSummary) {
+            DEBUG2 validate();
+            int oldsize; DEBUG2 oldsize = computeSize();
+            head->push(obj, objSummary);
+            if (head->isFull()) {
+                block<T> *newblock = pool->allocateBlock(head);
+                ++sizeInBlocks;
+                SOFTWARE_BARRIER;
+                head = newblock;
+                DEBUG2 assert(sizeInBlocks == computeSizeInBlocks());
+            }
+            DEBUG2 assert(oldsize + 1 == computeSize());
+            DEBUG2 validate();
+        }
+#endif
+        
         template <typename Alloc>
         void add(const int tid, T * const obj, lockfreeblockbag<T> * const sharedBag, const int thresh, Alloc * const alloc) {
             DEBUG2 validate();
@@ -440,6 +533,9 @@ class block;
                 // then, we replace the object to be erased
                 // with the object taken from the head block.
                 T* obj = head->pop();
+#ifdef BLOCKBAG_SUMMARIES
+                curr->addToSummary(head->getSummary()); // obj moves from head to curr
+#endif
                 curr->replace(ix, obj);
                 DEBUG2 validate();
                 return true;
@@ -9,6 +9,8 @@
 #define	DEBUG_INFO_H
 
 #include "plaf.h"
+#include <cstdio>
+#include <unistd.h>
 
 struct _memrecl_counters {
     volatile char padding1[PREFETCH_SIZE_BYTES];
@@ -18,7 +20,10 @@ struct _memrecl_counters {
     long toPool; // how many objects have been added to this pool
     long given; // how many blocks have been moved from this pool to a shared pool
     long taken; // how many blocks have been moved from a shared pool to this pool
+    long takenRemote; // how many of the blocks taken came from a shared pool on another NUMA node
     long retired; // how many objects have been retired
+    long slabs; // how many slabs of memory an allocator has obtained from the OS
+    long long slabBytes; // total size of those slabs
     volatile char padding2[PREFETCH_SIZE_BYTES];
 };
 
@@ -35,7 +40,10 @@ public:
             c[tid].toPool = 0;
             c[tid].given = 0;
             c[tid].taken = 0;
+            c[tid].takenRemote = 0;
             c[tid].retired = 0;
+            c[tid].slabs = 0;
+            c[tid].slabBytes = 0;
         }
     }
     void addAllocated(const int tid, const int val) {
@@ -56,9 +64,16 @@ public:
     void addTaken(const int tid, const int val) {
         c[tid].taken += val;
     }
+    void addTakenRemote(const int tid, const int val) {
+        c[tid].takenRemote += val;
+    }
     void addRetired(const int tid, const int val) {
         c[tid].retired += val;
     }
+    void addSlabs(const int tid, const int val, const long long bytes) {
+        c[tid].slabs += val;
+        c[tid].slabBytes += bytes;
+    }
     long getAllocated(const int tid) {
         return c[tid].allocated;
     }
@@ -77,9 +92,18 @@ public:
     long getTaken(const int tid) {
         return c[tid].taken;
     }
+    long getTakenRemote(const int tid) {
+        return c[tid].takenRemote;
+    }
     long getRetired(const int tid) {
         return c[tid].retired;
     }
+    long getSlabs(const int tid) {
+        return c[tid].slabs;
+    }
+    long long getSlabBytes(const int tid) {
+        return c[tid].slabBytes;
+    }
     long getTotalAllocated() {
         long result = 0;
         for (int tid=0;tid<NUM_PROCESSES;++tid) {
@@ -122,6 +146,13 @@ public:
         }
         return result;
     }
+    long getTotalTakenRemote() {
+        long result = 0;
+        for (int tid=0;tid<NUM_PROCESSES;++tid) {
+            result += getTakenRemote(tid);
+        }
+        return result;
+    }
     long getTotalRetired() {
         long result = 0;
         for (int tid=0;tid<NUM_PROCESSES;++tid) {
@@ -129,6 +160,30 @@ public:
         }
         return result;
     }
+    long getTotalSlabs() {
+        long result = 0;
+        for (int tid=0;tid<NUM_PROCESSES;++tid) {
+            result += getSlabs(tid);
+        }
+        return result;
+    }
+    long long getTotalSlabBytes() {
+        long long result = 0;
+        for (int tid=0;tid<NUM_PROCESSES;++tid) {
+            result += getSlabBytes(tid);
+        }
+        return result;
+    }
+    // resident set size of the whole process (from /proc/self/statm), or -1
+    static long long getResidentBytes() {
+        long long pages = -1;
+        FILE * f = fopen("/proc/self/statm", "r");
+        if (f) {
+            if (fscanf(f, "%*lld %lld", &pages) != 1) pages = -1;
+            fclose(f);
+        }
+        return (pages < 0) ? -1 : pages * sysconf(_SC_PAGESIZE);
+    }
     debugInfo(int numProcesses) : NUM_PROCESSES(numProcesses) {
         c = new _memrecl_counters[numProcesses];
         clear();
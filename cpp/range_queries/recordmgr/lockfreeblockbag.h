@@ -34,17 +34,38 @@ private:
         block<T> *ptr;
         long tag;
     };
+    union tagged_ptr_word {
+        tagged_ptr value;
+        __int128 word;
+    };
     // TODO: add padding
-    std::atomic<tagged_ptr> head;
+    // (std::atomic<tagged_ptr> is not lock-free with newer compilers,
+    //  so we use the double-wide CAS builtin, which requires -mcx16)
+    volatile __int128 head __attribute__((aligned(16)));
+    
+    // note: the two halves of head may be read at different times,
+    // but then the subsequent CAS on head will fail
+    inline tagged_ptr readHead() {
+        tagged_ptr_word w;
+        w.word = head;
+        return w.value;
+    }
+    inline bool casHead(const tagged_ptr expected, const tagged_ptr newValue) {
+        tagged_ptr_word exp, val;
+        exp.value = expected;
+        val.value = newValue;
+        return __sync_bool_compare_and_swap(&head, exp.word, val.word);
+    }
 public:
     lockfreeblockbag() {
-        VERBOSE DEBUG cout<<"constructor lockfreeblockbag lockfree="<<head.is_lock_free()<<endl;
-        assert(head.is_lock_free());
-        head.store(tagged_ptr({NULL,0}));
+        VERBOSE DEBUG cout<<"constructor lockfreeblockbag"<<endl;
+        tagged_ptr_word w;
+        w.value = tagged_ptr({NULL,0});
+        head = w.word;
     }
     ~lockfreeblockbag() {
         VERBOSE DEBUG cout<<"destructor lockfreeblockbag; ";
-        block<T> *curr = head.load(memory_order_relaxed).ptr;
+        block<T> *curr = readHead().ptr;
         int debugFreed = 0;
         while (curr) {
             block<T> * const temp = curr;
@@ -56,11 +77,9 @@ public:
     }
     block<T>* getBlock() {
         while (true) {
-            tagged_ptr expHead = head.load(memory_order_relaxed);
+            tagged_ptr expHead = readHead();
             if (expHead.ptr != NULL) {
-                if (head.compare_exchange_weak(
-                        expHead,
-                        tagged_ptr({expHead.ptr->next, expHead.tag+1}))) {
+                if (casHead(expHead, tagged_ptr({expHead.ptr->next, expHead.tag+1}))) {
                     block<T> *result = expHead.ptr;
                     result->next = NULL;
                     return result;
@@ -72,11 +91,9 @@ public:
     }
     void addBlock(block<T> *b) {
         while (true) {
-            tagged_ptr expHead = head.load(memory_order_relaxed);
+            tagged_ptr expHead = readHead();
             b->next = expHead.ptr;
-            if (head.compare_exchange_weak(
-                    expHead,
-                    tagged_ptr({b, expHead.tag+1}))) {
+            if (casHead(expHead, tagged_ptr({b, expHead.tag+1}))) {
                 return;
             }
         }
@@ -84,7 +101,7 @@ public:
     // NOT thread safe
     int sizeInBlocks() {
         int result = 0;
-        block<T> *curr = head.load(memory_order_relaxed).ptr;
+        block<T> *curr = readHead().ptr;
         while (curr) {
             ++result;
             curr = curr->next;
@@ -95,13 +112,13 @@ public:
     long long size() {
         while (1) {
             long long result = 0;
-            block<T> *originalHead = head.load(memory_order_relaxed).ptr;
+            block<T> *originalHead = readHead().ptr;
             block<T> *curr = originalHead;
             while (curr) {
                 result += curr->computeSize();
                 curr = curr->next;
             }
-            if (head.load(memory_order_relaxed).ptr == originalHead) {
+            if (readHead().ptr == originalHead) {
                 return result;
             }
         }
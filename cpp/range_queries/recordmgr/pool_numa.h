@@ -0,0 +1,200 @@
+/**
+ * NUMA-aware variant of pool_perthread_and_shared.
+ * 
+ * Instead of a single shared bag, there is one shared bag per NUMA node.
+ * Threads give full blocks of free objects to the shared bag of their own
+ * NUMA node, and take blocks from their own node's shared bag first,
+ * only taking blocks from other nodes' shared bags when their own is empty.
+ * So, as long as there are free objects on the local node, freed objects
+ * do not migrate across sockets.
+ * 
+ * A thread's NUMA node is determined the first time it uses the pool,
+ * so threads should be pinned to processors before then (e.g., with -bind).
+ * Without libnuma (see HAS_LIBNUMA in plaf.h), there is one shared bag.
+ * 
+ * With MEMORY_STATS, debugInfo counts the blocks taken from shared bags
+ * (taken), and how many of them came from another NUMA node (takenRemote).
+ */
+
+#ifndef POOL_NUMA_H
+#define	POOL_NUMA_H
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <sched.h>
+#include "plaf.h"
+#ifdef HAS_LIBNUMA
+#include <numa.h>
+#endif
+#include "blockbag.h"
+#include "blockpool.h"
+#include "pool_interface.h"
+#include "globals.h"
+using namespace std;
+
+#ifndef POOL_THRESHOLD_IN_BLOCKS
+#define POOL_THRESHOLD_IN_BLOCKS 10
+#endif
+
+template <typename T = void, class Alloc = allocator_interface<T> >
+class pool_numa : public pool_interface<T, Alloc> {
+private:
+    int numNodes;
+    lockfreeblockbag<T> **sharedBags;     // sharedBags[node] = shared bag that threads on node offload blocks on when they have too many in their freeBag
+    blockbag<T> **freeBag;                // freeBag[tid] = bag of objects of type T that are ready to be reused by the thread with id tid
+    int *nodeOf;                          // nodeOf[tid] = NUMA node of thread tid (or -1 if it is not yet known)
+
+    inline int getNode(const int tid) {
+        int node = nodeOf[tid];
+        if (node < 0) {
+#ifdef HAS_LIBNUMA
+            node = (numNodes > 1) ? numa_node_of_cpu(sched_getcpu()) : 0;
+#else
+            node = 0;
+#endif
+            if (node < 0 || node >= numNodes) node = 0;
+            nodeOf[tid] = node;
+        }
+        return node;
+    }
+    
+    // note: only does something if freeBag contains at least two full blocks
+    inline bool tryGiveFreeObjects(const int tid) {
+        if (freeBag[tid]->getSizeInBlocks() >= POOL_THRESHOLD_IN_BLOCKS) {
+            block<T> *b = freeBag[tid]->removeFullBlock(); // returns NULL if freeBag has < 2 full blocks
+            assert(b);
+            sharedBags[getNode(tid)]->addBlock(b);
+            MEMORY_STATS this->debug->addGiven(tid, 1);
+            return true;
+        }
+        return false;
+    }
+    
+    // take a block from the shared bag of our node, or, if it is empty,
+    // from the shared bag of the next node that has one
+    inline bool tryTakeFreeObjects(const int tid) {
+        const int node = getNode(tid);
+        for (int i=0;i<numNodes;++i) {
+            const int other = (node+i) % numNodes;
+            block<T> *b = sharedBags[other]->getBlock();
+            if (b) {
+                freeBag[tid]->addFullBlock(b);
+                MEMORY_STATS this->debug->addTaken(tid, 1);
+                MEMORY_STATS if (other != node) this->debug->addTakenRemote(tid, 1);
+                return true;
+            }
+        }
+        return false;
+    }
+public:
+    template<typename _Tp1>
+    struct rebind {
+        typedef pool_numa<_Tp1, Alloc> other;
+    };
+    template<typename _Tp1, typename _Tp2>
+    struct rebind2 {
+        typedef pool_numa<_Tp1, _Tp2> other;
+    };
+    
+    string getSizeString() {
+        stringstream ss;
+        long long insharedbags = 0;
+        for (int node=0;node<numNodes;++node) {
+            insharedbags += sharedBags[node]->size();
+        }
+        long long infreebags = 0;
+        for (int tid=0;tid<this->NUM_PROCESSES;++tid) {
+            infreebags += freeBag[tid]->computeSize();
+        }
+        const long long taken = this->debug->getTotalTaken();
+        const long long takenRemote = this->debug->getTotalTakenRemote();
+        ss<<infreebags<<" in free bags and "<<insharedbags<<" in the shared bags of "<<numNodes<<" numa nodes; "
+          <<(taken-takenRemote)<<" blocks taken from the local node and "<<takenRemote<<" from remote nodes";
+        return ss.str();
+    }
+    
+    /**
+     * if the freebag contains any object, then remove one from the freebag
+     * and return a pointer to it.
+     * if not, then take a block of objects from a shared bag (preferring
+     * the local NUMA node), or, if they are all empty, retrieve new objects from Alloc
+     */
+    inline T* get(const int tid) {
+        MEMORY_STATS2 this->alloc->debug->addFromPool(tid, 1);
+        if (freeBag[tid]->isEmpty()) tryTakeFreeObjects(tid);
+        return freeBag[tid]->template remove<Alloc>(tid, sharedBags[getNode(tid)], this->alloc);
+    }
+    inline void add(const int tid, T* ptr) {
+        MEMORY_STATS2 this->debug->addToPool(tid, 1);
+        freeBag[tid]->add(tid, ptr, sharedBags[getNode(tid)], POOL_THRESHOLD_IN_BLOCKS, this->alloc);
+    }
+    inline void addMoveFullBlocks(const int tid, blockbag<T> *bag, block<T> * const predecessor) {
+        // WARNING: THE FOLLOWING DEBUG COMPUTATION GETS THE WRONG NUMBER OF BLOCKS.
+        MEMORY_STATS2 this->debug->addToPool(tid, (bag->getSizeInBlocks()-1)*BLOCK_SIZE);
+        freeBag[tid]->appendMoveFullBlocks(bag, predecessor);
+        while (tryGiveFreeObjects(tid)) {}
+    }
+    inline void addMoveFullBlocks(const int tid, blockbag<T> *bag) {
+        // WARNING: THE FOLLOWING DEBUG COMPUTATION GETS THE WRONG NUMBER OF BLOCKS.
+        MEMORY_STATS2 this->debug->addToPool(tid, (bag->getSizeInBlocks()-1)*BLOCK_SIZE);
+        freeBag[tid]->appendMoveFullBlocks(bag);
+        while (tryGiveFreeObjects(tid)) {}
+    }
+    inline void addMoveAll(const int tid, blockbag<T> *bag) {
+        MEMORY_STATS2 this->debug->addToPool(tid, bag->computeSize());
+        freeBag[tid]->appendMoveAll(bag);
+        while (tryGiveFreeObjects(tid)) {}
+    }
+    inline int computeSize(const int tid) {
+        return freeBag[tid]->computeSize();
+    }
+    
+    void debugPrintStatus(const int tid) {}
+    
+    pool_numa(const int numProcesses, Alloc * const _alloc, debugInfo * const _debug)
+            : pool_interface<T, Alloc>(numProcesses, _alloc, _debug) {
+        VERBOSE DEBUG COUTATOMIC("constructor pool_numa"<<endl);
+#ifdef HAS_LIBNUMA
+        numNodes = (numa_available() < 0) ? 1 : numa_max_node()+1;
+#else
+        numNodes = 1;
+#endif
+        sharedBags = new lockfreeblockbag<T>*[numNodes];
+        for (int node=0;node<numNodes;++node) {
+            sharedBags[node] = new lockfreeblockbag<T>();
+        }
+        freeBag = new blockbag<T>*[numProcesses];
+        nodeOf = new int[numProcesses];
+        for (int tid=0;tid<numProcesses;++tid) {
+            freeBag[tid] = new blockbag<T>(tid, this->blockpools[tid]);
+            nodeOf[tid] = -1;
+        }
+    }
+    ~pool_numa() {
+        VERBOSE DEBUG COUTATOMIC("destructor pool_numa"<<endl);
+        // clean up shared bags
+        const int dummyTid = 0;
+        for (int node=0;node<numNodes;++node) {
+            block<T> *fullBlock;
+            while ((fullBlock = sharedBags[node]->getBlock()) != NULL) {
+                while (!fullBlock->isEmpty()) {
+                    T * const ptr = fullBlock->pop();
+                    this->alloc->deallocate(dummyTid, ptr);
+                }
+                this->blockpools[dummyTid]->deallocateBlock(fullBlock);
+            }
+            delete sharedBags[node];
+        }
+        delete[] sharedBags;
+        // clean up free bags
+        for (int tid=0;tid<this->NUM_PROCESSES;++tid) {
+            this->alloc->deallocateAndClear(tid, freeBag[tid]);
+            delete freeBag[tid];
+        }
+        delete[] freeBag;
+        delete[] nodeOf;
+    }
+};
+
+#endif
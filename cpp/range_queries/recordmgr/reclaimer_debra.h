@@ -18,7 +18,54 @@
 #include "reclaimer_interface.h"
 using namespace std;
 
+#ifdef RAPID_RECLAMATION
+#define MIN_OPS_BEFORE_READ 1
+//#define MIN_OPS_BEFORE_CAS_EPOCH 1
+#else
+#define MIN_OPS_BEFORE_READ 20
+//#define MIN_OPS_BEFORE_CAS_EPOCH 100
+#endif
 
+/**
+ * Runtime policy that controls how often each thread checks the epochs
+ * announced by other threads, and, hence, how quickly the epoch advances.
+ * Set these fields before creating a record manager.
+ * 
+ * If adaptive is false, a thread checks one other thread every
+ * maxOpsBeforeRead operations (as in the original algorithm).
+ * 
+ * If adaptive is true, each time a thread sees the epoch change, it picks
+ * its number of operations between checks (in [minOpsBeforeRead, maxOpsBeforeRead])
+ * based on the size of its limbo bags and the rate at which it retired objects
+ * in the last epoch: the epoch cannot advance until all threads have been
+ * checked, so a thread checks often enough that its limbo bags should not
+ * grow beyond limboTarget objects before it has checked all threads.
+ * A thread that did not retire anything in the last epoch checks rarely.
+ * 
+ * If limboCeiling > 0 and a thread's limbo bags contain more than
+ * limboCeiling objects, the thread checks all other threads in every
+ * operation, until the epoch advances.
+ * 
+ * With stats enabled (__HANDLE_STATS), epoch advances and limbo bag sizes are
+ * recorded per time slice of statsSliceMillis milliseconds, starting at
+ * statsStartTime (from get_server_clock(); 0 means do not record).
+ */
+struct debra_epoch_policy {
+    bool adaptive;
+    int minOpsBeforeRead;
+    int maxOpsBeforeRead;
+    long long limboTarget;
+    long long limboCeiling;
+    int statsSliceMillis;
+    long long statsStartTime;
+};
+// the policy is shared by all translation units (a variable defined static in
+// this header would give each translation unit its own copy). it is constant
+// initialized, so calling this has no initialization check.
+inline debra_epoch_policy& debraEpochPolicy() {
+    static debra_epoch_policy policy = {false, 1, MIN_OPS_BEFORE_READ, 16*BLOCK_SIZE, 0, 100, 0};
+    return policy;
+}
 
 template <typename T = void, class Pool = pool_interface<T> >
 class reclaimer_debra : public reclaimer_interface<T, Pool> {
@@ -27,14 +74,6 @@ protected:
 #define BITS_EPOCH(ann) ((ann)&~(EPOCH_INCREMENT-1))
 #define QUIESCENT(ann) ((ann)&1)
 #define GET_WITH_QUIESCENT(ann) ((ann)|1)
-
-#ifdef RAPID_RECLAMATION
-#define MIN_OPS_BEFORE_READ 1
-//#define MIN_OPS_BEFORE_CAS_EPOCH 1
-#else
-#define MIN_OPS_BEFORE_READ 20
-//#define MIN_OPS_BEFORE_CAS_EPOCH 100
-#endif
     
 #define NUMBER_OF_EPOCH_BAGS 9
 #define NUMBER_OF_ALWAYS_EMPTY_EPOCH_BAGS 3
@@ -57,6 +96,10 @@ protected:
         blockbag<T> * currentBag;  // pointer to current epoch bag for this process
         int checked;               // how far we've come in checking the announced epochs of other threads
         int opsSinceRead;
+        int opsBeforeRead;         // chosen by debraEpochPolicy
+        long long limboSize;       // number of objects in this process' epoch bags
+        long long opsThisEpoch;    // since this process last saw the epoch change
+        long long retiredThisEpoch;
         ThreadData() {}
     private:
         volatile char padding3[PREFETCH_SIZE_BYTES];
@@ -206,6 +249,14 @@ public:
         ss<<getSizeInNodes()<<" in epoch bags";
         return ss.str();
     }
+    // uses the per-thread limbo counters, since the owner may be modifying its bags
+    long long getApproxSizeInNodes() {
+        long long sum = 0;
+        for (int tid=0;tid<this->NUM_PROCESSES;++tid) {
+            sum += threadData[tid].limboSize;
+        }
+        return sum;
+    }
     
     inline static bool quiescenceIsPerRecordType() { return false; }
     
@@ -229,11 +280,46 @@ public:
     inline static void qUnprotectAll(const int tid) {}
     inline static bool shouldHelp() { return true; }
     
+#ifdef __HANDLE_STATS
+    // index of the current time slice for stats (or -1 if stats should not be recorded)
+    inline static int getStatsSlice() {
+        const long long start = debraEpochPolicy().statsStartTime;
+        if (start == 0) return -1;
+        const long long slice = ((long long) get_server_clock() - start) / (debraEpochPolicy().statsSliceMillis * 1000000LL);
+        return (slice < 0 || slice > INT_MAX) ? -1 : (int) slice;
+    }
+#endif
+    
+    // choose how many operations thread tid performs between checks of
+    // other threads' announced epochs (see debra_epoch_policy)
+    inline void adaptOpsBeforeRead(const int tid) {
+        ThreadData * const td = &threadData[tid];
+        const long long target = debraEpochPolicy().limboTarget;
+        long long ops;
+        if (td->limboSize >= target) {
+            ops = debraEpochPolicy().minOpsBeforeRead;
+        } else if (td->retiredThisEpoch == 0) {
+            ops = debraEpochPolicy().maxOpsBeforeRead;
+        } else {
+            // we retired retiredThisEpoch/opsThisEpoch objects per operation,
+            // and we must check NUM_PROCESSES threads before the epoch can advance
+            ops = (target - td->limboSize) * td->opsThisEpoch / (td->retiredThisEpoch * this->NUM_PROCESSES);
+        }
+        if (ops < debraEpochPolicy().minOpsBeforeRead) ops = debraEpochPolicy().minOpsBeforeRead;
+        if (ops > debraEpochPolicy().maxOpsBeforeRead) ops = debraEpochPolicy().maxOpsBeforeRead;
+        td->opsBeforeRead = (int) ops;
+    }
+    
     // rotate the epoch bags and reclaim any objects retired two epochs ago.
     inline void rotateEpochBags(const int tid) {
         int nextIndex = (threadData[tid].index+1) % NUMBER_OF_EPOCH_BAGS;
         blockbag<T> * const freeable = threadData[tid].epochbags[(nextIndex+NUMBER_OF_ALWAYS_EMPTY_EPOCH_BAGS) % NUMBER_OF_EPOCH_BAGS];
+        const int oldSizeInBlocks = freeable->getSizeInBlocks();
         this->pool->addMoveFullBlocks(tid, freeable); // moves any full blocks (may leave a non-full block behind)
+        threadData[tid].limboSize -= (long long) (oldSizeInBlocks - freeable->getSizeInBlocks()) * BLOCK_SIZE;
+        if (debraEpochPolicy().adaptive) adaptOpsBeforeRead(tid);
+        threadData[tid].opsThisEpoch = 0;
+        threadData[tid].retiredThisEpoch = 0;
         SOFTWARE_BARRIER;
         threadData[tid].index = nextIndex;
         threadData[tid].currentBag = threadData[tid].epochbags[nextIndex];
@@ -254,6 +340,8 @@ public:
         // note: readEpoch, when written to announcedEpoch[tid],
         //       sets the state to non-quiescent and non-neutralized
 
+        ++threadData[tid].opsThisEpoch;
+
         // if our announced epoch was different from the current epoch
         if (readEpoch != ann /* invariant: ann is not quiescent */) {
             // rotate the epoch bags and
@@ -262,6 +350,16 @@ public:
             for (int i=0;i<numReclaimers;++i) {
                 ((reclaimer_debra<T, Pool> * const) reclaimers[i])->rotateEpochBags(tid);
             }
+#ifdef __HANDLE_STATS
+            const int slice = getStatsSlice();
+            if (slice >= 0) {
+                long long limboSize = 0;
+                for (int i=0;i<numReclaimers;++i) {
+                    limboSize += ((reclaimer_debra<T, Pool> * const) reclaimers[i])->threadData[tid].limboSize;
+                }
+                GSTATS_SET_IX(tid, limbo_size, limboSize, slice);
+            }
+#endif
             result = true;
         }
 
@@ -269,16 +367,25 @@ public:
         if (!readOnly) {
 #endif
             // incrementally scan the announced epochs of all threads
-            if (++threadData[tid].opsSinceRead == MIN_OPS_BEFORE_READ) {
+            // (or, if our limbo bags have exceeded the ceiling, scan them all now)
+            const bool overCeiling = debraEpochPolicy().limboCeiling > 0 && threadData[tid].limboSize > debraEpochPolicy().limboCeiling;
+            if (++threadData[tid].opsSinceRead >= threadData[tid].opsBeforeRead || overCeiling) {
                 threadData[tid].opsSinceRead = 0;
-                int otherTid = threadData[tid].checked;
-                long otherAnnounce = threadData[otherTid].announcedEpoch.load(memory_order_relaxed);
-                if (BITS_EPOCH(otherAnnounce) == readEpoch || QUIESCENT(otherAnnounce)) {
+                do {
+                    int otherTid = threadData[tid].checked;
+                    long otherAnnounce = threadData[otherTid].announcedEpoch.load(memory_order_relaxed);
+                    if (!(BITS_EPOCH(otherAnnounce) == readEpoch || QUIESCENT(otherAnnounce))) break;
                     const int c = ++threadData[tid].checked;
                     if (c >= this->NUM_PROCESSES /*&& c > MIN_OPS_BEFORE_CAS_EPOCH*/) {
-                        __sync_bool_compare_and_swap(&epoch, readEpoch, readEpoch+EPOCH_INCREMENT);
+                        if (__sync_bool_compare_and_swap(&epoch, readEpoch, readEpoch+EPOCH_INCREMENT)) {
+#ifdef __HANDLE_STATS
+                            const int slice = getStatsSlice();
+                            if (slice >= 0) GSTATS_ADD_IX(tid, epoch_advances, 1, slice);
+#endif
+                        }
+                        break;
                     }
-                }
+                } while (overCeiling);
             }
 #ifndef DEBRA_DISABLE_READONLY_OPT
         }
@@ -293,8 +400,18 @@ public:
     // for all schemes except reference counting
     inline void retire(const int tid, T* p) {
         threadData[tid].currentBag->add(p);
+        ++threadData[tid].limboSize;
+        ++threadData[tid].retiredThisEpoch;
         DEBUG2 this->debug->addRetired(tid, 1);
     }
+#ifdef BLOCKBAG_SUMMARIES
+    inline void retire(const int tid, T* p, const blockbag_summary& summary) {
+        threadData[tid].currentBag->add(p, summary);
+        ++threadData[tid].limboSize;
+        ++threadData[tid].retiredThisEpoch;
+        DEBUG2 this->debug->addRetired(tid, 1);
+    }
+#endif
     
     void debugPrintStatus(const int tid) {
         if (tid == 0) {
@@ -324,6 +441,10 @@ public:
             }
 
             threadData[tid].opsSinceRead = 0;
+            threadData[tid].opsBeforeRead = debraEpochPolicy().maxOpsBeforeRead;
+            threadData[tid].limboSize = 0;
+            threadData[tid].opsThisEpoch = 0;
+            threadData[tid].retiredThisEpoch = 0;
             threadData[tid].checked = 0;
             for (int i=0;i<NUMBER_OF_EPOCH_BAGS;++i) {
                 threadData[tid].epochbags[i] = new blockbag<T>(tid, this->pool->blockpools[tid]);
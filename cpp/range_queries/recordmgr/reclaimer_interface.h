@@ -46,6 +46,10 @@ public:
     
     long long getSizeInNodes() { return 0; }
     string getSizeString() { return ""; }
+    // approximate number of retired records that have not been reclaimed.
+    // unlike getSizeInNodes, this is safe to call while other threads are
+    // retiring records, so it can be sampled during an experiment.
+    long long getApproxSizeInNodes() { return 0; }
 
     inline static bool quiescenceIsPerRecordType() { return true; }
     inline static bool shouldHelp() { return true; } // FOR DEBUGGING PURPOSES
@@ -69,6 +69,10 @@ public:
     // for all schemes except reference counting
     inline static void retire(const int tid, T* p) {
     }
+#ifdef BLOCKBAG_SUMMARIES
+    inline static void retire(const int tid, T* p, const blockbag_summary& summary) {
+    }
+#endif
 
     void debugPrintStatus(const int tid) {
     }
@@ -48,6 +48,8 @@ public:
     void registerThread(const int tid) {}
     void unregisterThread(const int tid) {}
     void printStatus() {}
+    void printStatusJSON(ostream & os, const bool first) {}
+    long long getApproxSizeInNodes() { return 0; }
     inline void qUnprotectAll(const int tid) {}
     inline void getReclaimers(const int tid, void ** const reclaimers, int index) {}
     inline void enterQuiescentState(const int tid) {}
@@ -101,6 +103,14 @@ public:
         mgr->printStatus();
         ((RecordManagerSet<Reclaim, Alloc, Pool, Rest...> *) this)->printStatus();
     }
+    void printStatusJSON(ostream & os, const bool first) {
+        mgr->printStatusJSON(os, first);
+        ((RecordManagerSet<Reclaim, Alloc, Pool, Rest...> *) this)->printStatusJSON(os, false);
+    }
+    long long getApproxSizeInNodes() {
+        return mgr->reclaim->getApproxSizeInNodes()
+                + ((RecordManagerSet<Reclaim, Alloc, Pool, Rest...> *) this)->getApproxSizeInNodes();
+    }
     inline void qUnprotectAll(const int tid) {
         mgr->qUnprotectAll(tid);
         ((RecordManagerSet<Reclaim, Alloc, Pool, Rest...> *) this)->qUnprotectAll(tid);
@@ -171,6 +181,17 @@ public:
     void printStatus(void) {
         rmset->printStatus();
     }
+    // prints a JSON array with one object per record type
+    void printStatusJSON(ostream & os) {
+        os<<"[";
+        rmset->printStatusJSON(os, true);
+        os<<"]";
+    }
+    // approximate number of records (of all types) that have been retired
+    // but not reclaimed. safe to call while other threads are running.
+    long long getApproxSizeInNodes() {
+        return rmset->getApproxSizeInNodes();
+    }
     template <typename T>
     debugInfo * getDebugInfo(T * const recordType) {
         return &rmset->get((T *) NULL)->debugInfoRecord;
@@ -255,6 +276,15 @@ public:
         assert(!Reclaim::supportsCrashRecovery() || isQuiescent(tid));
         rmset->get((T *) NULL)->retire(tid, p);
     }
+#ifdef BLOCKBAG_SUMMARIES
+    // retire p, and summarize it in the block that it is placed in
+    // (only for reclaimers that keep retired records in blockbags)
+    template <typename T>
+    inline void retire(const int tid, T * const p, const blockbag_summary& summary) {
+        assert(!Reclaim::supportsCrashRecovery() || isQuiescent(tid));
+        rmset->get((T *) NULL)->retire(tid, p, summary);
+    }
+#endif
 
     template <typename T>
     inline T * allocate(const int tid) {
@@ -29,6 +29,7 @@
 #include "pool_interface.h"
 #include "pool_none.h"
 #include "pool_perthread_and_shared.h"
+#include "pool_numa.h"
 
 #include "reclaimer_interface.h"
 #include "reclaimer_none.h"
@@ -140,6 +141,13 @@ public:
         assert(!Reclaim::supportsCrashRecovery() || isQuiescent(tid));
         reclaim->retire(tid, p);
     }
+#ifdef BLOCKBAG_SUMMARIES
+    // only for reclaimers that keep retired records in blockbags
+    inline void retire(const int tid, record_pointer p, const blockbag_summary& summary) {
+        assert(!Reclaim::supportsCrashRecovery() || isQuiescent(tid));
+        reclaim->retire(tid, p, summary);
+    }
+#endif
     
     // for algs that retire before the linearization point of a deletion
     inline void unretireLast(const int tid) {
@@ -166,6 +174,10 @@ public:
         COUTATOMIC("allocated   : "<<allocated<<" objects totaling "<<allocatedBytes<<" bytes ("<<(allocatedBytes/1000000.)<<"MB)"<<endl);
         COUTATOMIC("recycled    : "<<recycled<<endl);
         COUTATOMIC("deallocated : "<<deallocated<<" objects"<<endl);
+        if (debugInfoRecord.getTotalSlabs() > 0) {
+            long long slabBytes = debugInfoRecord.getTotalSlabBytes();
+            COUTATOMIC("slabs       : "<<debugInfoRecord.getTotalSlabs()<<" slabs totaling "<<slabBytes<<" bytes ("<<(slabBytes/1000000.)<<"MB); process rss "<<(debugInfo::getResidentBytes()/1000000.)<<"MB"<<endl);
+        }
         COUTATOMIC("pool        : "<<pool->getSizeString()<<endl);
         COUTATOMIC("reclaim     : "<<reclaim->getSizeString()<<endl);
         COUTATOMIC("unreclaimed : "<<(allocated - deallocated - atoi(reclaim->getSizeString().c_str()))<<endl);
@@ -192,6 +204,18 @@ public:
 //            COUTATOMIC(endl);
 //        }
     }
+    // prints the counters above as one JSON object (preceded by a comma unless first)
+    void printStatusJSON(ostream & os, const bool first) {
+        long long allocated = debugInfoRecord.getTotalAllocated();
+        os<<(first ? "" : ", ")<<"{\"type\": \""<<typeid(Record).name()<<"\""
+          <<", \"size\": "<<sizeof(Record)
+          <<", \"allocated\": "<<allocated
+          <<", \"recycled\": "<<(debugInfoRecord.getTotalFromPool() - allocated)
+          <<", \"deallocated\": "<<debugInfoRecord.getTotalDeallocated()
+          <<", \"limbo\": "<<atoi(reclaim->getSizeString().c_str())
+          <<", \"slabs\": "<<debugInfoRecord.getTotalSlabs()
+          <<", \"slab_bytes\": "<<debugInfoRecord.getTotalSlabBytes()<<"}";
+    }
 };
 
 #endif
\ No newline at end of file
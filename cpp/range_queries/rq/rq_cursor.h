@@ -0,0 +1,100 @@
+/*
+ * File:   rq_cursor.h
+ *
+ * A forward cursor over the keys in [lo, hi] of a data structure that supports
+ * streaming range queries (rangeQuery(tid, lo, hi, limit, visitor), see
+ * rq_stream.h), such as bst and bslack.
+ *
+ * Instead of searching from the root for the successor of the last key it
+ * returned each time it advances, the cursor fetches the next batchSize keys
+ * (after the last key it returned) with one streaming range query, and then
+ * returns them from its buffer without accessing the data structure.
+ * So, iterating over n keys performs about n / batchSize searches.
+ *
+ * Each batch is a linearizable snapshot of the keys in its range, but
+ * different batches may be taken at different times (so the cursor is weakly
+ * consistent, like a sequence of successor operations).
+ * A cursor is used by a single thread (with thread id tid).
+ */
+
+#ifndef RQ_CURSOR_H
+#define	RQ_CURSOR_H
+
+#include <cassert>
+
+#ifndef RQ_CURSOR_BATCH_SIZE
+    #define RQ_CURSOR_BATCH_SIZE 64
+#endif
+
+template <typename K, typename V, class DataStructure>
+class rq_cursor {
+private:
+    DataStructure * const ds;
+    const int tid;
+    const K hi;
+    const int batchSize;
+    K * const keys;
+    V * const values;
+    int size;                                   // number of keys in the current batch
+    int pos;                                    // index of the next key to return
+    bool started;                               // whether a key has been returned
+    bool exhausted;                             // whether [lastKey, hi] contains no more keys
+    K from;                                     // the next batch starts at from (excluding from, if started)
+
+    void fetch() {
+        size = 0;
+        pos = 0;
+        const bool skipFrom = started;
+        auto visitor = [&](const K& key, const V& value) {
+            if (skipFrom && !(from < key)) return true;
+            keys[size] = key;
+            values[size] = value;
+            ++size;
+            return size < batchSize;
+        };
+        ds->rangeQuery(tid, from, hi, batchSize + (skipFrom ? 1 : 0), visitor);
+        if (size < batchSize) exhausted = true;
+    }
+
+public:
+    rq_cursor(DataStructure * const ds, const int tid, const K& lo, const K& hi, const int batchSize = RQ_CURSOR_BATCH_SIZE)
+            : ds(ds), tid(tid), hi(hi), batchSize(batchSize), keys(new K[batchSize]), values(new V[batchSize]) {
+        assert(batchSize > 0);
+        seek(lo);
+    }
+    ~rq_cursor() {
+        delete[] keys;
+        delete[] values;
+    }
+
+    /**
+     * reposition the cursor, so the next key it returns is the smallest key >= lo
+     */
+    void seek(const K& lo) {
+        size = 0;
+        pos = 0;
+        started = false;
+        exhausted = false;
+        from = lo;
+    }
+
+    /**
+     * returns false if there are no more keys in the range, and otherwise
+     * returns true and stores the next key and its value in key and value.
+     */
+    bool next(K * const key, V * const value) {
+        if (pos == size) {
+            if (exhausted) return false;
+            fetch();
+            if (size == 0) return false;
+        }
+        *key = keys[pos];
+        *value = values[pos];
+        ++pos;
+        from = *key;
+        started = true;
+        return true;
+    }
+};
+
+#endif	/* RQ_CURSOR_H */
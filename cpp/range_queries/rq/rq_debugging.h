@@ -8,8 +8,14 @@
 #ifndef RQ_DEBUGGING_H
 #define RQ_DEBUGGING_H
 
+// must be larger than the number of keys in any node
+// (so it follows ABTREE_DEGREE, however the degree is set)
 #ifndef RQ_DEBUGGING_MAX_KEYS_PER_NODE
-    #define RQ_DEBUGGING_MAX_KEYS_PER_NODE 32
+    #if defined ABTREE_DEGREE && ABTREE_DEGREE >= 16
+        #define RQ_DEBUGGING_MAX_KEYS_PER_NODE (2*(ABTREE_DEGREE))
+    #else
+        #define RQ_DEBUGGING_MAX_KEYS_PER_NODE 32
+    #endif
 #endif
 
 #if !defined USE_RQ_DEBUGGING
@@ -217,7 +223,9 @@
             bool good = true;
             int numberFailed = 0;
             int numberSucc = 0;
-    #if defined RLU_USED
+    #if defined RLU_USED || defined RQ_LOCKFREE_SHARED_TIMESTAMP
+            // range queries by different threads can share a timestamp,
+            // so each thread's range queries are validated separately
             for (int tid=0;tid<numProcesses;++tid) {
                 long long prefixSum = 0;
                 for (int timestamp=0;timestamp<MAX_NUM_RQ_IN_EXECUTION;++timestamp) {
@@ -36,9 +36,18 @@ extern Random rngs[MAX_TID_POW2*PREFETCH_SIZE_WORDS];
 #define WAIT_FOR_DTIME(node) ({ false; })
 #endif
 
+// with RQ_LOCKFREE_SHARED_TIMESTAMP, the number of times a range query reads
+// the time stamp (waiting for a concurrent range query to increment it)
+// before it increments the time stamp itself
+#ifndef RQ_LOCKFREE_SHARED_TIMESTAMP_WAIT
+#define RQ_LOCKFREE_SHARED_TIMESTAMP_WAIT 64
+#endif
+
 #include <pthread.h>
 #include <hashlist.h>
 #include "rq_debugging.h"
+#include "rq_stream.h"
+#include "rq_summaries.h"
 #include "dcss_plus_impl.h"
 
 template <typename T>
@@ -70,6 +79,7 @@ private:
             struct { // anonymous struct inside anonymous union means we don't need to type anything special to access these variables
                 long long rq_lin_time;
                 HashList<K> * hashlist;
+                rq_stream<K,V> * stream;
 #ifdef COUNT_CODE_PATH_EXECUTIONS
                 long long codePathExecutions[CODE_COVERAGE_MAX_PATHS];
 #endif
@@ -154,6 +164,7 @@ public:
         prov->initThread(tid);
         threadData[tid].hashlist = new HashList<K>();
         threadData[tid].hashlist->init(HASHLIST_INIT_CAPACITY_POW2);
+        threadData[tid].stream = new rq_stream<K,V>();
         threadData[tid].numAnnouncements = 0;
         for (int i=0;i<MAX_NODES_INSERTED_OR_DELETED_ATOMICALLY;++i) {
             threadData[tid].announcements[i] = NULL;
@@ -173,6 +184,7 @@ public:
         prov->deinitThread(tid);
         threadData[tid].hashlist->destroy();
         delete threadData[tid].hashlist;
+        delete threadData[tid].stream;
 #ifdef COUNT_CODE_PATH_EXECUTIONS
         for (int i=0;i<CODE_COVERAGE_MAX_PATHS;++i) {
             __sync_fetch_and_add(&codePathExecutions[i], threadData[tid].codePathExecutions[i]);
@@ -243,7 +255,11 @@ public:
     void physical_deletion_succeeded(const int tid, NodeType * const * const deletedNodes) {
         int i;
         for (i=0;deletedNodes[i];++i) {
+#ifdef BLOCKBAG_SUMMARIES
+            recmgr->retire(tid, deletedNodes[i], rq_summarize_retired_node<K,V>(tid, ds, deletedNodes[i]));
+#else
             recmgr->retire(tid, deletedNodes[i]);
+#endif
         }
         SOFTWARE_BARRIER; // ensure nodes are placed in the epoch bag BEFORE they are removed from announcements.
         threadData[tid].numAnnouncements -= i;
@@ -397,7 +413,48 @@ public:
     // invoke at the start of each traversal
     inline void traversal_start(const int tid) {
         threadData[tid].hashlist->clear();
+#ifdef RQ_LOCKFREE_SHARED_TIMESTAMP
+        // range queries that run concurrently share increments of timestamp,
+        // so updates (which read timestamp in their dcssp) see it change less
+        // often. if timestamp changes from ts to a larger value after this
+        // range query begins, the range query can be linearized at that
+        // change, whichever thread made it. otherwise, we increment it.
+        // (so several range queries can have the same linearization time,
+        // but each thread's range queries have increasing times.)
+        long long ts = timestamp;
+        for (int i=0;i<RQ_LOCKFREE_SHARED_TIMESTAMP_WAIT && timestamp == ts;++i) {
+            SOFTWARE_BARRIER;
+        }
+        if (timestamp == ts && __sync_bool_compare_and_swap(&timestamp, ts, ts+1)) {
+            threadData[tid].rq_lin_time = ts+1;                                 // linearize rq here!
+        } else {
+            threadData[tid].rq_lin_time = timestamp;                            // linearize rq at the (earlier) change from ts by another thread
+        }
+#else
         threadData[tid].rq_lin_time = __sync_add_and_fetch(&timestamp, 1);      // linearize rq here!
+#endif
+    }
+
+    // parallel range queries (see rq_parallel.h):
+    // the owner tid invokes traversal_start(tid), then each thread helperTid
+    // that traverses a part of the data structure on behalf of tid invokes
+    // traversal_start_helper(helperTid, tid) (while tid is between
+    // traversal_start and traversal_end), and traversal_try_add(helperTid, ...)
+    // for each node it visits. afterwards, tid invokes traversal_merge for the
+    // keys found by each helper, then traversal_end as usual.
+    inline void traversal_start_helper(const int helperTid, const int tid) {
+        threadData[helperTid].hashlist->clear();
+        threadData[helperTid].rq_lin_time = threadData[tid].rq_lin_time;
+    }
+
+    inline void traversal_merge(const int tid, K const * const keys, V const * const values, const int numKeys, K * const rqResultKeys, V * const rqResultValues, int * const startIndex) {
+        for (int i=0;i<numKeys;++i) {
+            if (threadData[tid].hashlist->contains(keys[i])) continue;
+            threadData[tid].hashlist->insert(keys[i]);
+            rqResultKeys[*startIndex] = keys[i];
+            rqResultValues[*startIndex] = values[i];
+            ++(*startIndex);
+        }
     }
 
 private:
@@ -611,7 +668,8 @@ doNotAddToRQ: (0);
         }
         // note: the above increments startIndex
 #if defined MICROBENCH
-        assert(*startIndex <= RQSIZE);
+        // (a streaming range query buffers up to a chunk of keys, which may exceed RQSIZE; see rq_stream.h)
+        assert(*startIndex <= RQSIZE || rqResultKeys == threadData[tid].stream->keys);
 #endif
     }
     
@@ -620,20 +678,17 @@ public:
         traversal_try_add(tid, node, rqResultKeys, rqResultValues, startIndex, lo, hi, true);
     }
     
-    // invoke at the end of each traversal:
-    // any nodes that were deleted during the traversal,
-    // and were consequently missed during the traversal,
-    // are placed in rqResult[index]
-    void traversal_end(const int tid, K * const rqResultKeys, V * const rqResultValues, int * const startIndex, const K& lo, const K& hi) {
-        // todo: possibly optimize by skipping entire blocks if there are many keys to skip (does not seem to be justifiable for 4 work threads and 4 range query threads)
+private:
 
+    // visit every node that may have been deleted during the traversal,
+    // and consequently missed by it, by invoking tryAdd(node) on:
+    // nodes announced by other processes, then nodes in their epoch bags
+    template <typename TryAdd>
+    void traversal_visit_missed_nodes(const int tid, const K& lo, const K& hi, TryAdd tryAdd) {
         SOFTWARE_BARRIER;
         long long end_timestamp = timestamp;
         SOFTWARE_BARRIER;
         
-#if 0
-        vector<NodeType *> nodes;
-        
         // collect nodes announced by other processes
         for (int otherTid=0;otherTid<NUM_PROCESSES;++otherTid) if (otherTid != tid) {
             int sz = threadData[otherTid].numAnnouncements;
@@ -641,65 +696,7 @@ public:
             for (int i=0;i<sz;++i) {
                 NodeType * node = (NodeType *) threadData[otherTid].announcements[i];
                 assert(node);
-                nodes.push_back(node);
-//                traversal_try_add(tid, node, rqResultKeys, startIndex, lo, hi, false);
-            }
-        }
-        SOFTWARE_BARRIER;
-        
-        // collect epoch bags of other processes (MUST be after checking announcements!)
-        blockbag<NodeType> * all_bags[NUM_PROCESSES*NUMBER_OF_EPOCH_BAGS+1];
-        vector<blockbag_iterator<NodeType>> all_iterators;
-        int numIterators = 0;
-        for (int otherTid=0;otherTid<NUM_PROCESSES;++otherTid) if (otherTid != tid) {
-            blockbag<NodeType> * thread_bags[NUMBER_OF_EPOCH_BAGS+1];
-            recmgr->get((NodeType *) NULL)->reclaim->getSafeBlockbags(otherTid, thread_bags);
-            for (int i=0;thread_bags[i];++i) {
-                all_bags[numIterators] = thread_bags[i];
-                all_iterators.push_back(thread_bags[i]->begin());
-                ++numIterators;
-            }
-        }
-
-        // collect nodes in epoch bags
-        int numVisitedInEpochBags = 0;
-        for (int ix = 0; ix < numIterators; ++ix) {
-            for (; all_iterators[ix] != all_bags[ix]->end(); all_iterators[ix]++) {
-                NodeType * node = (*all_iterators[ix]);
-                nodes.push_back(node);
-                
-                ++numVisitedInEpochBags;
-                
-                long long dtime = node->dtime;
-                if (dtime != TIMESTAMP_NOT_SET && dtime > end_timestamp) continue;
-                
-                if (!(logicalDeletion && canRetireNodesLogicallyDeletedByOtherProcesses)) {
-                    // if we cannot retire nodes that are logically deleted
-                    // by other processes, then we always retire nodes in
-                    // order of increasing dtime values.
-                    // so, the blockbag will be ordered, which means that,
-                    // if dtime is before the RQ, then all remaining nodes
-                    // in this bag were deleted before the RQ.
-                    // so, in this case, we skip to the next bag.
-                    if (dtime != TIMESTAMP_NOT_SET && dtime < threadData[tid].rq_lin_time) break;
-                }
-            }
-        }
-        
-        // visit collected nodes
-        for (auto it = nodes.begin(); it != nodes.end(); it++) {
-            NodeType * node = *it;
-            traversal_try_add(tid, node, rqResultKeys, startIndex, lo, hi, false);
-        }
-#else
-        // collect nodes announced by other processes
-        for (int otherTid=0;otherTid<NUM_PROCESSES;++otherTid) if (otherTid != tid) {
-            int sz = threadData[otherTid].numAnnouncements;
-            SOFTWARE_BARRIER;
-            for (int i=0;i<sz;++i) {
-                NodeType * node = (NodeType *) threadData[otherTid].announcements[i];
-                assert(node);
-                traversal_try_add(tid, node, rqResultKeys, rqResultValues, startIndex, lo, hi, false);
+                tryAdd(node);
             }
         }
         SOFTWARE_BARRIER;
@@ -720,8 +717,23 @@ public:
         
         int numSkippedInEpochBags = 0;
         int numVisitedInEpochBags = 0;
+        int numSkippedBySummaries = 0;
         for (int ix = 0; ix < numIterators; ++ix) {
+#ifdef BLOCKBAG_SUMMARIES
+            block<NodeType> * summarized = NULL;
+#endif
             for (; all_iterators[ix] != all_bags[ix]->end(); all_iterators[ix]++) {
+#ifdef BLOCKBAG_SUMMARIES
+                // upon entering a block, check whether we can skip all of it
+                if (all_iterators[ix].getCurr() != summarized) {
+                    summarized = all_iterators[ix].getCurr();
+                    if (rq_can_skip_block(summarized->getSummary(), lo, hi, threadData[tid].rq_lin_time, end_timestamp)) {
+                        numSkippedBySummaries += all_iterators[ix].getIndex() + 1;
+                        all_iterators[ix].skipToEndOfBlock();
+                        continue;
+                    }
+                }
+#endif
                 NodeType * node = (*all_iterators[ix]);
                 assert(node);
 
@@ -744,11 +756,29 @@ public:
                     if (dtime != TIMESTAMP_NOT_SET && dtime < threadData[tid].rq_lin_time) break;
                 }
 
-                traversal_try_add(tid, node, rqResultKeys, rqResultValues, startIndex, lo, hi, false);
+                tryAdd(node);
             }
         }
-        
+
+#ifdef __HANDLE_STATS
+        GSTATS_ADD_IX(tid, skipped_in_bags, numSkippedInEpochBags, threadData[tid].rq_lin_time);
+        GSTATS_ADD_IX(tid, visited_in_bags, numVisitedInEpochBags, threadData[tid].rq_lin_time);
+#ifdef BLOCKBAG_SUMMARIES
+        GSTATS_ADD_IX(tid, summary_skipped_in_bags, numSkippedBySummaries, threadData[tid].rq_lin_time);
+#endif
 #endif
+        DEBUG_RECORD_RQ_VISITED(tid, threadData[tid].rq_lin_time, numVisitedInEpochBags);
+    }
+
+public:
+    // invoke at the end of each traversal:
+    // any nodes that were deleted during the traversal,
+    // and were consequently missed during the traversal,
+    // are placed in rqResult[index]
+    void traversal_end(const int tid, K * const rqResultKeys, V * const rqResultValues, int * const startIndex, const K& lo, const K& hi) {
+        traversal_visit_missed_nodes(tid, lo, hi, [&](NodeType * const node) {
+            traversal_try_add(tid, node, rqResultKeys, rqResultValues, startIndex, lo, hi, false);
+        });
         
 #if defined MICROBENCH && !defined NDEBUG
         if (*startIndex > RQSIZE) {
@@ -762,15 +792,78 @@ public:
         }
 #endif
 
-#ifdef __HANDLE_STATS
-
-        GSTATS_ADD_IX(tid, skipped_in_bags, numSkippedInEpochBags, threadData[tid].rq_lin_time);
-        GSTATS_ADD_IX(tid, visited_in_bags, numVisitedInEpochBags, threadData[tid].rq_lin_time);
-#endif
-        DEBUG_RECORD_RQ_VISITED(tid, threadData[tid].rq_lin_time, numVisitedInEpochBags);
         DEBUG_RECORD_RQ_SIZE(*startIndex);
         DEBUG_RECORD_RQ_CHECKSUM(tid, threadData[tid].rq_lin_time, rqResultKeys, *startIndex);
     }
+    
+    // streaming range queries (see rq_stream.h):
+    // instead of filling caller-provided arrays, keys are passed to a visitor
+    // bool visitor(const K& key, const V& value) in increasing order,
+    // until visitor returns false, or limit keys have been passed (limit <= 0 means no limit).
+    // the traversal must visit nodes in increasing key order, and use these
+    // functions instead of the ones above:
+    //   traversal_start(tid, limit);
+    //   for each node visited: traversal_try_add(tid, node, lo, hi);
+    //       if (traversal_chunk_full(tid) && !traversal_flush(tid, lo, visitor)) stop traversing;
+    //   return traversal_end(tid, lo, hi, visitor); // number of keys passed to visitor
+    // a descending traversal (which passes keys to visitor in decreasing order)
+    // invokes traversal_start(tid, limit, true), must visit nodes in decreasing
+    // key order, and must invoke traversal_flush(tid, lo, hi, visitor).
+    inline void traversal_start(const int tid, const int limit, const bool descending = false) {
+        traversal_start(tid);
+        threadData[tid].stream->start(limit, descending);
+    }
+    
+    inline void traversal_try_add(const int tid, NodeType * const node, const K& lo, const K& hi) {
+        rq_stream<K,V> * const stream = threadData[tid].stream;
+        stream->reserve(RQ_DEBUGGING_MAX_KEYS_PER_NODE);
+        traversal_try_add(tid, node, stream->keys, stream->values, &stream->size, lo, hi, true);
+    }
+    
+    inline bool traversal_chunk_full(const int tid) {
+        return threadData[tid].stream->isChunkFull();
+    }
+    
+    // pass the keys buffered so far (completed with any keys missed by the
+    // traversal that are smaller than the largest buffered key) to visitor.
+    // returns false if the traversal should stop.
+    template <typename Visitor>
+    bool traversal_flush(const int tid, const K& lo, Visitor& visitor) {
+        if (threadData[tid].stream->size == 0) return !threadData[tid].stream->isStopped();
+        return traversal_stream(tid, lo, threadData[tid].stream->maxKey(), visitor);
+    }
+    
+    // as above, but also for descending traversals (in which the keys buffered
+    // so far are completed with any missed keys larger than the smallest buffered key)
+    template <typename Visitor>
+    bool traversal_flush(const int tid, const K& lo, const K& hi, Visitor& visitor) {
+        rq_stream<K,V> * const stream = threadData[tid].stream;
+        if (stream->size == 0) return !stream->isStopped();
+        return stream->isDescending()
+                ? traversal_stream(tid, stream->minKey(), hi, visitor)
+                : traversal_stream(tid, lo, stream->maxKey(), visitor);
+    }
+    
+    template <typename Visitor>
+    int traversal_end(const int tid, const K& lo, const K& hi, Visitor& visitor) {
+        traversal_stream(tid, lo, hi, visitor);
+        return threadData[tid].stream->getNumDelivered();
+    }
+
+private:
+    template <typename Visitor>
+    bool traversal_stream(const int tid, const K& lo, const K& hi, Visitor& visitor) {
+        rq_stream<K,V> * const stream = threadData[tid].stream;
+        if (stream->isStopped()) return false;
+        const K from = stream->lowerBound(lo);
+        const K to = stream->upperBound(hi);
+        traversal_visit_missed_nodes(tid, from, to, [&](NodeType * const node) {
+            stream->reserve(RQ_DEBUGGING_MAX_KEYS_PER_NODE);
+            traversal_try_add(tid, node, stream->keys, stream->values, &stream->size, from, to, false);
+        });
+        threadData[tid].hashlist->clear(); // the next chunk contains only keys > hi (< lo if descending)
+        return stream->deliver(stream->isDescending() ? lo : hi, visitor);
+    }
 };
 
 #endif	/* RQ_LOCKFREE_H */
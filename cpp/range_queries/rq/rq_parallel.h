@@ -0,0 +1,174 @@
+/*
+ * File:   rq_parallel.h
+ *
+ * A group of helper threads that assist one range query thread (the owner)
+ * with parallel range queries (see rangeQuery(tid, lo, hi, resultKeys,
+ * resultValues, helpers) in bst_impl.h and bslack_impl.h).
+ *
+ * A parallel range query is linearized by the owner (traversal_start), which
+ * then splits [lo, hi] at internal node boundaries into disjoint subtrees
+ * (parts). The owner and the helpers claim parts with fetch-and-add, and
+ * traverse them under the owner's linearization time
+ * (traversal_start_helper in rq_lockfree.h). Each helper appends the keys it
+ * finds to its own buffer, and the owner merges these buffers into its result
+ * (traversal_merge) before it collects the keys of nodes that were deleted
+ * during the traversal (traversal_end).
+ *
+ * Helpers spin in helperLoop until the owner invokes stop().
+ */
+
+#ifndef RQ_PARALLEL_H
+#define	RQ_PARALLEL_H
+
+#include <cassert>
+#include "plaf.h"
+
+// maximum number of parts a parallel range query is split into
+#ifndef RQ_PARALLEL_MAX_PARTS
+    #define RQ_PARALLEL_MAX_PARTS 256
+#endif
+
+// a parallel range query tries to create this many parts per thread
+// (so threads that finish their parts early can claim more)
+#ifndef RQ_PARALLEL_PARTS_PER_THREAD
+    #define RQ_PARALLEL_PARTS_PER_THREAD 4
+#endif
+
+template <typename K, typename V>
+class rq_parallel {
+private:
+    struct helper_t {
+        K * keys;
+        V * values;
+        int size;
+        int tid;
+        volatile long long seq;             // last job this helper finished
+        volatile char padding[PREFETCH_SIZE_BYTES];
+    };
+
+    volatile char padding0[PREFETCH_SIZE_BYTES];
+    const int ownerTid;
+    const int numHelpers;
+    helper_t * const helpers;
+    volatile char padding1[PREFETCH_SIZE_BYTES];
+
+    // the current job
+    volatile long long seq;                 // incremented by the owner to publish a job
+    volatile bool stopped;
+    int numParts;
+    void * task;
+    void (*invoke)(void * task, const int tid, const int part, K * const keys, V * const values, int * const size);
+    volatile char padding2[PREFETCH_SIZE_BYTES];
+    volatile int nextPart;
+    volatile char padding3[PREFETCH_SIZE_BYTES];
+
+    template <typename Task>
+    static void invokeTask(void * task, const int tid, const int part, K * const keys, V * const values, int * const size) {
+        (*((Task *) task))(tid, part, keys, values, size);
+    }
+
+    // claim and perform parts of the current job until none remain
+    inline void work(const int tid, K * const keys, V * const values, int * const size) {
+        int part;
+        while ((part = __sync_fetch_and_add(&nextPart, 1)) < numParts) {
+            invoke(task, tid, part, keys, values, size);
+        }
+    }
+
+public:
+    // helperTids[0..numHelpers-1] are the thread ids of the helpers.
+    // each helper buffer can hold capacity keys.
+    rq_parallel(const int ownerTid, const int numHelpers, const int * const helperTids, const int capacity)
+            : ownerTid(ownerTid), numHelpers(numHelpers), helpers(new helper_t[numHelpers]) {
+        for (int i=0;i<numHelpers;++i) {
+            helpers[i].keys = new K[capacity];
+            helpers[i].values = new V[capacity];
+            helpers[i].size = 0;
+            helpers[i].tid = helperTids[i];
+            helpers[i].seq = 0;
+        }
+        seq = 0;
+        stopped = false;
+        numParts = 0;
+        task = NULL;
+        invoke = NULL;
+        nextPart = 0;
+    }
+    ~rq_parallel() {
+        for (int i=0;i<numHelpers;++i) {
+            delete[] helpers[i].keys;
+            delete[] helpers[i].values;
+        }
+        delete[] helpers;
+    }
+
+    inline int getNumThreads() {
+        return numHelpers + 1;
+    }
+    inline int getNumHelpers() {
+        return numHelpers;
+    }
+    inline K * getHelperKeys(const int i) {
+        return helpers[i].keys;
+    }
+    inline V * getHelperValues(const int i) {
+        return helpers[i].values;
+    }
+    inline int getHelperSize(const int i) {
+        return helpers[i].size;
+    }
+
+    /**
+     * Invoked by the owner: performs task(tid, part, keys, values, size) for
+     * each part in [0, numParts), using the owner and the helpers, and returns
+     * once every part has been performed.
+     * The owner appends to ownerKeys/ownerValues (and increments *ownerSize),
+     * and each helper i appends to its own buffer (see getHelperKeys(i)).
+     */
+    template <typename Task>
+    void run(const int _numParts, K * const ownerKeys, V * const ownerValues, int * const ownerSize, Task& _task) {
+        assert(!stopped);
+        for (int i=0;i<numHelpers;++i) {
+            helpers[i].size = 0;
+        }
+        numParts = _numParts;
+        task = (void *) &_task;
+        invoke = &invokeTask<Task>;
+        nextPart = 0;
+        __sync_synchronize();
+        const long long s = ++seq;              // publish the job
+        work(ownerTid, ownerKeys, ownerValues, ownerSize);
+        for (int i=0;i<numHelpers;++i) {        // wait for every helper to finish the job
+            while (helpers[i].seq != s) {}
+        }
+        __sync_synchronize();
+    }
+
+    /**
+     * Invoked by the owner when it will not invoke run() again.
+     */
+    void stop() {
+        stopped = true;
+        __sync_synchronize();
+    }
+
+    /**
+     * Invoked by helper i (the thread with id helperTids[i]).
+     * Returns after the owner invokes stop().
+     */
+    void helperLoop(const int i) {
+        helper_t * const h = &helpers[i];
+        long long last = h->seq;
+        while (true) {
+            long long s;
+            while ((s = seq) == last && !stopped) {}
+            if (s == last) break;               // stopped, and there is no new job
+            __sync_synchronize();
+            work(h->tid, h->keys, h->values, &h->size);
+            __sync_synchronize();
+            h->seq = last = s;
+        }
+    }
+};
+
+#endif	/* RQ_PARALLEL_H */
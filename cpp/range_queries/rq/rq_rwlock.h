@@ -18,6 +18,8 @@
 #define	RQ_RWLOCK_H
 
 #include "rq_debugging.h"
+#include "rq_stream.h"
+#include "rq_summaries.h"
 #include <hashlist.h>
 #include <rwlock.h>
 #include <pthread.h>
@@ -35,6 +37,7 @@ private:
             struct { // anonymous struct inside anonymous union means we don't need to type anything special to access these variables
                 long long rq_lin_time;
                 HashList<K> * hashlist;
+                rq_stream<K,V> * stream;
                 volatile char padding0[PREFETCH_SIZE_BYTES];
                 void * announcements[MAX_NODES_INSERTED_OR_DELETED_ATOMICALLY+1];
                 int numAnnouncements;
@@ -94,6 +97,7 @@ public:
 
         threadData[tid].hashlist = new HashList<K>();
         threadData[tid].hashlist->init(HASHLIST_INIT_CAPACITY_POW2);
+        threadData[tid].stream = new rq_stream<K,V>();
         threadData[tid].numAnnouncements = 0;
         for (int i=0;i<MAX_NODES_INSERTED_OR_DELETED_ATOMICALLY+1;++i) {
             threadData[tid].announcements[i] = NULL;
@@ -107,6 +111,7 @@ public:
 
         threadData[tid].hashlist->destroy();
         delete threadData[tid].hashlist;
+        delete threadData[tid].stream;
         DEBUG_DEINIT_THREAD(tid);
     }
 
@@ -168,7 +173,11 @@ public:
     void physical_deletion_succeeded(const int tid, NodeType * const * const deletedNodes) {
         int i;
         for (i=0;deletedNodes[i];++i) {
+#ifdef BLOCKBAG_SUMMARIES
+            recmgr->retire(tid, deletedNodes[i], rq_summarize_retired_node<K,V>(tid, ds, deletedNodes[i]));
+#else
             recmgr->retire(tid, deletedNodes[i]);
+#endif
         }
         SOFTWARE_BARRIER; // ensure nodes are placed in the epoch bag BEFORE they are removed from announcements.
         threadData[tid].numAnnouncements -= i;
@@ -445,7 +454,8 @@ doNotAddToRQ: (0);
         }
         // note: the above increments startIndex
 #if defined MICROBENCH
-        assert(*startIndex <= RQSIZE);
+        // (a streaming range query buffers up to a chunk of keys, which may exceed RQSIZE; see rq_stream.h)
+        assert(*startIndex <= RQSIZE || rqResultKeys == threadData[tid].stream->keys);
 #endif
     }
 
@@ -454,20 +464,13 @@ public:
         traversal_try_add(tid, node, NULL, rqResultKeys, rqResultValues, startIndex, lo, hi, true);
     }
     
-    // invoke at the end of each traversal:
-    // any nodes that were deleted during the traversal,
-    // and were consequently missed during the traversal,
-    // are placed in rqResult[index]
-    void traversal_end(const int tid, K * const rqResultKeys, V * const rqResultValues, int * const startIndex, const K& lo, const K& hi) {
-        // todo: possibly optimize by skipping entire blocks if there are many keys to skip (does not seem to be justifiable for 4 work threads and 4 range query threads)
-
-#ifdef DEBUG_RQ_PROVIDER_METRICS
-        if (threadData[tid].rq_lin_time < 5) {
-            cout<<"rq_lin_time="<<threadData[tid].rq_lin_time<<endl;
-            cout<<"*startIndex="<<(*startIndex)<<endl;
-        }
-#endif
+private:
 
+    // visit every node that may have been deleted during the traversal,
+    // and consequently missed by it, by invoking tryAdd(node, nodeSource) on:
+    // nodes announced by other processes, then nodes in their epoch bags
+    template <typename TryAdd>
+    void traversal_visit_missed_nodes(const int tid, const K& lo, const K& hi, TryAdd tryAdd) {
         SOFTWARE_BARRIER;
         long long end_timestamp = timestamp;
         SOFTWARE_BARRIER;
@@ -489,7 +492,7 @@ public:
                 announcementSource[numCollected] = (NodeType **) &threadData[otherTid].announcements[i];
                 ++numCollected;
 #else
-                traversal_try_add(tid, node, (NodeType **) &threadData[otherTid].announcements[i], rqResultKeys, rqResultValues, startIndex, lo, hi, false);
+                tryAdd(node, (NodeType **) &threadData[otherTid].announcements[i]);
 #endif
             }
         }
@@ -514,14 +517,29 @@ public:
 #ifdef COLLECT_ANNOUNCEMENTS_FAST
         // try to add nodes collected from process announcements to the RQ
         for (int i=0;i<numCollected;++i) {
-            traversal_try_add(tid, collectedAnnouncement[i], announcementSource[i], rqResultKeys, rqResultValues, startIndex, lo, hi, false);
+            tryAdd(collectedAnnouncement[i], announcementSource[i]);
         }
 #endif
         
         int numSkippedInEpochBags = 0;
         int numVisitedInEpochBags = 0;
+        int numSkippedBySummaries = 0;
         for (int ix = 0; ix < numIterators; ++ix) {
+#ifdef BLOCKBAG_SUMMARIES
+            block<NodeType> * summarized = NULL;
+#endif
             for (; all_iterators[ix] != all_bags[ix]->end(); all_iterators[ix]++) {
+#ifdef BLOCKBAG_SUMMARIES
+                // upon entering a block, check whether we can skip all of it
+                if (all_iterators[ix].getCurr() != summarized) {
+                    summarized = all_iterators[ix].getCurr();
+                    if (rq_can_skip_block(summarized->getSummary(), lo, hi, threadData[tid].rq_lin_time, end_timestamp)) {
+                        numSkippedBySummaries += all_iterators[ix].getIndex() + 1;
+                        all_iterators[ix].skipToEndOfBlock();
+                        continue;
+                    }
+                }
+#endif
                 NodeType * node = (*all_iterators[ix]);
                 assert(node);
 
@@ -544,10 +562,37 @@ public:
                     if (dtime != TIMESTAMP_NOT_SET && dtime < threadData[tid].rq_lin_time) break;
                 }
 
-                traversal_try_add(tid, node, NULL, rqResultKeys, rqResultValues, startIndex, lo, hi, false);
+                tryAdd(node, (NodeType **) NULL);
             }
         }
 
+#ifdef __HANDLE_STATS
+        GSTATS_ADD_IX(tid, skipped_in_bags, numSkippedInEpochBags, threadData[tid].rq_lin_time);
+        GSTATS_ADD_IX(tid, visited_in_bags, numVisitedInEpochBags, threadData[tid].rq_lin_time);
+#ifdef BLOCKBAG_SUMMARIES
+        GSTATS_ADD_IX(tid, summary_skipped_in_bags, numSkippedBySummaries, threadData[tid].rq_lin_time);
+#endif
+#endif
+        DEBUG_RECORD_RQ_VISITED(tid, threadData[tid].rq_lin_time, numVisitedInEpochBags);
+    }
+
+public:
+    // invoke at the end of each traversal:
+    // any nodes that were deleted during the traversal,
+    // and were consequently missed during the traversal,
+    // are placed in rqResult[index]
+    void traversal_end(const int tid, K * const rqResultKeys, V * const rqResultValues, int * const startIndex, const K& lo, const K& hi) {
+#ifdef DEBUG_RQ_PROVIDER_METRICS
+        if (threadData[tid].rq_lin_time < 5) {
+            cout<<"rq_lin_time="<<threadData[tid].rq_lin_time<<endl;
+            cout<<"*startIndex="<<(*startIndex)<<endl;
+        }
+#endif
+
+        traversal_visit_missed_nodes(tid, lo, hi, [&](NodeType * const node, NodeType ** const nodeSource) {
+            traversal_try_add(tid, node, nodeSource, rqResultKeys, rqResultValues, startIndex, lo, hi, false);
+        });
+
 #if defined MICROBENCH && !defined NDEBUG
         if (*startIndex > RQSIZE) {
             cout<<"ERROR: *startIndex="<<(*startIndex)<<" is unexpectedly greater than or equal to RQSIZE="<<RQSIZE<<" (lo="<<lo<<" hi="<<hi<<")"<<endl;
@@ -574,14 +619,78 @@ public:
         }
 #endif
         
-#ifdef __HANDLE_STATS
-        GSTATS_ADD_IX(tid, skipped_in_bags, numSkippedInEpochBags, threadData[tid].rq_lin_time);
-        GSTATS_ADD_IX(tid, visited_in_bags, numVisitedInEpochBags, threadData[tid].rq_lin_time);
-#endif
-        DEBUG_RECORD_RQ_VISITED(tid, threadData[tid].rq_lin_time, numVisitedInEpochBags);
         DEBUG_RECORD_RQ_SIZE(*startIndex);
         DEBUG_RECORD_RQ_CHECKSUM(tid, threadData[tid].rq_lin_time, rqResultKeys, *startIndex);
     }
+    
+    // streaming range queries (see rq_stream.h):
+    // instead of filling caller-provided arrays, keys are passed to a visitor
+    // bool visitor(const K& key, const V& value) in increasing order,
+    // until visitor returns false, or limit keys have been passed (limit <= 0 means no limit).
+    // the traversal must visit nodes in increasing key order, and use these
+    // functions instead of the ones above:
+    //   traversal_start(tid, limit);
+    //   for each node visited: traversal_try_add(tid, node, lo, hi);
+    //       if (traversal_chunk_full(tid) && !traversal_flush(tid, lo, visitor)) stop traversing;
+    //   return traversal_end(tid, lo, hi, visitor); // number of keys passed to visitor
+    // a descending traversal (which passes keys to visitor in decreasing order)
+    // invokes traversal_start(tid, limit, true), must visit nodes in decreasing
+    // key order, and must invoke traversal_flush(tid, lo, hi, visitor).
+    inline void traversal_start(const int tid, const int limit, const bool descending = false) {
+        traversal_start(tid);
+        threadData[tid].stream->start(limit, descending);
+    }
+    
+    inline void traversal_try_add(const int tid, NodeType * const node, const K& lo, const K& hi) {
+        rq_stream<K,V> * const stream = threadData[tid].stream;
+        stream->reserve(RQ_DEBUGGING_MAX_KEYS_PER_NODE);
+        traversal_try_add(tid, node, NULL, stream->keys, stream->values, &stream->size, lo, hi, true);
+    }
+    
+    inline bool traversal_chunk_full(const int tid) {
+        return threadData[tid].stream->isChunkFull();
+    }
+    
+    // pass the keys buffered so far (completed with any keys missed by the
+    // traversal that are smaller than the largest buffered key) to visitor.
+    // returns false if the traversal should stop.
+    template <typename Visitor>
+    bool traversal_flush(const int tid, const K& lo, Visitor& visitor) {
+        if (threadData[tid].stream->size == 0) return !threadData[tid].stream->isStopped();
+        return traversal_stream(tid, lo, threadData[tid].stream->maxKey(), visitor);
+    }
+    
+    // as above, but also for descending traversals (in which the keys buffered
+    // so far are completed with any missed keys larger than the smallest buffered key)
+    template <typename Visitor>
+    bool traversal_flush(const int tid, const K& lo, const K& hi, Visitor& visitor) {
+        rq_stream<K,V> * const stream = threadData[tid].stream;
+        if (stream->size == 0) return !stream->isStopped();
+        return stream->isDescending()
+                ? traversal_stream(tid, stream->minKey(), hi, visitor)
+                : traversal_stream(tid, lo, stream->maxKey(), visitor);
+    }
+    
+    template <typename Visitor>
+    int traversal_end(const int tid, const K& lo, const K& hi, Visitor& visitor) {
+        traversal_stream(tid, lo, hi, visitor);
+        return threadData[tid].stream->getNumDelivered();
+    }
+
+private:
+    template <typename Visitor>
+    bool traversal_stream(const int tid, const K& lo, const K& hi, Visitor& visitor) {
+        rq_stream<K,V> * const stream = threadData[tid].stream;
+        if (stream->isStopped()) return false;
+        const K from = stream->lowerBound(lo);
+        const K to = stream->upperBound(hi);
+        traversal_visit_missed_nodes(tid, from, to, [&](NodeType * const node, NodeType ** const nodeSource) {
+            stream->reserve(RQ_DEBUGGING_MAX_KEYS_PER_NODE);
+            traversal_try_add(tid, node, nodeSource, stream->keys, stream->values, &stream->size, from, to, false);
+        });
+        threadData[tid].hashlist->clear(); // the next chunk contains only keys > hi (< lo if descending)
+        return stream->deliver(stream->isDescending() ? lo : hi, visitor);
+    }
 };
 
 #endif	/* RQ_RWLOCK_H */
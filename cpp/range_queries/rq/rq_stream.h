@@ -0,0 +1,163 @@
+/*
+ * File:   rq_stream.h
+ *
+ * Per-thread result buffer used by RQProviders that support streaming range
+ * queries (see traversal_start(tid, limit) in rq_lockfree.h and rq_rwlock.h).
+ *
+ * A streaming range query does not materialize its entire result.
+ * Instead, the traversal buffers keys until a chunk of RQ_STREAM_CHUNK_SIZE
+ * keys (or enough keys to satisfy the query's limit) has been collected.
+ * Since traversals visit nodes in increasing key order, every key in the
+ * range query's snapshot that is at most the largest buffered key hiEff is
+ * either in the buffer, or in a node that was deleted during the traversal,
+ * which can be found in the limbo bags (as in traversal_end).
+ * So, the chunk [lo, hiEff] can be completed, sorted, and passed to a visitor,
+ * and the traversal can continue with (hiEff, hi].
+ * This bounds the memory used by a range query to one chunk (plus nodes missed
+ * by the traversal), and lets the visitor stop the range query early.
+ *
+ * A descending streaming range query (which visits nodes in decreasing key
+ * order) works the same way, with the chunk [loEff, hi], where loEff is the
+ * smallest buffered key, and the traversal continues with [lo, loEff).
+ *
+ * Keys must be totally ordered by operator<.
+ */
+
+#ifndef RQ_STREAM_H
+#define	RQ_STREAM_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <cassert>
+
+#ifndef RQ_STREAM_CHUNK_SIZE
+    #define RQ_STREAM_CHUNK_SIZE 4096
+#endif
+#define RQ_STREAM_INIT_CAPACITY 256
+
+template <typename K, typename V>
+class rq_stream {
+private:
+    int * order;
+    int capacity;
+    int limit;                                  // <= 0 means no limit
+    int numDelivered;
+    bool stopped;
+    bool descending;
+    bool hasLastKey;
+    K lastKey;                                  // every key <= lastKey (>= lastKey if descending) has already been delivered
+
+public:
+    K * keys;
+    V * values;
+    int size;
+
+    rq_stream() : capacity(RQ_STREAM_INIT_CAPACITY), limit(0), numDelivered(0), stopped(false), descending(false), hasLastKey(false), size(0) {
+        keys = (K *) malloc(capacity * sizeof(K));
+        values = (V *) malloc(capacity * sizeof(V));
+        order = (int *) malloc(capacity * sizeof(int));
+    }
+
+    ~rq_stream() {
+        free(keys);
+        free(values);
+        free(order);
+    }
+
+    // invoke at the start of each streaming range query
+    void start(const int _limit, const bool _descending = false) {
+        size = 0;
+        limit = _limit;
+        numDelivered = 0;
+        stopped = false;
+        descending = _descending;
+        hasLastKey = false;
+    }
+
+    // ensure there is space to append n more keys
+    void reserve(const int n) {
+        if (size + n <= capacity) return;
+        while (size + n > capacity) capacity *= 2;
+        keys = (K *) realloc(keys, capacity * sizeof(K));
+        values = (V *) realloc(values, capacity * sizeof(V));
+        order = (int *) realloc(order, capacity * sizeof(int));
+        if (!keys || !values || !order) {
+            cout<<"ERROR: could not grow range query stream buffer to "<<capacity<<" keys"<<endl;
+            exit(-1);
+        }
+    }
+
+    inline bool isChunkFull() {
+        return size >= RQ_STREAM_CHUNK_SIZE || (limit > 0 && size >= limit - numDelivered);
+    }
+
+    inline bool isStopped() {
+        return stopped;
+    }
+
+    inline int getNumDelivered() {
+        return numDelivered;
+    }
+
+    inline bool isDescending() {
+        return descending;
+    }
+
+    // largest buffered key (the buffer must be non-empty)
+    K maxKey() {
+        assert(size > 0);
+        K result = keys[0];
+        for (int i=1;i<size;++i) if (result < keys[i]) result = keys[i];
+        return result;
+    }
+
+    // smallest buffered key (the buffer must be non-empty)
+    K minKey() {
+        assert(size > 0);
+        K result = keys[0];
+        for (int i=1;i<size;++i) if (keys[i] < result) result = keys[i];
+        return result;
+    }
+
+    // smallest key that can still be delivered (keys equal to it are filtered out by deliver)
+    K lowerBound(const K& lo) {
+        return (hasLastKey && !descending) ? lastKey : lo;
+    }
+
+    // largest key that can still be delivered (keys equal to it are filtered out by deliver)
+    K upperBound(const K& hi) {
+        return (hasLastKey && descending) ? lastKey : hi;
+    }
+
+    // pass the buffered keys that have not already been delivered to visitor,
+    // in increasing (or decreasing) order, until visitor returns false or the
+    // limit is reached.
+    // the caller guarantees the buffer contains every key of the snapshot
+    // in [lowerBound(lo), hi] (or [lo, upperBound(hi)] if descending), and
+    // passes bound = hi (or lo if descending).
+    // returns false if the range query should stop.
+    template <typename Visitor>
+    bool deliver(const K& bound, Visitor& visitor) {
+        for (int i=0;i<size;++i) order[i] = i;
+        K * const k = keys;
+        if (descending) {
+            std::sort(order, order+size, [k](const int a, const int b) { return k[b] < k[a]; });
+        } else {
+            std::sort(order, order+size, [k](const int a, const int b) { return k[a] < k[b]; });
+        }
+        for (int i=0;i<size && !stopped;++i) {
+            const int ix = order[i];
+            if (hasLastKey && (descending ? !(keys[ix] < lastKey) : !(lastKey < keys[ix]))) continue;
+            if (limit > 0 && numDelivered >= limit) break;
+            ++numDelivered;
+            if (!visitor((const K&) keys[ix], (const V&) values[ix])) stopped = true;
+        }
+        if (limit > 0 && numDelivered >= limit) stopped = true;
+        size = 0;
+        lastKey = bound;
+        hasLastKey = true;
+        return !stopped;
+    }
+};
+
+#endif	/* RQ_STREAM_H */
@@ -0,0 +1,85 @@
+/*
+ * File:   rq_summaries.h
+ *
+ * Helpers shared by the RQProviders that summarize retired nodes in the
+ * blocks of their epoch bags (rq_lockfree.h and rq_rwlock.h), so that
+ * traversal_visit_missed_nodes can skip entire blocks
+ * (see blockbag_summary in recordmgr/blockbag.h).
+ *
+ * Summaries store keys as long longs. An integer key is stored exactly.
+ * Any other (arithmetic) key is stored as the integers just below and just
+ * above it, and the ends of a range query are rounded outward, so a block is
+ * only skipped if none of its keys can be in the range.
+ */
+
+#ifndef RQ_SUMMARIES_H
+#define RQ_SUMMARIES_H
+
+#ifdef BLOCKBAG_SUMMARIES
+
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <type_traits>
+#include "blockbag.h"
+
+#ifndef TIMESTAMP_NOT_SET
+    #define TIMESTAMP_NOT_SET 0
+#endif
+
+template <typename K>
+inline long long rq_summary_key(const K& key, const bool roundUp, std::true_type /* integral */) {
+    return (long long) key;
+}
+template <typename K>
+inline long long rq_summary_key(const K& key, const bool roundUp, std::false_type /* integral */) {
+    const double d = (roundUp ? std::ceil((double) key) : std::floor((double) key));
+    if (d != d) return (roundUp ? LLONG_MAX : LLONG_MIN); // NaN
+    if (d <= (double) LLONG_MIN) return LLONG_MIN;
+    if (d >= (double) LLONG_MAX) return LLONG_MAX;
+    return (long long) d;
+}
+// returns key rounded down (or up) to a long long
+template <typename K>
+inline long long rq_summary_key(const K& key, const bool roundUp) {
+    return rq_summary_key(key, roundUp, typename std::is_integral<K>::type());
+}
+
+// summarize the keys and dtime of a node as it is retired
+template <typename K, typename V, typename DataStructure, typename NodeType>
+inline blockbag_summary rq_summarize_retired_node(const int tid, DataStructure * const ds, NodeType * const node) {
+    blockbag_summary result;
+    result.clear();
+    K keys[RQ_DEBUGGING_MAX_KEYS_PER_NODE];
+    V values[RQ_DEBUGGING_MAX_KEYS_PER_NODE];
+    const int cnt = ds->getKeys(tid, node, keys, values);
+    assert(cnt <= RQ_DEBUGGING_MAX_KEYS_PER_NODE);
+    for (int i=0;i<cnt;++i) {
+        result.addKey(rq_summary_key(keys[i], false));
+        result.addKey(rq_summary_key(keys[i], true));
+    }
+    const long long dtime = node->dtime;
+    if (dtime == TIMESTAMP_NOT_SET) {
+        // the node may be deleted at any time (as far as a reader knows)
+        result.addTime(LLONG_MIN);
+        result.addTime(LLONG_MAX);
+    } else {
+        result.addTime(dtime);
+    }
+    return result;
+}
+
+// true if no node in a block with summary s can be in a range query of
+// [lo, hi] that was linearized at rq_lin_time and whose traversal ended at
+// end_timestamp: either no node has a key in [lo, hi], or every node was
+// deleted after the traversal ended, or before the range query was linearized.
+template <typename K>
+inline bool rq_can_skip_block(const blockbag_summary& s, const K& lo, const K& hi, const long long rq_lin_time, const long long end_timestamp) {
+    return s.maxKey < rq_summary_key(lo, true) || s.minKey > rq_summary_key(hi, false)
+            || s.minTime > end_timestamp
+            || s.maxTime < rq_lin_time;
+}
+
+#endif /* BLOCKBAG_SUMMARIES */
+
+#endif /* RQ_SUMMARIES_H */
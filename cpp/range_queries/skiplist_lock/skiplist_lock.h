@@ -92,6 +92,10 @@ public:
     }
     V erase(const int tid, const K& key);
     int rangeQuery(const int tid, const K& lo, const K& hi, K * const resultKeys, V * const resultValues);
+    // streams the keys in [lo, hi] to visitor in increasing order, stopping early if visitor returns false
+    // or after limit keys (see rq_stream.h). returns the number of keys streamed.
+    template <typename Visitor>
+    int rangeQuery(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor);
 
     void initThread(const int tid);
     void deinitThread(const int tid);
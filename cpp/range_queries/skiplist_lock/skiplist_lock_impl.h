@@ -451,5 +451,32 @@ int skiplist<K,V,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi
     return cnt;
 }
 
+template <typename K, typename V, class RecManager>
+template <typename Visitor>
+int skiplist<K,V,RecManager>::rangeQuery(const int tid, const K& lo, const K& hi, const int limit, Visitor&& visitor) {
+    recmgr->leaveQuiescentState(tid, true);
+    rqProvider->traversal_start(tid, limit);
+    
+    // use the find function to find the low key 
+    nodeptr pred = p_head;
+    nodeptr curr = NULL;
+    for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) {
+        curr = pred->p_next[level];
+        while (curr->key < lo) {
+            pred = curr;
+            curr = pred->p_next[level];
+        }
+    }
+    // continue until we pass the high key (or the visitor is done)
+    while (curr->key <= hi) {
+        rqProvider->traversal_try_add(tid, curr, lo, hi);
+        if (rqProvider->traversal_chunk_full(tid) && !rqProvider->traversal_flush(tid, lo, visitor)) break;
+        curr = curr->p_next[0];
+    }
+    int cnt = rqProvider->traversal_end(tid, lo, hi, visitor);
+    recmgr->enterQuiescentState(tid);
+    return cnt;
+}
+
 #endif /* SKIPLIST_LOCK_IMPL_H */
 
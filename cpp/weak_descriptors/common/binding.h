@@ -13,6 +13,9 @@
  *    thread binding policy, e.g., "1,2,3,8-11,4-7,0".
  *    the string contains the ids of logical processors, or ranges of ids,
  *    separated by commas.
+ *    alternatively, the string can name a topology-aware policy:
+ *    compact, scatter-sockets, physical-cores-first or one-per-L2
+ *    (see topology.h).
  * 3. have each thread invoke binding_bindThread.
  * 4. after your experiments run, you can confirm the binding for a given thread
  *    by invoking binding_getActualBinding.
@@ -48,6 +51,7 @@ void binding_configurePolicy(const int nprocessors) {}
 #include <vector>
 
 #include <plaf.h>
+#include "topology.h"
 using namespace std;
 
 // cpu sets for binding threads to cores
@@ -55,6 +59,7 @@ static cpu_set_t *cpusets[LOGICAL_PROCESSORS];
 
 static int customBinding[LOGICAL_PROCESSORS];
 static int numCustomBindings = 0;
+static string bindingPolicy; // name of the topology-aware policy, if one is used
 //static vector<int> customBinding;
 
 static unsigned digits(unsigned x) {
@@ -121,6 +126,16 @@ void binding_parseCustom(string argv) {
     //customBinding.clear();
     numCustomBindings = 0;
     
+    // argv can also name a topology-aware policy
+    if (topology_isPolicy(argv)) {
+        bindingPolicy = argv;
+        vector<int> cpus = topology_getBinding(argv);
+        for (int i=0;i<cpus.size() && numCustomBindings < LOGICAL_PROCESSORS;++i) {
+            if (cpus[i] < LOGICAL_PROCESSORS) customBinding[numCustomBindings++] = cpus[i];
+        }
+        return;
+    }
+    
     unsigned ix = 0;
     while (ix < argv.size()) {
         ix = parseToken(argv, ix);
@@ -220,6 +235,16 @@ void binding_configurePolicy(const int nthreads, const int nprocessors) {
 //        if (warning) {
 //            cout<<"WARNING: "<<nprocessors<<" threads mapped to "<<customBinding.size()<<" processors"<<endl;
 //        }
+        
+        // print the mapping, so the run can be reproduced with an explicit list
+        if (!bindingPolicy.empty()) {
+            cout<<"THREAD_BINDING_POLICY="<<bindingPolicy<<endl;
+            cout<<"THREAD_BINDING=";
+            for (int i=0;i<nthreads;++i) {
+                cout<<(i?",":"")<<customBinding[i%numCustomBindings];
+            }
+            cout<<endl;
+        }
     }
 }
 
@@ -0,0 +1,271 @@
+/*
+ * File:   allocator_slab.h
+ *
+ * A slab allocator for the Record Manager (see the comment below).
+ *
+ * debra/recordmgr has its own copy of this file, adapted to that project's
+ * record manager. Each project builds against its own recordmgr directory,
+ * so a fix to one copy must be made to the other by hand.
+ */
+
+#ifndef ALLOC_SLAB_H
+#define	ALLOC_SLAB_H
+
+#include "plaf.h"
+#include "globals.h"
+#include "allocator_interface.h"
+#include <stdint.h>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <sys/mman.h>
+using namespace std;
+
+// this allocator gives each thread its own slabs of memory, and bump allocates
+// from them like allocator_bump. unlike allocator_bump, it reuses the memory
+// of deallocated objects, and returns slabs that become empty to the OS.
+// (the record manager creates one allocator per record type, so all objects in
+// a slab have the same size class: the size of T rounded up to cache lines.)
+//
+// each slab is aligned on its size, so the slab that contains an object is
+// found by masking the object's address. objects freed by the thread that owns
+// a slab go on the slab's free list. objects freed by other threads are pushed
+// (with CAS) on the slab's remote free list, which only the owner empties.
+// only the owner changes a slab's count of live objects, so only the owner
+// decides that a slab is empty, and then no other thread can free into it.
+
+// size (and alignment) of each slab. must be a power of two.
+#ifndef ALLOC_SLAB_BYTES
+    #define ALLOC_SLAB_BYTES (1<<20) /* default: 1 MB */
+#endif
+
+// when a thread's current slab is full, it switches to another of its slabs
+// only if at least 1/ALLOC_SLAB_MIN_FREE_FRACTION of its objects are free
+// (so the cost of searching its slabs is amortized over many allocations).
+#ifndef ALLOC_SLAB_MIN_FREE_FRACTION
+    #define ALLOC_SLAB_MIN_FREE_FRACTION 4
+#endif
+
+struct slab_header {
+    slab_header * prev;             // links in the owner's list of slabs (other than its current slab)
+    slab_header * next;
+    char * bump;                    // next object that has never been allocated
+    char * end;
+    void * freeList;                // objects freed by the owner
+    void * volatile remoteFreeList; // objects freed by other threads
+    long live;                      // objects allocated and not known by the owner to be freed
+    int owner;
+};
+
+template<typename T = void>
+class allocator_slab : public allocator_interface<T> {
+private:
+    const int objBytes;       // bytes per object (a multiple of the cache line size)
+    const int headerBytes;    // bytes reserved for the slab header
+    const long capacity;      // objects per slab
+    slab_header ** current;   // current[tid*PREFETCH_SIZE_WORDS] = slab to allocate from
+    slab_header ** others;    // others[tid*PREFETCH_SIZE_WORDS] = list of tid's other slabs
+    long * mapped;            // mapped[tid*PREFETCH_SIZE_WORDS] = # slabs mapped by tid
+    long * unmapped;          // unmapped[tid*PREFETCH_SIZE_WORDS] = # slabs returned to the OS by tid
+
+    inline static slab_header * slabOf(void * const p) {
+        return (slab_header *) (((uintptr_t) p) & ~((uintptr_t) ALLOC_SLAB_BYTES - 1));
+    }
+    inline static void * nextOf(void * const p) {
+        return *((void **) p);
+    }
+    inline static void setNext(void * const p, void * const next) {
+        *((void **) p) = next;
+    }
+
+    slab_header * slab_map(const int tid) {
+        // map twice the slab size, then trim it so the slab is aligned on its size
+        char * region = (char *) mmap(NULL, 2*ALLOC_SLAB_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED) {
+            cerr<<"could not map a slab of "<<ALLOC_SLAB_BYTES<<" bytes"<<endl;
+            exit(-1);
+        }
+        char * start = (char *) slabOf(region + ALLOC_SLAB_BYTES - 1);
+        if (start > region) munmap(region, start - region);
+        if (region + 2*ALLOC_SLAB_BYTES > start + ALLOC_SLAB_BYTES) {
+            munmap(start + ALLOC_SLAB_BYTES, (region + 2*ALLOC_SLAB_BYTES) - (start + ALLOC_SLAB_BYTES));
+        }
+        slab_header * s = (slab_header *) start;
+        s->prev = NULL;
+        s->next = NULL;
+        s->bump = start + headerBytes;
+        s->end = start + headerBytes + capacity*objBytes;
+        s->freeList = NULL;
+        s->remoteFreeList = NULL;
+        s->live = 0;
+        s->owner = tid;
+        ++mapped[tid*PREFETCH_SIZE_WORDS];
+        return s;
+    }
+    void slab_unmap(const int tid, slab_header * const s) {
+        munmap(s, ALLOC_SLAB_BYTES);
+        ++unmapped[tid*PREFETCH_SIZE_WORDS];
+    }
+    void slab_unlink(const int tid, slab_header * const s) {
+        if (s->prev) s->prev->next = s->next;
+        else others[tid*PREFETCH_SIZE_WORDS] = s->next;
+        if (s->next) s->next->prev = s->prev;
+        s->prev = s->next = NULL;
+    }
+    void slab_link(const int tid, slab_header * const s) {
+        s->prev = NULL;
+        s->next = others[tid*PREFETCH_SIZE_WORDS];
+        if (s->next) s->next->prev = s;
+        others[tid*PREFETCH_SIZE_WORDS] = s;
+    }
+    // move the objects other threads freed into s to its (local) free list
+    void slab_take_remote_frees(slab_header * const s) {
+        if (s->remoteFreeList == NULL) return;
+        void * list = __sync_lock_test_and_set(&s->remoteFreeList, (void *) NULL);
+        long n = 1;
+        void * tail = list;
+        while (nextOf(tail)) { tail = nextOf(tail); ++n; }
+        setNext(tail, s->freeList);
+        s->freeList = list;
+        s->live -= n;
+    }
+    // reset an empty slab, so it is bump allocated from the start again
+    void slab_reset(slab_header * const s) {
+        assert(s->live == 0);
+        s->bump = ((char *) s) + headerBytes;
+        s->freeList = NULL;
+    }
+    // called when tid's current slab is full: find a slab with enough free
+    // objects among tid's other slabs, or map a new one. slabs that turn out
+    // to be empty are returned to the OS (except one, which is reused).
+    slab_header * slab_replace_current(const int tid) {
+        slab_header * result = NULL;
+        slab_header * s = others[tid*PREFETCH_SIZE_WORDS];
+        while (s) {
+            slab_header * next = s->next;
+            slab_take_remote_frees(s);
+            if (s->live == 0) {
+                slab_unlink(tid, s);
+                if (result == NULL || result->live > 0) {
+                    if (result) slab_link(tid, result);
+                    slab_reset(s);
+                    result = s;
+                } else {
+                    slab_unmap(tid, s);
+                }
+            } else if (result == NULL && (capacity - s->live) * ALLOC_SLAB_MIN_FREE_FRACTION >= capacity) {
+                slab_unlink(tid, s);
+                result = s;
+            }
+            s = next;
+        }
+        if (result == NULL) result = slab_map(tid);
+        if (current[tid*PREFETCH_SIZE_WORDS]) slab_link(tid, current[tid*PREFETCH_SIZE_WORDS]);
+        current[tid*PREFETCH_SIZE_WORDS] = result;
+        return result;
+    }
+    inline void * slab_next(slab_header * const s) {
+        if (s->freeList) {
+            void * result = s->freeList;
+            s->freeList = nextOf(result);
+            ++s->live;
+            return result;
+        }
+        if (s->bump < s->end) {
+            void * result = s->bump;
+            s->bump += objBytes;
+            ++s->live;
+            return result;
+        }
+        return NULL;
+    }
+
+public:
+    template<typename _Tp1>
+    struct rebind {
+        typedef allocator_slab<_Tp1> other;
+    };
+
+    // reserve space for ONE object of type T
+    T* allocate(const int tid) {
+        MEMORY_STATS this->debug->addAllocated(tid, 1);
+        slab_header * s = current[tid*PREFETCH_SIZE_WORDS];
+        if (s) {
+            void * result = slab_next(s);
+            if (result) return (T*) result;
+            slab_take_remote_frees(s);
+            result = slab_next(s);
+            if (result) return (T*) result;
+        }
+        return (T*) slab_next(slab_replace_current(tid));
+    }
+    void deallocate(const int tid, T * const p) {
+        MEMORY_STATS this->debug->addDeallocated(tid, 1);
+        p->~T();
+        slab_header * s = slabOf(p);
+        if (s->owner == tid) {
+            setNext(p, s->freeList);
+            s->freeList = p;
+            if (--s->live == 0 && s != current[tid*PREFETCH_SIZE_WORDS]) {
+                slab_unlink(tid, s);
+                slab_unmap(tid, s);
+            }
+        } else {
+            void * head;
+            do {
+                head = s->remoteFreeList;
+                setNext(p, head);
+            } while (!__sync_bool_compare_and_swap(&s->remoteFreeList, head, (void *) p));
+        }
+    }
+    void deallocateAndClear(const int tid, blockbag<T> * const bag) {
+        while (!bag->isEmpty()) {
+            T* ptr = bag->remove();
+            deallocate(tid, ptr);
+        }
+    }
+
+    void debugPrintStatus(const int tid) {
+        cout<<"slabs mapped="<<mapped[tid*PREFETCH_SIZE_WORDS]<<" returned to the OS="<<unmapped[tid*PREFETCH_SIZE_WORDS];
+    }
+
+    void initThread(const int tid) {}
+
+    allocator_slab(const int numProcesses, debugInfo * const _debug)
+            : allocator_interface<T>(numProcesses, _debug)
+            , objBytes(((sizeof(T)+(BYTES_IN_CACHE_LINE-1))/BYTES_IN_CACHE_LINE)*BYTES_IN_CACHE_LINE)
+            , headerBytes(((sizeof(slab_header)+(BYTES_IN_CACHE_LINE-1))/BYTES_IN_CACHE_LINE)*BYTES_IN_CACHE_LINE)
+            , capacity((ALLOC_SLAB_BYTES - headerBytes) / objBytes) {
+        VERBOSE DEBUG COUTATOMIC("constructor allocator_slab"<<endl);
+        assert(capacity > 0);
+        current = new slab_header*[numProcesses*PREFETCH_SIZE_WORDS];
+        others = new slab_header*[numProcesses*PREFETCH_SIZE_WORDS];
+        mapped = new long[numProcesses*PREFETCH_SIZE_WORDS];
+        unmapped = new long[numProcesses*PREFETCH_SIZE_WORDS];
+        for (int tid=0;tid<numProcesses;++tid) {
+            current[tid*PREFETCH_SIZE_WORDS] = NULL;
+            others[tid*PREFETCH_SIZE_WORDS] = NULL;
+            mapped[tid*PREFETCH_SIZE_WORDS] = 0;
+            unmapped[tid*PREFETCH_SIZE_WORDS] = 0;
+        }
+    }
+    ~allocator_slab() {
+        VERBOSE COUTATOMIC("destructor allocator_slab"<<endl);
+        // return all remaining slabs to the OS
+        for (int tid=0;tid<this->NUM_PROCESSES;++tid) {
+            slab_header * s = others[tid*PREFETCH_SIZE_WORDS];
+            while (s) {
+                slab_header * next = s->next;
+                munmap(s, ALLOC_SLAB_BYTES);
+                s = next;
+            }
+            if (current[tid*PREFETCH_SIZE_WORDS]) munmap(current[tid*PREFETCH_SIZE_WORDS], ALLOC_SLAB_BYTES);
+        }
+        delete[] current;
+        delete[] others;
+        delete[] mapped;
+        delete[] unmapped;
+    }
+};
+
+#endif	/* ALLOC_SLAB_H */
@@ -0,0 +1,284 @@
+/*
+ * File:   reclaimer_ibr.h
+ *
+ * debra/recordmgr has its own copy of this file, adapted to that project's
+ * record manager. Each project builds against its own recordmgr directory,
+ * so a fix to one copy must be made to the other by hand.
+ */
+
+// This file provides a Reclaimer plugin for the Record Manager.
+// Specifically, it provides an implementation of interval-based reclamation
+// (the 2GE-IBR variant of Wen et al., PPoPP 2018).
+//
+// Each record stores the global epoch in which it was allocated (its birth
+// epoch) and the global epoch in which it was retired (its retire epoch).
+// Each thread reserves an interval of epochs [lower, upper], where lower is
+// the epoch in which its current operation started, and upper is the latest
+// epoch in which it protected a record. A retired record can be freed once
+// its lifetime [birth, retire] does not intersect any thread's reserved
+// interval. Unlike DEBRA, a thread that stalls in the middle of an operation
+// only prevents records that were alive during its reserved interval from
+// being freed, so the amount of unreclaimed garbage stays bounded.
+//
+// Data structures that protect every record they access with protect()
+// (as required for hazard pointers) get this bound. For data structures
+// that do not call protect(), the reserved interval is [lower, infinity],
+// and IBR degrades gracefully to epoch based reclamation.
+
+#ifndef RECLAIM_IBR_H
+#define	RECLAIM_IBR_H
+
+#include <cassert>
+#include <climits>
+#include <iostream>
+#include <sstream>
+#include "blockbag.h"
+#include "plaf.h"
+#include "allocator_interface.h"
+#include "reclaimer_interface.h"
+using namespace std;
+
+// a thread increments the global epoch once every IBR_EPOCH_FREQ allocations
+#ifndef IBR_EPOCH_FREQ
+    #define IBR_EPOCH_FREQ 150
+#endif
+
+// a thread scans the reserved intervals once it has retired
+// max(IBR_EMPTY_FREQ, 2*(number of records it could not free in its last scan))
+// records since its last scan.
+#ifndef IBR_EMPTY_FREQ
+    #define IBR_EMPTY_FREQ 30
+#endif
+
+#define IBR_INFINITE_EPOCH LONG_MAX
+
+// a record as it is stored by the record manager when reclaimer_ibr is used.
+// the record manager allocates ibr_record<Record> objects, and hands them out
+// as Record pointers, so data structures never see the epoch fields.
+template <typename Record>
+struct ibr_record : public Record {
+    volatile long ibrBirthEpoch;
+    volatile long ibrRetireEpoch;
+};
+
+struct ibr_reservation {
+    volatile long lower;
+    volatile long upper;
+    volatile char padding[PREFETCH_SIZE_BYTES - 2*sizeof(long)];
+};
+
+template <typename T = void, class Pool = pool_interface<T> >
+class reclaimer_ibr : public reclaimer_interface<T, Pool> {
+protected:
+    volatile char padding0[PREFETCH_SIZE_BYTES];
+    volatile long epoch;
+    volatile char padding1[PREFETCH_SIZE_BYTES];
+    ibr_reservation *reservations;      // reservations[tid] = interval of epochs reserved by thread tid
+    blockbag<T> **retired;              // retired[2*tid] = records retired by thread tid (retired[2*tid+1] is scratch space for scans)
+    long *retiredSinceScan;             // retiredSinceScan[tid*PREFETCH_SIZE_WORDS] = number of records retired by thread tid since its last scan
+    long *scanThreshold;                // scanThreshold[tid*PREFETCH_SIZE_WORDS] = value of retiredSinceScan that triggers the next scan
+    long *allocSinceEpoch;              // allocSinceEpoch[tid*PREFETCH_SIZE_WORDS] = number of allocations by thread tid since it last incremented the epoch
+    long *scannedLower;                 // scannedLower[tid*NUM_PROCESSES+i] = lower end of thread i's reserved interval, as collected by thread tid in its last scan
+    long *scannedUpper;                 // scannedUpper[tid*NUM_PROCESSES+i] = upper end of thread i's reserved interval, as collected by thread tid in its last scan
+
+    // read the reserved intervals of all threads.
+    // returns the number of threads with non-empty intervals.
+    inline int collectReservations(const int tid) {
+        long * const lo = scannedLower + tid*this->NUM_PROCESSES;
+        long * const hi = scannedUpper + tid*this->NUM_PROCESSES;
+        int n = 0;
+        for (int otherTid=0;otherTid<this->NUM_PROCESSES;++otherTid) {
+            const long lower = reservations[otherTid].lower;
+            if (lower == IBR_INFINITE_EPOCH) continue; // quiescent
+            lo[n] = lower;
+            hi[n] = reservations[otherTid].upper;
+            ++n;
+        }
+        return n;
+    }
+
+    // free every record retired by thread tid whose lifetime does not
+    // intersect the reserved interval of any thread.
+    inline void scanAndReclaim(const int tid) {
+        __sync_synchronize(); // retire epochs must be written before we read any reservations
+        const int n = collectReservations(tid);
+        const long * const lo = scannedLower + tid*this->NUM_PROCESSES;
+        const long * const hi = scannedUpper + tid*this->NUM_PROCESSES;
+
+        blockbag<T> * const bag = retired[2*tid];
+        blockbag<T> * const keep = retired[2*tid+1];
+        long kept = 0;
+        while (!bag->isEmpty()) {
+            T * const p = bag->remove();
+            const long birth = p->ibrBirthEpoch;
+            const long retire = p->ibrRetireEpoch;
+            bool conflict = false;
+            for (int i=0;i<n;++i) {
+                if (birth <= hi[i] && retire >= lo[i]) {
+                    conflict = true;
+                    break;
+                }
+            }
+            if (conflict) {
+                keep->add(p);
+                ++kept;
+            } else {
+                this->pool->add(tid, p);
+            }
+        }
+        retired[2*tid] = keep;
+        retired[2*tid+1] = bag;
+
+        retiredSinceScan[tid*PREFETCH_SIZE_WORDS] = kept;
+        scanThreshold[tid*PREFETCH_SIZE_WORDS] = (2*kept > IBR_EMPTY_FREQ) ? 2*kept : IBR_EMPTY_FREQ;
+    }
+
+public:
+    template<typename _Tp1>
+    struct rebind {
+        typedef reclaimer_ibr<_Tp1, Pool> other;
+    };
+    template<typename _Tp1, typename _Tp2>
+    struct rebind2 {
+        typedef reclaimer_ibr<_Tp1, _Tp2> other;
+    };
+
+    long long getSizeInNodes() {
+        long long sum = 0;
+        for (int tid=0;tid<this->NUM_PROCESSES;++tid) {
+            sum += retired[2*tid]->computeSize();
+        }
+        return sum;
+    }
+    string getSizeString() {
+        stringstream ss;
+        ss<<getSizeInNodes()<<" retired (epoch "<<epoch<<")";
+        return ss.str();
+    }
+
+    inline static bool quiescenceIsPerRecordType() { return true; }
+
+    inline bool isQuiescent(const int tid) {
+        return reservations[tid].lower == IBR_INFINITE_EPOCH;
+    }
+
+    inline static bool isProtected(const int tid, T * const obj) {
+        return true;
+    }
+    inline static bool isQProtected(const int tid, T * const obj) {
+        return false;
+    }
+    // reserve the current epoch (which is at least the birth epoch of obj),
+    // then check that obj had not been retired when the reservation was made.
+    inline bool protect(const int tid, T * const obj, CallbackType notRetiredCallback, CallbackArg callbackArg, bool memoryBarrier = true) {
+        const long e = epoch;
+        if (reservations[tid].upper != e) {
+            reservations[tid].upper = e;
+            __sync_synchronize(); // the reservation must be visible before we check whether obj is retired
+        }
+        return notRetiredCallback(callbackArg);
+    }
+    inline static void unprotect(const int tid, T * const obj) {}
+    inline static bool qProtect(const int tid, T * const obj, CallbackType notRetiredCallback, CallbackArg callbackArg, bool memoryBarrier = true) {
+        return false;
+    }
+    inline static void qUnprotectAll(const int tid) {}
+
+    inline static bool shouldHelp() { return true; }
+
+    inline void rotateEpochBags(const int tid) {}
+
+    // invoke this at the beginning of each operation that accesses
+    // objects reclaimed by this reclaimer.
+    inline bool leaveQuiescentState(const int tid, void * const * const reclaimers, const int numReclaimers) {
+        SOFTWARE_BARRIER;
+        reservations[tid].upper = IBR_INFINITE_EPOCH;
+        reservations[tid].lower = epoch;
+        __sync_synchronize(); // the reservation must be visible before we access any records
+        return false;
+    }
+
+    inline void enterQuiescentState(const int tid) {
+        SOFTWARE_BARRIER;
+        reservations[tid].lower = IBR_INFINITE_EPOCH;
+        reservations[tid].upper = IBR_INFINITE_EPOCH;
+    }
+
+    // invoked by the record manager every time thread tid allocates p.
+    inline void allocated(const int tid, T * const p) {
+        if (++allocSinceEpoch[tid*PREFETCH_SIZE_WORDS] >= IBR_EPOCH_FREQ) {
+            allocSinceEpoch[tid*PREFETCH_SIZE_WORDS] = 0;
+            __sync_fetch_and_add(&epoch, 1);
+        }
+        p->ibrBirthEpoch = epoch;
+    }
+
+    // for all schemes except reference counting
+    inline void retire(const int tid, T* p) {
+        p->ibrRetireEpoch = epoch;
+        retired[2*tid]->add(p);
+        DEBUG2 this->debug->addRetired(tid, 1);
+        if (++retiredSinceScan[tid*PREFETCH_SIZE_WORDS] >= scanThreshold[tid*PREFETCH_SIZE_WORDS]) {
+            scanAndReclaim(tid);
+        }
+    }
+
+    void debugPrintStatus(const int tid) {
+        if (tid == 0) {
+            cout<<"global epoch counter="<<epoch<<endl;
+        }
+//        cout<<"reservation=["<<reservations[tid].lower<<","<<reservations[tid].upper<<"] retired="<<retired[2*tid]->computeSize();
+    }
+
+    reclaimer_ibr(const int numProcesses, Pool *_pool, debugInfo * const _debug, RecoveryMgr<void *> * const _recoveryMgr = NULL)
+            : reclaimer_interface<T, Pool>(numProcesses, _pool, _debug, _recoveryMgr) {
+        VERBOSE cout<<"constructor reclaimer_ibr helping="<<this->shouldHelp()<<endl;
+        epoch = 0;
+        reservations = new ibr_reservation[numProcesses];
+        retired = new blockbag<T>*[2*numProcesses];
+        retiredSinceScan = new long[numProcesses*PREFETCH_SIZE_WORDS];
+        scanThreshold = new long[numProcesses*PREFETCH_SIZE_WORDS];
+        allocSinceEpoch = new long[numProcesses*PREFETCH_SIZE_WORDS];
+        scannedLower = new long[numProcesses*numProcesses];
+        scannedUpper = new long[numProcesses*numProcesses];
+        for (int tid=0;tid<numProcesses;++tid) {
+            reservations[tid].lower = IBR_INFINITE_EPOCH;
+            reservations[tid].upper = IBR_INFINITE_EPOCH;
+            retired[2*tid] = new blockbag<T>(tid, this->pool->blockpools[tid]);
+            retired[2*tid+1] = new blockbag<T>(tid, this->pool->blockpools[tid]);
+            retiredSinceScan[tid*PREFETCH_SIZE_WORDS] = 0;
+            scanThreshold[tid*PREFETCH_SIZE_WORDS] = IBR_EMPTY_FREQ;
+            allocSinceEpoch[tid*PREFETCH_SIZE_WORDS] = 0;
+        }
+    }
+    ~reclaimer_ibr() {
+        VERBOSE DEBUG cout<<"destructor reclaimer_ibr"<<endl;
+        for (int tid=0;tid<this->NUM_PROCESSES;++tid) {
+            // move contents of all bags into pool
+            for (int i=0;i<2;++i) {
+                this->pool->addMoveAll(tid, retired[2*tid+i]);
+                delete retired[2*tid+i];
+            }
+        }
+        delete[] reservations;
+        delete[] retired;
+        delete[] retiredSinceScan;
+        delete[] scanThreshold;
+        delete[] allocSinceEpoch;
+        delete[] scannedLower;
+        delete[] scannedUpper;
+    }
+
+};
+
+// the record manager stores ibr_record<Record> objects when reclaimer_ibr is used.
+template <typename T, class Pool, typename Record>
+struct reclaimer_record_type<reclaimer_ibr<T, Pool>, Record> {
+    typedef ibr_record<Record> type;
+    template <class ClassReclaim>
+    inline static void allocated(ClassReclaim * const reclaim, const int tid, type * const p) {
+        reclaim->allocated(tid, p);
+    }
+};
+
+#endif
@@ -95,4 +95,15 @@ public:
     }
 };
 
+// the type of object the record manager actually stores for records of type
+// Record when reclaimer Reclaim is used. reclaimers that need to store
+// information in each record (such as reclaimer_ibr) specialize this
+// to a subclass of Record. allocated() is invoked on every allocation.
+template <class Reclaim, typename Record>
+struct reclaimer_record_type {
+    typedef Record type;
+    template <class ClassReclaim>
+    inline static void allocated(ClassReclaim * const reclaim, const int tid, type * const p) {}
+};
+
 #endif
@@ -0,0 +1,187 @@
+/*
+ * File:   topology.h
+ *
+ * Reads the processor topology of the machine from /sys/devices/system/cpu
+ * and produces thread binding orders (lists of logical processor ids) for a
+ * few named policies, so that experiments can be pinned the same way on
+ * machines with different numbering schemes.
+ *
+ * Policies:
+ *  compact                 fill each physical core (all of its hyperthreads),
+ *                          then the next core on the same socket, then the
+ *                          next socket.
+ *  scatter-sockets         round robin over the sockets (using one hyperthread
+ *                          of each core on a socket before any second one).
+ *  physical-cores-first    one hyperthread of each core (socket by socket),
+ *                          then the second hyperthread of each core, etc.
+ *  one-per-L2              one logical processor per L2 cache, then a second
+ *                          one per L2 cache, etc. (same as physical-cores-first
+ *                          if every core has its own L2 cache.)
+ *
+ * If the topology cannot be read, every logical processor is treated as its
+ * own core on socket 0, so every policy is the identity binding.
+ *
+ * Each project is built on its own, with its own copies of shared headers,
+ * so there are identical copies of this file in debra/, 3path_htm/common/,
+ * range_queries/common/ and weak_descriptors/common/. Change them together.
+ */
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+
+// (can be overridden to test policies with a copy of another machine's sysfs)
+#ifndef TOPOLOGY_SYSFS_ROOT
+    #define TOPOLOGY_SYSFS_ROOT "/sys/devices/system/cpu"
+#endif
+
+struct topology_cpu {
+    int id;         // logical processor id
+    int socket;     // physical_package_id
+    int core;       // core_id (unique only within a socket)
+    int l2;         // smallest logical processor id that shares this L2 cache
+    int smt;        // rank of this logical processor among its core's hyperthreads
+    int rank;       // rank used by the policy that is being computed
+};
+
+// parse a list of logical processor ids, e.g., "0-3,8,10-11"
+static std::vector<int> topology_parseCpuList(const std::string& list) {
+    std::vector<int> result;
+    std::stringstream ss(list);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        if (token.empty() || token[0] < '0' || token[0] > '9') continue;
+        const size_t dash = token.find('-');
+        const int a = atoi(token.c_str());
+        const int b = (dash == std::string::npos) ? a : atoi(token.c_str()+dash+1);
+        for (int i=a;i<=b;++i) result.push_back(i);
+    }
+    return result;
+}
+
+static bool topology_readFile(const std::string& path, std::string& contents) {
+    std::ifstream in(path.c_str());
+    if (!in.good()) return false;
+    std::getline(in, contents);
+    return true;
+}
+
+static int topology_readInt(const std::string& path, const int defaultValue) {
+    std::string s;
+    if (!topology_readFile(path, s) || s.empty()) return defaultValue;
+    return atoi(s.c_str());
+}
+
+// smallest logical processor id that shares the L2 (data or unified) cache of cpu
+static int topology_readL2(const int cpu) {
+    std::stringstream dir;
+    dir<<TOPOLOGY_SYSFS_ROOT<<"/cpu"<<cpu<<"/cache/";
+    for (int i=0;i<8;++i) {
+        std::stringstream index;
+        index<<dir.str()<<"index"<<i<<"/";
+        if (topology_readInt(index.str()+"level", -1) != 2) continue;
+        std::string type;
+        if (topology_readFile(index.str()+"type", type) && type == "Instruction") continue;
+        std::string shared;
+        if (!topology_readFile(index.str()+"shared_cpu_list", shared)) break;
+        std::vector<int> cpus = topology_parseCpuList(shared);
+        if (!cpus.empty()) return *std::min_element(cpus.begin(), cpus.end());
+    }
+    return cpu;
+}
+
+// returns the online logical processors of this machine
+static std::vector<topology_cpu> topology_read() {
+    std::vector<topology_cpu> cpus;
+    std::string online;
+    std::vector<int> ids;
+    if (topology_readFile(TOPOLOGY_SYSFS_ROOT "/online", online)) {
+        ids = topology_parseCpuList(online);
+    }
+    if (ids.empty()) {
+        ids.push_back(0);
+    }
+    for (size_t i=0;i<ids.size();++i) {
+        std::stringstream dir;
+        dir<<TOPOLOGY_SYSFS_ROOT<<"/cpu"<<ids[i]<<"/topology/";
+        topology_cpu c;
+        c.id = ids[i];
+        c.socket = std::max(0, topology_readInt(dir.str()+"physical_package_id", 0));
+        c.core = topology_readInt(dir.str()+"core_id", ids[i]);
+        c.l2 = topology_readL2(ids[i]);
+        c.smt = 0;
+        c.rank = 0;
+        cpus.push_back(c);
+    }
+    // hyperthreads of a core are ranked by their ids
+    for (size_t i=0;i<cpus.size();++i) {
+        for (size_t j=0;j<i;++j) {
+            if (cpus[j].socket == cpus[i].socket && cpus[j].core == cpus[i].core) ++cpus[i].smt;
+        }
+    }
+    return cpus;
+}
+
+static bool topology_isPolicy(const std::string& name) {
+    return name == "compact" || name == "scatter-sockets"
+        || name == "physical-cores-first" || name == "one-per-L2";
+}
+
+static bool topology_lessCompact(const topology_cpu& a, const topology_cpu& b) {
+    if (a.socket != b.socket) return a.socket < b.socket;
+    if (a.core != b.core) return a.core < b.core;
+    return a.smt < b.smt;
+}
+
+static bool topology_lessRanked(const topology_cpu& a, const topology_cpu& b) {
+    if (a.rank != b.rank) return a.rank < b.rank;
+    if (a.socket != b.socket) return a.socket < b.socket;
+    if (a.core != b.core) return a.core < b.core;
+    return a.id < b.id;
+}
+
+// returns the logical processors in the order that threads should be bound
+// to them under the given policy (or an empty vector if name is not a policy)
+static std::vector<int> topology_getBinding(const std::string& name) {
+    std::vector<int> result;
+    if (!topology_isPolicy(name)) return result;
+    std::vector<topology_cpu> cpus = topology_read();
+
+    if (name == "compact") {
+        std::sort(cpus.begin(), cpus.end(), topology_lessCompact);
+    } else if (name == "physical-cores-first") {
+        for (size_t i=0;i<cpus.size();++i) cpus[i].rank = cpus[i].smt;
+        std::sort(cpus.begin(), cpus.end(), topology_lessRanked);
+    } else if (name == "one-per-L2") {
+        // rank = position of the cpu within its L2 domain (physical cores first)
+        for (size_t i=0;i<cpus.size();++i) cpus[i].rank = cpus[i].smt;
+        std::sort(cpus.begin(), cpus.end(), topology_lessRanked);
+        for (size_t i=0;i<cpus.size();++i) cpus[i].rank = 0;
+        for (size_t i=0;i<cpus.size();++i) {
+            for (size_t j=0;j<i;++j) {
+                if (cpus[j].l2 == cpus[i].l2) ++cpus[i].rank;
+            }
+        }
+        std::sort(cpus.begin(), cpus.end(), topology_lessRanked);
+    } else if (name == "scatter-sockets") {
+        // rank = position of the cpu within its socket (physical cores first)
+        for (size_t i=0;i<cpus.size();++i) cpus[i].rank = cpus[i].smt;
+        std::sort(cpus.begin(), cpus.end(), topology_lessRanked);
+        std::vector<int> seen;
+        for (size_t i=0;i<cpus.size();++i) {
+            if ((int) seen.size() <= cpus[i].socket) seen.resize(cpus[i].socket+1, 0);
+            cpus[i].rank = seen[cpus[i].socket]++;
+        }
+        std::sort(cpus.begin(), cpus.end(), topology_lessRanked);
+    }
+    for (size_t i=0;i<cpus.size();++i) result.push_back(cpus[i].id);
+    return result;
+}
+
+#endif /* TOPOLOGY_H */
@@ -956,6 +956,8 @@ void performExperiment() {
         performExperiment<Reclaim, allocator_bump<test_type> >();
     } else if (strcmp(ALLOC_TYPE, "new") == 0) {
         performExperiment<Reclaim, allocator_new<test_type> >();
+    } else if (strcmp(ALLOC_TYPE, "slab") == 0) {
+        performExperiment<Reclaim, allocator_slab<test_type> >();
     } else {
         cout<<"bad allocator type"<<endl;
         exit(1);
@@ -969,6 +971,8 @@ void performExperiment() {
         performExperiment<reclaimer_none<test_type> >();
     } else if (strcmp(RECLAIM_TYPE, "debra") == 0) {
         performExperiment<reclaimer_debra<test_type> >();
+    } else if (strcmp(RECLAIM_TYPE, "ibr") == 0) {
+        performExperiment<reclaimer_ibr<test_type> >();
 #ifdef USE_RECLAIMER_RCU
     } else if (strcmp(RECLAIM_TYPE, "rcu") == 0) {
         performExperiment<reclaimer_rcu<test_type> >();